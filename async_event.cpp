@@ -0,0 +1,111 @@
+#include "async_event.h"
+
+namespace coro
+{
+Event::Event(EventMode mode, bool set)
+    : m_mode(mode)
+    , m_set(set)
+{}
+
+void Event::Set()
+{
+    std::unique_lock lk(m_mut);
+    if (m_mode == EventMode::ManualReset)
+    {
+        m_set = true;
+        detail::WaitQueue waiters;
+        std::swap(waiters, m_waiters);
+        lk.unlock();
+        waiters.WakeAll();
+        return;
+    }
+    // 自动复位: 直接把放行权交给最早的等待者, 不经过设置状态
+    while (auto node = m_waiters.Pop())
+    {
+        lk.unlock();
+        if (detail::Wake(node))
+        {
+            return;
+        }
+        // 等待者已撤销, 交给下一个
+        lk.lock();
+    }
+    m_set = true;
+}
+
+void Event::Reset()
+{
+    std::lock_guard lk(m_mut);
+    m_set = false;
+}
+
+bool Event::IsSet() const
+{
+    std::lock_guard lk(m_mut);
+    return m_set;
+}
+
+EventAwaiter Event::Wait()
+{
+    return EventAwaiter(*this);
+}
+
+bool Event::TryAcquire()
+{
+    if (!m_set)
+    {
+        return false;
+    }
+    if (m_mode == EventMode::AutoReset)
+    {
+        m_set = false;
+    }
+    return true;
+}
+
+EventAwaiter::~EventAwaiter()
+{
+    if (!m_node)
+    {
+        return;
+    }
+    bool notified = false;
+    {
+        // 在锁内移除并标记, Set取出的节点由标记决定归属
+        std::lock_guard lk(m_event.m_mut);
+        m_event.m_waiters.Remove(m_node);
+        notified = detail::Abandon(m_node);
+    }
+    if (notified && !m_woken && m_event.m_mode == EventMode::AutoReset)
+    {
+        // 已获得放行权但未处理, 转给下一个等待者
+        m_event.Set();
+    }
+}
+
+bool EventAwaiter::await_ready()
+{
+    std::lock_guard lk(m_event.m_mut);
+    return m_event.TryAcquire();
+}
+
+void EventAwaiter::Handle()
+{
+    std::unique_lock lk(m_event.m_mut);
+    if (m_event.TryAcquire())
+    {
+        lk.unlock();
+        Resume();
+        return;
+    }
+    m_node = detail::MakeWaitNode(this, GetExecutor());
+    m_event.m_waiters.Push(m_node);
+}
+
+void EventAwaiter::OnWake()
+{
+    m_woken = true;
+    Resume();
+}
+
+}  // namespace coro
@@ -0,0 +1,113 @@
+#ifndef CORO_ASYNC_EVENT_H
+#define CORO_ASYNC_EVENT_H
+
+#include <mutex>
+#include "wait_queue.h"
+
+namespace coro
+{
+class EventAwaiter;
+
+/**
+ * @brief Event的复位方式
+ */
+enum class EventMode
+{
+    //! 设置后保持, 唤醒所有等待者, 直到Reset
+    ManualReset,
+    //! 每次设置只放行一个等待者, 放行后自动复位
+    AutoReset,
+};
+
+/**
+ * @brief 协程事件, 任意线程Set; 等待者挂在事件上, 在各自的执行器上恢复, 不占用fd;
+ *        自动复位时只唤醒一个等待者, 没有惊群
+ */
+class Event
+{
+public:
+    Event(const Event&) = delete;
+    /**
+     * @brief 构造事件
+     * @param mode 复位方式
+     * @param set 初始是否已设置
+     */
+    explicit Event(EventMode mode = EventMode::ManualReset, bool set = false);
+
+    /**
+     * @brief 设置事件, 可在任意线程调用; 手动复位时唤醒所有等待者,
+     *        自动复位时有等待者则只唤醒最早的一个, 否则保持设置直到下一个等待者
+     */
+    void Set();
+
+    /**
+     * @brief 复位事件
+     */
+    void Reset();
+
+    /**
+     * @brief 是否已设置
+     * @return
+     */
+    bool IsSet() const;
+
+    /**
+     * @brief 等待事件设置, 已设置时不挂起; 自动复位时同时消耗本次设置
+     * @return 等待器
+     */
+    EventAwaiter Wait();
+
+private:
+    friend class EventAwaiter;
+
+    /**
+     * @brief 已设置时消耗设置, 需持有锁
+     * @return 可以放行返回true
+     */
+    bool TryAcquire();
+
+    //! 复位方式
+    const EventMode m_mode;
+    //! 是否已设置
+    bool m_set = false;
+    //! 保护状态与等待队列; 被唤醒的协程可能立即销毁事件, 唤醒在解锁后进行
+    mutable std::mutex m_mut;
+    //! 等待的协程
+    detail::WaitQueue m_waiters;
+};
+
+/**
+ * @brief Event::Wait的等待器
+ */
+class EventAwaiter : public WaitAwaiter
+{
+public:
+    explicit EventAwaiter(Event& event)
+        : m_event(event)
+    {}
+    ~EventAwaiter() override;
+
+    bool await_ready();
+
+    /**
+     * @brief 加锁后重新检查, 未设置时登记等待
+     */
+    void Handle() override;
+
+    /**
+     * @brief 被唤醒, 放行权已交给本协程
+     */
+    void OnWake() override;
+
+private:
+    //! 事件
+    Event& m_event;
+    //! 等待者
+    std::shared_ptr<detail::WaitNode> m_node;
+    //! 唤醒是否已处理
+    bool m_woken = false;
+};
+
+}  // namespace coro
+
+#endif  // CORO_ASYNC_EVENT_H
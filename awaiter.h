@@ -6,6 +6,7 @@
 #include <functional>
 #include <optional>
 #include "executor.h"
+#include "trace.h"
 
 namespace coro
 {
@@ -32,7 +33,7 @@ public:
     template <typename T>
     void await_suspend(T handle)
     {
-        m_resume = [handle]() { handle.resume(); };
+        m_handle = handle;
         auto ctx = handle.promise().GetContext().lock();
         if (!ctx)
         {
@@ -40,6 +41,11 @@ public:
             return;
         }
         m_exec = ctx->m_exec;
+        m_priority = ctx->m_priority;
+#ifdef CORO_TRACE
+        m_location = handle.promise().GetLocation();
+        Trace::Record(TraceType::Suspend, handle.address(), m_location);
+#endif
         Handle();
     }
 
@@ -54,13 +60,16 @@ public:
     virtual void Handle() {}
 
     /**
-     * @brief 恢复协程
+     * @brief 恢复协程, 协程放入执行器的就绪队列, 按优先级恢复
      */
     void Resume()
     {
-        if (m_resume)
+        if (m_handle)
         {
-            m_resume();
+#ifdef CORO_TRACE
+            Trace::Record(TraceType::Resume, m_handle.address(), m_location);
+#endif
+            m_exec->Schedule(m_handle, m_priority);
         }
     }
 
@@ -72,11 +81,26 @@ public:
         return m_exec->EventBase();
     }
 
+protected:
+    /**
+     * @brief 获取协程所在的执行器, 挂起前为空
+     */
+    Executor* GetExecutor()
+    {
+        return m_exec;
+    }
+
 private:
     //! 事件循环
     Executor* m_exec = nullptr;
-    //! 恢复函数
-    std::function<void()> m_resume;
+    //! 挂起的协程
+    std::coroutine_handle<> m_handle;
+    //! 优先级
+    Priority m_priority = Priority::Normal;
+#ifdef CORO_TRACE
+    //! 挂起位置
+    std::source_location m_location;
+#endif
 };
 
 }  // namespace coro
@@ -0,0 +1,130 @@
+#include "batching_writer.h"
+#include <cerrno>
+#include "sleep.h"
+
+namespace coro
+{
+BatchingWriter::BatchingWriter(File& file, const BatchingWriterOption& option)
+    : m_file(file)
+    , m_option(option)
+{}
+
+Task<ssize_t> BatchingWriter::Append(std::string_view record)
+{
+    if (m_is_close)
+    {
+        co_return -EPIPE;
+    }
+    auto [sender, future] = MakeOneshot<ssize_t>();
+    {
+        // 与Close互斥, 否则检查后写入的请求可能排在关闭标记之后, 永远不会被处理
+        std::lock_guard lk(m_close_mut);
+        if (m_is_close || !m_chan.Push(Request{.m_record = record, .m_sender = std::move(sender)}))
+        {
+            co_return -EPIPE;
+        }
+    }
+    try
+    {
+        co_return co_await future;
+    }
+    catch (const std::future_error&)
+    {
+        // 在关闭标记之后提交, 未被写入
+        co_return -EPIPE;
+    }
+}
+
+Task<void> BatchingWriter::Run()
+{
+    bool stop = false;
+    Request req;
+    while (!stop)
+    {
+        // co_await不放在&&的右侧, gcc12在左侧为false时仍会求值
+        if (!co_await m_chan.Pop(req) || req.m_stop)
+        {
+            break;
+        }
+        std::vector<Request> batch;
+        size_t bytes = 0;
+        bytes += req.m_record.size();
+        batch.emplace_back(std::move(req));
+        stop = Collect(batch, bytes);
+        if (!stop && bytes < m_option.m_max_bytes && m_option.m_window.count() > 0)
+        {
+            // 等待窗口内的更多记录
+            co_await Sleep(0, static_cast<int>(m_option.m_window.count()));
+            stop = Collect(batch, bytes);
+        }
+        co_await Commit(batch);
+    }
+    m_chan.Close();
+}
+
+void BatchingWriter::Close()
+{
+    std::lock_guard lk(m_close_mut);
+    if (m_is_close.exchange(true))
+    {
+        return;
+    }
+    // 关闭标记排在已接收的请求之后
+    m_chan.Push(Request{.m_stop = true});
+}
+
+uint64_t BatchingWriter::GetBatchCount() const
+{
+    return m_batch_count.load(std::memory_order_relaxed);
+}
+
+uint64_t BatchingWriter::GetRecordCount() const
+{
+    return m_record_count.load(std::memory_order_relaxed);
+}
+
+bool BatchingWriter::Collect(std::vector<Request>& batch, size_t& bytes)
+{
+    Request req;
+    while (bytes < m_option.m_max_bytes && m_chan.TryPop(req))
+    {
+        if (req.m_stop)
+        {
+            return true;
+        }
+        bytes += req.m_record.size();
+        batch.emplace_back(std::move(req));
+    }
+    return false;
+}
+
+Task<void> BatchingWriter::Commit(std::vector<Request>& batch)
+{
+    std::vector<std::string_view> data;
+    data.reserve(batch.size());
+    for (auto& r : batch)
+    {
+        data.emplace_back(r.m_record);
+    }
+    auto offset = co_await m_file.Append(data);
+    if (offset >= 0 && m_option.m_fsync)
+    {
+        auto ret = co_await m_file.Fsync();
+        if (ret < 0)
+        {
+            offset = ret;
+        }
+    }
+    m_batch_count.fetch_add(1, std::memory_order_relaxed);
+    m_record_count.fetch_add(batch.size(), std::memory_order_relaxed);
+    for (auto& r : batch)
+    {
+        r.m_sender.Set(offset);
+        if (offset >= 0)
+        {
+            offset += static_cast<ssize_t>(r.m_record.size());
+        }
+    }
+}
+
+}  // namespace coro
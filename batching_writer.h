@@ -0,0 +1,115 @@
+#ifndef CORO_BATCHING_WRITER_H
+#define CORO_BATCHING_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "channel.h"
+#include "file.h"
+
+namespace coro
+{
+/**
+ * @brief 批量写入参数
+ */
+struct BatchingWriterOption
+{
+    //! 收到第一条记录后等待更多记录的时长, 为0时只合并写入期间到达的记录
+    std::chrono::milliseconds m_window{0};
+    //! 一批的最大字节数, 达到后立即写入
+    size_t m_max_bytes = 1 << 20;
+    //! 每批写入后是否fsync
+    bool m_fsync = true;
+};
+
+/**
+ * @brief 组提交写入器, 多个协程追加的记录经channel汇集, 每批一次多段写入与一次fsync,
+ *        完成后唤醒所有参与的协程并返回各自的位置
+ */
+class BatchingWriter
+{
+public:
+    BatchingWriter(const BatchingWriter&) = delete;
+    /**
+     * @brief 构造写入器
+     * @param file 文件, 需在写入器结束后关闭
+     * @param option 参数
+     */
+    explicit BatchingWriter(File& file, const BatchingWriterOption& option = {});
+
+    /**
+     * @brief 追加一条记录并等待落盘, 可在任意线程的协程中调用
+     * @param record 记录, 需保持有效直到返回
+     * @return 记录所在的位置, 失败时为-errno, 写入器已关闭时为-EPIPE
+     */
+    Task<ssize_t> Append(std::string_view record);
+
+    /**
+     * @brief 写入循环, 需在一个执行器上运行, 关闭后写完已提交的记录再结束
+     */
+    Task<void> Run();
+
+    /**
+     * @brief 关闭写入器, 之后的追加返回-EPIPE
+     */
+    void Close();
+
+    /**
+     * @brief 获取写入的批数
+     * @return
+     */
+    uint64_t GetBatchCount() const;
+
+    /**
+     * @brief 获取写入的记录数
+     * @return
+     */
+    uint64_t GetRecordCount() const;
+
+private:
+    /**
+     * @brief 追加请求
+     */
+    struct Request
+    {
+        //! 记录
+        std::string_view m_record;
+        //! 结果发送端
+        Oneshot<ssize_t> m_sender;
+        //! 关闭标记
+        bool m_stop = false;
+    };
+
+    /**
+     * @brief 取出channel中已有的请求, 直到达到字节上限
+     * @param batch 记录
+     * @param bytes 字节数
+     * @return 遇到关闭标记返回true
+     */
+    bool Collect(std::vector<Request>& batch, size_t& bytes);
+
+    /**
+     * @brief 写入一批记录并唤醒参与者
+     * @param batch 记录
+     */
+    Task<void> Commit(std::vector<Request>& batch);
+
+    //! 文件
+    File& m_file;
+    //! 参数
+    BatchingWriterOption m_option;
+    //! 追加请求
+    Channel<Request> m_chan;
+    //! 是否关闭
+    std::atomic_bool m_is_close = false;
+    //! 检查关闭与写入请求在同一临界区, 保证接收的请求都排在关闭标记之前
+    std::mutex m_close_mut;
+    //! 写入的批数
+    std::atomic_uint64_t m_batch_count = 0;
+    //! 写入的记录数
+    std::atomic_uint64_t m_record_count = 0;
+};
+
+}  // namespace coro
+
+#endif  // CORO_BATCHING_WRITER_H
@@ -0,0 +1,137 @@
+#include "channel.h"
+#include "spsc_channel.h"
+#include "util.h"
+
+//! 每轮传输的数据量
+constexpr int64_t kItems = 100000;
+
+/**
+ * @brief 多个生产线程写入, 多个消费协程读取
+ * @param state range(0)为生产者数, range(1)为消费者数
+ */
+static void BM_ChannelThroughput(benchmark::State& state)
+{
+    auto producers = state.range(0);
+    auto consumers = state.range(1);
+    for (auto _ : state)
+    {
+        coro::Channel<int64_t> chan;
+        std::atomic_int64_t count = 0;
+        std::vector<std::jthread> threads;
+        for (int64_t i = 0; i < consumers; i++)
+        {
+            threads.emplace_back(RunLoopThread([&]() -> coro::Task<void> {
+                int64_t val = 0;
+                while (co_await chan.Pop(val))
+                {
+                    if (++count == kItems)
+                    {
+                        chan.Close();
+                    }
+                }
+            }));
+        }
+        for (int64_t i = 0; i < producers; i++)
+        {
+            threads.emplace_back([&, i] {
+                for (int64_t j = i; j < kItems; j += producers)
+                {
+                    chan.Push(j);
+                }
+            });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kItems);
+}
+BENCHMARK(BM_ChannelThroughput)->ArgNames({"producer", "consumer"})->Args({1, 1})->Args({4, 1})->Args({4, 4})->UseRealTime();
+
+/**
+ * @brief 两个线程上的协程通过两个channel往返传递数据
+ */
+static void BM_ChannelPingPong(benchmark::State& state)
+{
+    constexpr int64_t kRounds = 1000;
+    for (auto _ : state)
+    {
+        coro::Channel<int64_t> ping;
+        coro::Channel<int64_t> pong;
+        auto t1 = RunLoopThread([&]() -> coro::Task<void> {
+            int64_t val = 0;
+            for (int64_t i = 0; i < kRounds; i++)
+            {
+                ping.Push(i);
+                co_await pong.Pop(val);
+            }
+        });
+        auto t2 = RunLoopThread([&]() -> coro::Task<void> {
+            int64_t val = 0;
+            for (int64_t i = 0; i < kRounds; i++)
+            {
+                co_await ping.Pop(val);
+                pong.Push(val);
+            }
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * kRounds);
+}
+BENCHMARK(BM_ChannelPingPong)->UseRealTime();
+
+/**
+ * @brief 单生产者单消费者的无锁channel, 与BM_ChannelThroughput/producer:1/consumer:1对比
+ */
+static void BM_SpscChannelThroughput(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        coro::SpscChannel<int64_t> chan(state.range(0));
+        auto consumer = RunLoopThread([&]() -> coro::Task<void> {
+            int64_t val = 0;
+            while (co_await chan.Pop(val))
+            {
+            }
+        });
+        for (int64_t i = 0; i < kItems;)
+        {
+            if (chan.Push(i))
+            {
+                i++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        while (!chan.IsEmpty())
+        {
+            std::this_thread::yield();
+        }
+        chan.Close();
+    }
+    state.SetItemsProcessed(state.iterations() * kItems);
+}
+BENCHMARK(BM_SpscChannelThroughput)->ArgName("capacity")->Arg(1024)->UseRealTime();
+
+/**
+ * @brief 数据已就绪时的Pop开销, 不挂起协程
+ */
+static void BM_ChannelPopReady(benchmark::State& state)
+{
+    constexpr int64_t kBatch = 1000;
+    coro::Channel<int64_t> chan;
+    RunLoop([&]() -> coro::Task<void> {
+        int64_t val = 0;
+        for (auto _ : state)
+        {
+            for (int64_t i = 0; i < kBatch; i++)
+            {
+                chan.Push(i);
+            }
+            for (int64_t i = 0; i < kBatch; i++)
+            {
+                co_await chan.Pop(val);
+            }
+        }
+    });
+    state.SetItemsProcessed(state.iterations() * kBatch);
+}
+BENCHMARK(BM_ChannelPopReady);
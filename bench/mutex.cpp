@@ -0,0 +1,58 @@
+#include "mutex.h"
+#include "util.h"
+
+/**
+ * @brief 无竞争时加锁与解锁的开销
+ */
+static void BM_MutexUncontended(benchmark::State& state)
+{
+    coro::Mutex mut;
+    RunLoop([&]() -> coro::Task<void> {
+        for (auto _ : state)
+        {
+            coro::LockGuard lk = co_await mut.Lock();
+        }
+    });
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MutexUncontended);
+
+/**
+ * @brief 多个线程上的协程竞争同一个锁
+ * @param state range(0)为线程数
+ */
+static void BM_MutexContention(benchmark::State& state)
+{
+    constexpr int64_t kLocks = 10000;
+    constexpr int64_t kCoroutines = 4;
+    auto num = state.range(0);
+    for (auto _ : state)
+    {
+        coro::Mutex mut;
+        int64_t counter = 0;
+        std::vector<std::jthread> threads;
+        for (int64_t i = 0; i < num; i++)
+        {
+            threads.emplace_back([&] {
+                auto base = event_base_new();
+                {
+                    coro::Executor exec(base);
+                    for (int64_t j = 0; j < kCoroutines; j++)
+                    {
+                        exec.RunTask([&]() -> coro::Task<void> {
+                            for (int64_t k = 0; k < kLocks; k++)
+                            {
+                                coro::LockGuard lk = co_await mut.Lock();
+                                counter++;
+                            }
+                        });
+                    }
+                    event_base_dispatch(base);
+                }
+                event_base_free(base);
+            });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num * kCoroutines * kLocks);
+}
+BENCHMARK(BM_MutexContention)->ArgName("thread")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
@@ -0,0 +1,66 @@
+#include <cmath>
+#include <numeric>
+#include <random>
+#include "parallel.h"
+#include "util.h"
+
+/**
+ * @brief 并行计算每个元素, CPU密集
+ * @param state range(0)为工作线程数
+ */
+static void BM_ParallelFor(benchmark::State& state)
+{
+    coro::ThreadPool pool(state.range(0));
+    std::vector<double> data(1 << 20, 1.0);
+    for (auto _ : state)
+    {
+        RunLoop([&]() -> coro::Task<void> {
+            co_await coro::ParallelFor(pool, data, [](double& v) { v = std::sqrt(v + 1.0); });
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_ParallelFor)->ArgName("worker")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+/**
+ * @brief 并行求和
+ * @param state range(0)为工作线程数
+ */
+static void BM_ParallelReduce(benchmark::State& state)
+{
+    coro::ThreadPool pool(state.range(0));
+    std::vector<int64_t> data(1 << 22);
+    std::iota(data.begin(), data.end(), 0);
+    for (auto _ : state)
+    {
+        RunLoop([&]() -> coro::Task<void> {
+            benchmark::DoNotOptimize(co_await coro::ParallelReduce(pool, data, int64_t(0)));
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_ParallelReduce)->ArgName("worker")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+/**
+ * @brief 并行排序随机数
+ * @param state range(0)为工作线程数
+ */
+static void BM_ParallelSort(benchmark::State& state)
+{
+    coro::ThreadPool pool(state.range(0));
+    std::mt19937 rng(42);
+    std::vector<uint32_t> origin(1 << 20);
+    for (auto& v : origin)
+    {
+        v = rng();
+    }
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto data = origin;
+        state.ResumeTiming();
+        RunLoop([&]() -> coro::Task<void> { co_await coro::ParallelSort(pool, data); });
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(origin.size()));
+}
+BENCHMARK(BM_ParallelSort)->ArgName("worker")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
@@ -0,0 +1,73 @@
+#include "pipeline.h"
+#include "util.h"
+
+/**
+ * @brief 有界channel在同一执行器上的吞吐
+ * @param state range(0)为容量
+ */
+static void BM_BoundedChannel(benchmark::State& state)
+{
+    constexpr int kCount = 1 << 16;
+    for (auto _ : state)
+    {
+        coro::BoundedChannel<int> chan(state.range(0));
+        RunLoop([&]() -> coro::Task<void> {
+            auto exec = coro::Executor::Current();
+            exec->RunTask([&]() -> coro::Task<void> {
+                for (int i = 0; i < kCount; i++)
+                {
+                    co_await chan.Push(i);
+                }
+                chan.Close();
+            });
+            int value = 0;
+            int64_t sum = 0;
+            while (co_await chan.Pop(value))
+            {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * kCount);
+}
+BENCHMARK(BM_BoundedChannel)->ArgName("capacity")->Arg(1)->Arg(64)->Arg(1024);
+
+/**
+ * @brief 三个Map阶段的流水线的吞吐
+ * @param state range(0)为阶段间channel的容量
+ */
+static void BM_PipelineMap(benchmark::State& state)
+{
+    constexpr int kCount = 1 << 16;
+    for (auto _ : state)
+    {
+        coro::Pipeline pipeline;
+        coro::StageOption option{.m_capacity = static_cast<size_t>(state.range(0))};
+        auto source = pipeline.Source<int>(state.range(0));
+        auto output = source.Map([](int v) { return v + 1; }, option).Map([](int v) { return v * 2; }, option).Map([](int v) { return v - 1; }, option);
+        RunLoop([&]() -> coro::Task<void> {
+            pipeline.Start();
+            auto exec = coro::Executor::Current();
+            exec->RunTask([&]() -> coro::Task<void> {
+                auto chan = source.GetChannel();
+                for (int i = 0; i < kCount; i++)
+                {
+                    co_await chan->Push(i);
+                }
+                chan->Close();
+            });
+            int value = 0;
+            int64_t sum = 0;
+            auto chan = output.GetChannel();
+            while (co_await chan->Pop(value))
+            {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+            co_await pipeline.Wait();
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * kCount);
+}
+BENCHMARK(BM_PipelineMap)->ArgName("capacity")->Arg(1)->Arg(64)->Arg(1024);
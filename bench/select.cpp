@@ -0,0 +1,38 @@
+#include "select.h"
+#include "util.h"
+
+/**
+ * @brief 一个协程等待N个channel, 另一个线程轮流写入
+ */
+template <size_t N>
+static void BM_Select(benchmark::State& state)
+{
+    constexpr int64_t kItems = 10000;
+    for (auto _ : state)
+    {
+        std::array<coro::Channel<int64_t>, N> chans;
+        auto consumer = RunLoopThread([&]() -> coro::Task<void> {
+            int64_t count = 0;
+            int64_t val = 0;
+            while (count < kItems)
+            {
+                co_await std::apply([](auto&... chan) { return coro::Select(chan...); }, chans);
+                for (auto& chan : chans)
+                {
+                    while (chan.TryPop(val))
+                    {
+                        count++;
+                    }
+                }
+            }
+        });
+        for (int64_t i = 0; i < kItems; i++)
+        {
+            chans[i % N].Push(i);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kItems);
+}
+BENCHMARK(BM_Select<2>)->UseRealTime();
+BENCHMARK(BM_Select<4>)->UseRealTime();
+BENCHMARK(BM_Select<8>)->UseRealTime();
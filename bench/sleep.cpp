@@ -0,0 +1,26 @@
+#include "sleep.h"
+#include "util.h"
+
+/**
+ * @brief 同一个执行器上的大量定时器
+ * @param state range(0)为协程数
+ */
+static void BM_SleepTimers(benchmark::State& state)
+{
+    auto num = state.range(0);
+    for (auto _ : state)
+    {
+        auto base = event_base_new();
+        {
+            coro::Executor exec(base);
+            for (int64_t i = 0; i < num; i++)
+            {
+                exec.RunTask([i]() -> coro::Task<void> { co_await coro::Sleep(0, static_cast<int>(i % 10)); });
+            }
+            event_base_dispatch(base);
+        }
+        event_base_free(base);
+    }
+    state.SetItemsProcessed(state.iterations() * num);
+}
+BENCHMARK(BM_SleepTimers)->Arg(100000)->Unit(benchmark::kMillisecond)->UseRealTime();
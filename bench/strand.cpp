@@ -0,0 +1,85 @@
+#include "strand.h"
+#include "util.h"
+
+/**
+ * @brief 无竞争时进入与离开strand的开销, 与BM_MutexUncontended对比
+ */
+static void BM_StrandUncontended(benchmark::State& state)
+{
+    coro::Strand strand;
+    RunLoop([&]() -> coro::Task<void> {
+        for (auto _ : state)
+        {
+            coro::StrandGuard guard = co_await strand.Enter();
+        }
+    });
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StrandUncontended);
+
+/**
+ * @brief 多个线程上的协程竞争同一个strand, 与BM_MutexContention对比
+ * @param state range(0)为线程数
+ */
+static void BM_StrandContention(benchmark::State& state)
+{
+    constexpr int64_t kEnters = 10000;
+    constexpr int64_t kCoroutines = 4;
+    auto num = state.range(0);
+    for (auto _ : state)
+    {
+        coro::Strand strand;
+        int64_t counter = 0;
+        std::vector<std::jthread> threads;
+        for (int64_t i = 0; i < num; i++)
+        {
+            threads.emplace_back([&] {
+                auto base = event_base_new();
+                {
+                    coro::Executor exec(base);
+                    for (int64_t j = 0; j < kCoroutines; j++)
+                    {
+                        exec.RunTask([&]() -> coro::Task<void> {
+                            for (int64_t k = 0; k < kEnters; k++)
+                            {
+                                coro::StrandGuard guard = co_await strand.Enter();
+                                counter++;
+                            }
+                        });
+                    }
+                    event_base_dispatch(base);
+                }
+                event_base_free(base);
+            });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * num * kCoroutines * kEnters);
+}
+BENCHMARK(BM_StrandContention)->ArgName("thread")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+/**
+ * @brief 从另一个线程向strand投递任务, 连续的任务在同一协程中执行
+ */
+static void BM_StrandPost(benchmark::State& state)
+{
+    constexpr int64_t kTasks = 10000;
+    coro::ThreadPool pool(1);
+    for (auto _ : state)
+    {
+        coro::Strand strand(pool);
+        std::atomic_int64_t counter = 0;
+        for (int64_t i = 0; i < kTasks; i++)
+        {
+            strand.Post([&]() -> coro::Task<void> {
+                counter.fetch_add(1, std::memory_order_relaxed);
+                co_return;
+            });
+        }
+        while (counter.load(std::memory_order_relaxed) < kTasks || !strand.IsIdle())
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+BENCHMARK(BM_StrandPost)->UseRealTime();
@@ -0,0 +1,43 @@
+#include "util.h"
+
+coro::Task<int> Leaf(int val)
+{
+    co_return val;
+}
+
+coro::Task<int> Middle(int val)
+{
+    co_return co_await Leaf(val) + 1;
+}
+
+static void BM_TaskCreate(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto task = Leaf(1);
+        benchmark::DoNotOptimize(task);
+    }
+}
+BENCHMARK(BM_TaskCreate);
+
+static void BM_TaskAwait(benchmark::State& state)
+{
+    RunLoop([&state]() -> coro::Task<void> {
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(co_await Leaf(1));
+        }
+    });
+}
+BENCHMARK(BM_TaskAwait);
+
+static void BM_TaskAwaitNested(benchmark::State& state)
+{
+    RunLoop([&state]() -> coro::Task<void> {
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(co_await Middle(1));
+        }
+    });
+}
+BENCHMARK(BM_TaskAwaitNested);
@@ -0,0 +1,61 @@
+#include "thread_pool.h"
+#include "util.h"
+
+/**
+ * @brief 向线程池提交任务的吞吐
+ * @param state range(0)为工作线程数
+ */
+static void BM_PoolAdd(benchmark::State& state)
+{
+    constexpr int64_t kTasks = 10000;
+    coro::ThreadPool pool(state.range(0));
+    std::atomic_int64_t count = 0;
+    for (auto _ : state)
+    {
+        count = 0;
+        for (int64_t i = 0; i < kTasks; i++)
+        {
+            pool.Add([&count]() -> coro::Task<void> {
+                count++;
+                co_return;
+            });
+        }
+        while (count < kTasks)
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+BENCHMARK(BM_PoolAdd)->ArgName("worker")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+/**
+ * @brief 批量提交任务的吞吐, 每个工作线程只加锁与通知一次
+ * @param state range(0)为工作线程数
+ */
+static void BM_PoolAddBatch(benchmark::State& state)
+{
+    constexpr int64_t kTasks = 10000;
+    constexpr int64_t kBatch = 100;
+    coro::ThreadPool pool(state.range(0));
+    std::atomic_int64_t count = 0;
+    auto task = [&count]() -> coro::Task<void> {
+        count++;
+        co_return;
+    };
+    std::vector<decltype(task)> batch(kBatch, task);
+    for (auto _ : state)
+    {
+        count = 0;
+        for (int64_t i = 0; i < kTasks; i += kBatch)
+        {
+            pool.AddBatch(batch);
+        }
+        while (count < kTasks)
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kTasks);
+}
+BENCHMARK(BM_PoolAddBatch)->ArgName("worker")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
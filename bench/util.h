@@ -0,0 +1,33 @@
+#ifndef CORO_BENCH_UTIL_H
+#define CORO_BENCH_UTIL_H
+
+#include <benchmark/benchmark.h>
+#include <thread>
+#include "executor.h"
+#include "task.h"
+
+/**
+ * @brief 在当前线程运行事件循环, 直到协程结束
+ * @param func 协程
+ */
+inline void RunLoop(const std::function<coro::Task<void>()>& func)
+{
+    auto base = event_base_new();
+    {
+        coro::Executor exec(base);
+        exec.RunTask(func);
+        event_base_dispatch(base);
+    }
+    event_base_free(base);
+}
+
+/**
+ * @brief 在新线程运行事件循环
+ * @param func 协程
+ */
+inline std::jthread RunLoopThread(const std::function<coro::Task<void>()>& func)
+{
+    return std::jthread([func] { RunLoop(func); });
+}
+
+#endif  // CORO_BENCH_UTIL_H
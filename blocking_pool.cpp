@@ -0,0 +1,126 @@
+#include "blocking_pool.h"
+#include <algorithm>
+#include "metrics.h"
+
+namespace coro
+{
+BlockingPool::BlockingPool(const BlockingPoolOption& option)
+    : m_option(option)
+{
+    m_option.m_max_threads = std::max<size_t>(m_option.m_max_threads, 1);
+}
+
+BlockingPool::~BlockingPool()
+{
+    std::list<std::thread> threads;
+    {
+        std::lock_guard lk(m_mut);
+        m_stop = true;
+        threads.splice(threads.end(), m_threads);
+        threads.splice(threads.end(), m_exited);
+    }
+    m_cv.notify_all();
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    // 工作线程已执行完排队的任务; 没有工作线程时在此执行, 不留下未完成的结果
+    while (!m_queue.empty())
+    {
+        auto item = std::move(m_queue.front());
+        m_queue.pop_front();
+        item.m_func();
+    }
+}
+
+bool BlockingPool::Post(std::function<void()> func)
+{
+    Reap();
+    {
+        std::lock_guard lk(m_mut);
+        if (m_stop)
+        {
+            return false;
+        }
+        m_queue.emplace_back(Item{.m_func = std::move(func), .m_enqueue_ns = NowNs()});
+        // 空闲线程不足以处理排队的任务时扩容
+        if (m_queue.size() > m_idle && m_threads.size() < m_option.m_max_threads)
+        {
+            m_threads.emplace_back([this] { Loop(); });
+        }
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+BlockingPoolStats BlockingPool::GetStats()
+{
+    std::lock_guard lk(m_mut);
+    return BlockingPoolStats{.m_threads = m_threads.size(), .m_idle = m_idle, .m_queued = m_queue.size(), .m_completed = m_completed};
+}
+
+BlockingPool& BlockingPool::Default()
+{
+    static BlockingPool pool;
+    return pool;
+}
+
+void BlockingPool::Loop()
+{
+    std::unique_lock lk(m_mut);
+    while (true)
+    {
+        if (m_queue.empty())
+        {
+            // 停止后先执行完排队的任务再退出
+            if (m_stop)
+            {
+                break;
+            }
+            m_idle++;
+            bool ready = m_cv.wait_for(lk, m_option.m_idle_timeout, [this] { return m_stop || !m_queue.empty(); });
+            m_idle--;
+            if (!ready)
+            {
+                break;
+            }
+            continue;
+        }
+        auto item = std::move(m_queue.front());
+        m_queue.pop_front();
+        lk.unlock();
+        if constexpr (kMetricsEnabled)
+        {
+            auto& metrics = Metrics::Local();
+            metrics.m_blocking_task.Add();
+            metrics.m_blocking_queue_time.Record(NowNs() - item.m_enqueue_ns);
+        }
+        item.m_func();
+        // 结果与捕获的资源在锁外释放
+        item.m_func = nullptr;
+        lk.lock();
+        m_completed++;
+    }
+    // 空闲退出, 由之后的Post或析构回收; 停止时线程已被析构函数取走
+    auto id = std::this_thread::get_id();
+    auto it = std::find_if(m_threads.begin(), m_threads.end(), [id](auto& t) { return t.get_id() == id; });
+    if (it != m_threads.end())
+    {
+        m_exited.splice(m_exited.end(), m_threads, it);
+    }
+}
+
+void BlockingPool::Reap()
+{
+    std::list<std::thread> exited;
+    {
+        std::lock_guard lk(m_mut);
+        exited.swap(m_exited);
+    }
+    for (auto& t : exited)
+    {
+        t.join();
+    }
+}
+
+}  // namespace coro
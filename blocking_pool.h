@@ -0,0 +1,167 @@
+#ifndef CORO_BLOCKING_POOL_H
+#define CORO_BLOCKING_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include "future.h"
+
+namespace coro
+{
+/**
+ * @brief 阻塞线程池参数
+ */
+struct BlockingPoolOption
+{
+    //! 最多线程数, 即同时执行的阻塞任务数
+    size_t m_max_threads = 64;
+    //! 线程空闲超过该时长后退出
+    std::chrono::milliseconds m_idle_timeout{10000};
+};
+
+/**
+ * @brief 阻塞线程池的状态
+ */
+struct BlockingPoolStats
+{
+    //! 当前线程数
+    size_t m_threads = 0;
+    //! 空闲线程数
+    size_t m_idle = 0;
+    //! 排队的任务数
+    size_t m_queued = 0;
+    //! 执行完成的任务数
+    uint64_t m_completed = 0;
+};
+
+/**
+ * @brief 执行阻塞调用的弹性线程池, 没有空闲线程时按需创建线程, 线程数达到上限后任务排队,
+ *        线程空闲一段时间后退出
+ */
+class BlockingPool
+{
+public:
+    explicit BlockingPool(const BlockingPoolOption& option = {});
+
+    /**
+     * @brief 停止接收任务, 等待正在执行与排队的任务全部执行完, 结果在析构返回前设置;
+     *        之后不会再访问等待结果的执行器
+     */
+    ~BlockingPool();
+
+    /**
+     * @brief 在线程池中执行函数
+     * @param func 函数, 需可复制
+     * @return 结果, 可co_await, 协程在原执行器上恢复; 函数抛出的异常由结果重新抛出
+     */
+    template <typename F>
+    auto Run(F func) -> Future<std::invoke_result_t<F&>>;
+
+    /**
+     * @brief 在线程池中执行函数, 不关心结果
+     * @param func 函数
+     * @return 线程池已停止返回false
+     */
+    bool Post(std::function<void()> func);
+
+    /**
+     * @brief 获取线程池的状态
+     * @return
+     */
+    BlockingPoolStats GetStats();
+
+    /**
+     * @brief 获取默认的阻塞线程池, 在静态析构时停止并执行完排队的任务,
+     *        此时仍在等待结果的执行器需尚未析构
+     * @return
+     */
+    static BlockingPool& Default();
+
+private:
+    /**
+     * @brief 排队的任务
+     */
+    struct Item
+    {
+        //! 函数
+        std::function<void()> m_func;
+        //! 入队时间, 纳秒
+        uint64_t m_enqueue_ns = 0;
+    };
+
+    /**
+     * @brief 工作线程循环
+     */
+    void Loop();
+
+    /**
+     * @brief 回收已退出的线程
+     */
+    void Reap();
+
+    //! 参数
+    BlockingPoolOption m_option;
+    //! 互斥锁
+    std::mutex m_mut;
+    //! 任务通知
+    std::condition_variable m_cv;
+    //! 任务队列
+    std::deque<Item> m_queue;
+    //! 运行中的线程
+    std::list<std::thread> m_threads;
+    //! 已退出待回收的线程
+    std::list<std::thread> m_exited;
+    //! 空闲线程数
+    size_t m_idle = 0;
+    //! 执行完成的任务数
+    uint64_t m_completed = 0;
+    //! 是否停止
+    bool m_stop = false;
+};
+
+template <typename F>
+auto BlockingPool::Run(F func) -> Future<std::invoke_result_t<F&>>
+{
+    using R = std::invoke_result_t<F&>;
+    auto [sender, future] = MakeOneshot<R>();
+    // std::function要求可复制, 发送端共享
+    auto shared = std::make_shared<Oneshot<R>>(std::move(sender));
+    Post([func = std::move(func), shared]() mutable {
+        try
+        {
+            if constexpr (std::is_void_v<R>)
+            {
+                func();
+                shared->Set();
+            }
+            else
+            {
+                shared->Set(func());
+            }
+        }
+        catch (...)
+        {
+            shared->SetException(std::current_exception());
+        }
+    });
+    return std::move(future);
+}
+
+/**
+ * @brief 在默认的阻塞线程池中执行函数, co_await等待结果, 不阻塞执行器
+ * @param func 函数, 需可复制
+ * @return 结果
+ */
+template <typename F>
+auto Blocking(F func)
+{
+    return BlockingPool::Default().Run(std::move(func));
+}
+
+}  // namespace coro
+
+#endif  // CORO_BLOCKING_POOL_H
@@ -0,0 +1,470 @@
+#ifndef CORO_BOUNDED_CHANNEL_H
+#define CORO_BOUNDED_CHANNEL_H
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include "wait_queue.h"
+
+namespace coro
+{
+template <typename T>
+class BoundedPushAwaiter;
+template <typename T>
+class BoundedPopAwaiter;
+namespace detail
+{
+template <typename T, typename Derived>
+class BoundedAwaiterBase;
+}
+
+/**
+ * @brief 有容量上限的多生产者多消费者channel, 写满时写入的协程挂起直到有空间, 形成背压;
+ *        等待者挂在channel上, 唤醒后在所在执行器上重试, 不占用fd
+ * @tparam T 数据类型, 需可默认构造
+ */
+template <typename T>
+class BoundedChannel
+{
+public:
+    BoundedChannel(const BoundedChannel&) = delete;
+    /**
+     * @brief 构造channel
+     * @param capacity 容量, 至少为1
+     */
+    explicit BoundedChannel(size_t capacity)
+        : m_capacity(capacity == 0 ? 1 : capacity)
+    {}
+
+    /**
+     * @brief 写入数据, 写满时挂起
+     * @param t 数据
+     * @return 等待器, co_await写入成功返回true, 关闭后返回false
+     */
+    BoundedPushAwaiter<T> Push(T t)
+    {
+        return BoundedPushAwaiter<T>(*this, std::move(t));
+    }
+
+    /**
+     * @brief 尝试写入数据, 不挂起
+     * @param t 数据, 写入成功时被移走
+     * @return 写满或已关闭时返回false
+     */
+    bool TryPush(T& t)
+    {
+        std::shared_ptr<detail::WaitNode> node;
+        {
+            std::lock_guard lk(m_mut);
+            if (!TryPushLocked(t, node))
+            {
+                return false;
+            }
+        }
+        WakeOne(m_pop_waiters, std::move(node));
+        return true;
+    }
+
+    /**
+     * @brief 获取数据, 为空时挂起; 关闭后仍先读完剩余的数据
+     * @param t 数据引用
+     * @return 等待器, co_await获取成功返回true, 关闭且为空时返回false
+     */
+    BoundedPopAwaiter<T> Pop(T& t)
+    {
+        return BoundedPopAwaiter<T>(*this, t, std::chrono::milliseconds(-1));
+    }
+
+    /**
+     * @brief 获取数据, 最多等待timeout
+     * @param t 数据引用
+     * @param timeout 超时时间
+     * @return 等待器, co_await获取成功返回true, 超时或关闭且为空时返回false
+     */
+    BoundedPopAwaiter<T> PopFor(T& t, std::chrono::milliseconds timeout)
+    {
+        return BoundedPopAwaiter<T>(*this, t, timeout < std::chrono::milliseconds(0) ? std::chrono::milliseconds(0) : timeout);
+    }
+
+    /**
+     * @brief 尝试获取数据, 不挂起
+     * @param t 数据引用
+     * @return 获取成功返回true
+     */
+    bool TryPop(T& t)
+    {
+        std::shared_ptr<detail::WaitNode> node;
+        {
+            std::lock_guard lk(m_mut);
+            if (!TryPopLocked(t, node))
+            {
+                return false;
+            }
+        }
+        WakeOne(m_push_waiters, std::move(node));
+        return true;
+    }
+
+    /**
+     * @brief 关闭channel, 唤醒所有等待的协程; 之后的写入失败, 读取在数据读完后失败
+     */
+    void Close()
+    {
+        detail::WaitQueue push_waiters;
+        detail::WaitQueue pop_waiters;
+        {
+            std::lock_guard lk(m_mut);
+            if (m_is_close)
+            {
+                return;
+            }
+            m_is_close = true;
+            std::swap(push_waiters, m_push_waiters);
+            std::swap(pop_waiters, m_pop_waiters);
+        }
+        push_waiters.WakeAll();
+        pop_waiters.WakeAll();
+    }
+
+    bool IsClose()
+    {
+        std::lock_guard lk(m_mut);
+        return m_is_close;
+    }
+
+    /**
+     * @brief 获取排队的数据量
+     * @return
+     */
+    size_t Size()
+    {
+        std::lock_guard lk(m_mut);
+        return m_queue.size();
+    }
+
+    size_t Capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    friend class BoundedPushAwaiter<T>;
+    friend class BoundedPopAwaiter<T>;
+    template <typename, typename>
+    friend class detail::BoundedAwaiterBase;
+
+    /**
+     * @brief 在锁外唤醒一个等待者, 等待者已超时或撤销时唤醒下一个
+     * @param waiters 等待队列
+     * @param node 已取出的等待者
+     */
+    void WakeOne(detail::WaitQueue& waiters, std::shared_ptr<detail::WaitNode> node)
+    {
+        while (node && !detail::Wake(node))
+        {
+            std::lock_guard lk(m_mut);
+            node = waiters.Pop();
+        }
+    }
+
+    /**
+     * @brief 写入数据, 需持有锁
+     * @param t 数据
+     * @param node 需要唤醒的读取者, 在锁外唤醒
+     * @return
+     */
+    bool TryPushLocked(T& t, std::shared_ptr<detail::WaitNode>& node)
+    {
+        if (m_is_close || m_queue.size() >= m_capacity)
+        {
+            return false;
+        }
+        m_queue.emplace_back(std::move(t));
+        node = m_pop_waiters.Pop();
+        return true;
+    }
+
+    /**
+     * @brief 读取数据, 需持有锁
+     * @param t 数据引用
+     * @param node 需要唤醒的写入者, 在锁外唤醒
+     * @return
+     */
+    bool TryPopLocked(T& t, std::shared_ptr<detail::WaitNode>& node)
+    {
+        if (m_queue.empty())
+        {
+            return false;
+        }
+        t = std::move(m_queue.front());
+        m_queue.pop_front();
+        // 排空到一半再唤醒写入者, 使其一次写入多条, 避免每读一条就切换一次
+        if (m_queue.size() <= m_capacity / 2)
+        {
+            node = m_push_waiters.Pop();
+        }
+        return true;
+    }
+
+    //! 容量
+    const size_t m_capacity;
+    //! 保护队列与等待者
+    std::mutex m_mut;
+    //! 数据
+    std::deque<T> m_queue;
+    //! 是否关闭
+    bool m_is_close = false;
+    //! 等待空间的协程
+    detail::WaitQueue m_push_waiters;
+    //! 等待数据的协程
+    detail::WaitQueue m_pop_waiters;
+};
+
+namespace detail
+{
+/**
+ * @brief BoundedChannel等待器的公共部分: 被唤醒后在本线程重试, 失败则重新登记;
+ *        唤醒未处理就销毁时转给下一个等待者, 避免丢失唤醒
+ * @tparam T 数据类型
+ * @tparam Derived 等待器类型, 提供TryLocked, IsDone与OnFinish
+ */
+template <typename T, typename Derived>
+class BoundedAwaiterBase : public WaitAwaiter
+{
+public:
+    BoundedAwaiterBase(BoundedChannel<T>& chan, WaitQueue& waiters)
+        : m_chan(chan)
+        , m_waiters(waiters)
+    {}
+
+    ~BoundedAwaiterBase() override
+    {
+        if (!m_node)
+        {
+            return;
+        }
+        std::shared_ptr<WaitNode> next;
+        {
+            // 在锁内移除并标记, 取出节点的唤醒方由标记决定归属
+            std::lock_guard lk(m_chan.m_mut);
+            m_waiters.Remove(m_node);
+            if (Abandon(m_node) && !m_woken)
+            {
+                // 已被唤醒但未处理, 转给下一个等待者
+                next = m_waiters.Pop();
+            }
+        }
+        m_chan.WakeOne(m_waiters, std::move(next));
+    }
+
+    void Handle() override
+    {
+        Park();
+    }
+
+    /**
+     * @brief 被唤醒后重试
+     */
+    void OnWake() override
+    {
+        m_woken = true;
+        Park();
+    }
+
+    bool await_resume() const
+    {
+        return m_result;
+    }
+
+protected:
+    /**
+     * @brief 加锁后重试, 成功或已关闭时恢复协程, 否则登记等待
+     */
+    void Park()
+    {
+        std::shared_ptr<WaitNode> wake;
+        {
+            std::unique_lock lk(m_chan.m_mut);
+            m_result = Self().TryLocked(wake);
+            if (!m_result && !Self().IsDone())
+            {
+                if (m_node)
+                {
+                    // 上一个等待者已唤醒, 其引用在唤醒结束后释放
+                    m_node->m_awaiter = nullptr;
+                }
+                m_node = MakeWaitNode(this, GetExecutor());
+                m_woken = false;
+                m_waiters.Push(m_node);
+                return;
+            }
+        }
+        // 写入唤醒读取者, 读取唤醒写入者
+        m_chan.WakeOne(&m_waiters == &m_chan.m_push_waiters ? m_chan.m_pop_waiters : m_chan.m_push_waiters, std::move(wake));
+        Self().OnFinish();
+        Resume();
+    }
+
+    Derived& Self()
+    {
+        return static_cast<Derived&>(*this);
+    }
+
+    //! channel
+    BoundedChannel<T>& m_chan;
+    //! 登记的等待队列
+    WaitQueue& m_waiters;
+    //! 等待者
+    std::shared_ptr<WaitNode> m_node;
+    //! 当前等待者的唤醒是否已处理
+    bool m_woken = false;
+    //! 是否成功
+    bool m_result = false;
+};
+}  // namespace detail
+
+/**
+ * @brief BoundedChannel::Push的等待器, 有空间时不挂起
+ * @tparam T 数据类型
+ */
+template <typename T>
+class BoundedPushAwaiter : public detail::BoundedAwaiterBase<T, BoundedPushAwaiter<T>>
+{
+    using Base = detail::BoundedAwaiterBase<T, BoundedPushAwaiter<T>>;
+
+public:
+    BoundedPushAwaiter(BoundedChannel<T>& chan, T t)
+        : Base(chan, chan.m_push_waiters)
+        , m_value(std::move(t))
+    {}
+
+    bool await_ready()
+    {
+        this->m_result = this->m_chan.TryPush(m_value);
+        return this->m_result;
+    }
+
+private:
+    friend Base;
+
+    bool TryLocked(std::shared_ptr<detail::WaitNode>& node)
+    {
+        return this->m_chan.TryPushLocked(m_value, node);
+    }
+
+    bool IsDone() const
+    {
+        return this->m_chan.m_is_close;
+    }
+
+    void OnFinish() {}
+
+    //! 待写入的数据
+    T m_value;
+};
+
+/**
+ * @brief BoundedChannel::Pop的等待器, 有数据时不挂起, 可设置超时
+ * @tparam T 数据类型
+ */
+template <typename T>
+class BoundedPopAwaiter : public detail::BoundedAwaiterBase<T, BoundedPopAwaiter<T>>
+{
+    using Base = detail::BoundedAwaiterBase<T, BoundedPopAwaiter<T>>;
+
+public:
+    BoundedPopAwaiter(BoundedChannel<T>& chan, T& t, std::chrono::milliseconds timeout)
+        : Base(chan, chan.m_pop_waiters)
+        , m_value(t)
+        , m_timeout(timeout)
+    {}
+
+    ~BoundedPopAwaiter() override
+    {
+        if (m_event)
+        {
+            this->GetExecutor()->CancelTimer(m_event);
+            event_free(m_event);
+        }
+    }
+
+    bool await_ready()
+    {
+        this->m_result = this->m_chan.TryPop(m_value);
+        return this->m_result || m_timeout.count() == 0;
+    }
+
+    /**
+     * @brief 登记等待, 设置了超时则同时启动定时器
+     */
+    void Handle() override
+    {
+        if (m_timeout.count() > 0)
+        {
+            m_event = evtimer_new(this->EventBase(), OnTimeout, this);
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(m_timeout).count();
+            this->GetExecutor()->AddTimer(m_event, timeval{.tv_sec = us / 1000000, .tv_usec = us % 1000000});
+        }
+        this->Park();
+    }
+
+private:
+    friend Base;
+
+    bool TryLocked(std::shared_ptr<detail::WaitNode>& node)
+    {
+        return this->m_chan.TryPopLocked(m_value, node);
+    }
+
+    bool IsDone() const
+    {
+        return this->m_chan.m_is_close || m_expired;
+    }
+
+    /**
+     * @brief 恢复前停止定时器
+     */
+    void OnFinish()
+    {
+        if (m_event)
+        {
+            this->GetExecutor()->CancelTimer(m_event);
+        }
+    }
+
+    /**
+     * @brief 超时, 撤销等待; 唤醒已在途时由唤醒后的重试结束等待
+     * @param arg this指针
+     */
+    static void OnTimeout(evutil_socket_t, short, void* arg)
+    {
+        auto pthis = static_cast<BoundedPopAwaiter*>(arg);
+        auto& node = pthis->m_node;
+        pthis->m_expired = true;
+        {
+            std::lock_guard lk(pthis->m_chan.m_mut);
+            pthis->m_waiters.Remove(node);
+        }
+        if (node->m_notified.exchange(true, std::memory_order_acq_rel))
+        {
+            return;
+        }
+        node->m_exec->Unref();
+        pthis->m_woken = true;
+        pthis->m_result = false;
+        pthis->Resume();
+    }
+
+    //! 数据引用
+    T& m_value;
+    //! 超时时间, 小于0时不超时
+    std::chrono::milliseconds m_timeout;
+    //! 超时事件
+    event* m_event = nullptr;
+    //! 是否已超时
+    bool m_expired = false;
+};
+
+}  // namespace coro
+
+#endif  // CORO_BOUNDED_CHANNEL_H
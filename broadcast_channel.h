@@ -0,0 +1,464 @@
+#ifndef CORO_BROADCAST_CHANNEL_H
+#define CORO_BROADCAST_CHANNEL_H
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "awaiter.h"
+#include "eventfd.h"
+#include "metrics.h"
+#include "task.h"
+#include "wait_queue.h"
+
+namespace coro
+{
+template <typename T>
+class BroadcastSpaceAwaiter;
+
+/**
+ * @brief 慢订阅者的处理策略, 环形缓冲区写满时生效
+ */
+enum class OverflowPolicy
+{
+    //! Push失败, Send等待最慢的订阅者读取
+    Block,
+    //! 丢弃新数据
+    DropNewest,
+    //! 覆盖最旧的数据, 落后的订阅者跳过被覆盖的数据并记录落后数
+    Lag,
+};
+
+/**
+ * @brief 广播channel, 每个数据投递给所有订阅者;
+ *        数据只保存一份在共享的环形缓冲区中, 订阅者按各自的序号读取, 不复制数据
+ * @tparam T 数据类型
+ */
+template <typename T>
+class BroadcastChannel
+{
+public:
+    class Subscriber;
+
+    BroadcastChannel(const BroadcastChannel&) = delete;
+    /**
+     * @brief 构造广播channel
+     * @param capacity 环形缓冲区大小
+     * @param policy 写满时的策略
+     */
+    explicit BroadcastChannel(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
+    ~BroadcastChannel();
+
+    /**
+     * @brief 订阅, 从下一个写入的数据开始读取, 订阅者需先于channel析构
+     * @return 订阅者
+     */
+    std::unique_ptr<Subscriber> Subscribe();
+
+    /**
+     * @brief 写入数据, 不等待
+     * @param t 数据
+     * @return 写入成功返回true; 关闭后, 或Block/DropNewest策略下写满时返回false
+     */
+    bool Push(auto&& t);
+
+    /**
+     * @brief 写入数据, Block策略下写满时等待最慢的订阅者读取
+     * @param t 数据
+     * @return 写入成功返回true, 关闭后返回false
+     */
+    Task<bool> Send(auto&& t);
+
+    /**
+     * @brief 关闭channel, 唤醒所有订阅者与等待写入的协程, 订阅者读完已写入的数据后结束
+     */
+    void Close();
+
+    /**
+     * @brief 判断channel是否关闭
+     * @return channel关闭返回true
+     */
+    bool IsClose();
+
+    /**
+     * @brief 获取被丢弃的数据数, DropNewest策略下生效
+     * @return
+     */
+    uint64_t GetDropped();
+
+private:
+    friend class BroadcastSpaceAwaiter<T>;
+
+    /**
+     * @brief 是否有空位, 需持有锁
+     */
+    bool HasSpaceLocked();
+
+    /**
+     * @brief 写入数据并唤醒挂起的订阅者, 需持有锁
+     * @param ptr 数据
+     */
+    void PublishLocked(std::shared_ptr<const T> ptr);
+
+    /**
+     * @brief 有空位时唤醒一个等待写入的协程, 需持有锁
+     */
+    void NotifySpaceLocked();
+
+    //! 互斥锁
+    std::mutex m_mut;
+    //! 环形缓冲区
+    std::vector<std::shared_ptr<const T>> m_ring;
+    //! 写满时的策略
+    OverflowPolicy m_policy;
+    //! 下一个写入的序号
+    uint64_t m_tail = 0;
+    //! 订阅者
+    std::vector<Subscriber*> m_subscriber;
+    //! 等待空位的写入协程
+    detail::WaitQueue m_send_waiters;
+    //! 被丢弃的数据数
+    uint64_t m_dropped = 0;
+    //! 是否关闭
+    std::atomic_bool m_is_close = false;
+};
+
+/**
+ * @brief 订阅者, 只能在一个协程中读取
+ */
+template <typename T>
+class BroadcastChannel<T>::Subscriber
+{
+public:
+    Subscriber(const Subscriber&) = delete;
+    Subscriber(BroadcastChannel* chan, uint64_t cursor);
+    ~Subscriber();
+
+    /**
+     * @brief 获取一个数据, 没有数据时挂起
+     * @param t 数据, 与其他订阅者共享
+     * @return 获取成功返回true, channel关闭且数据读完后返回false
+     */
+    Task<bool> Pop(std::shared_ptr<const T>& t);
+
+    /**
+     * @brief 尝试获取数据
+     * @param t 数据
+     * @return 获取成功返回true
+     */
+    bool TryPop(std::shared_ptr<const T>& t);
+
+    /**
+     * @brief 获取并清零因被覆盖而跳过的数据数, Lag策略下生效
+     * @return
+     */
+    uint64_t TakeLagged();
+
+private:
+    friend class BroadcastChannel;
+
+    /**
+     * @brief 读取数据, 需持有锁
+     */
+    bool TryPopLocked(std::shared_ptr<const T>& t);
+
+    //! 所属channel
+    BroadcastChannel* m_chan = nullptr;
+    //! 下一个读取的序号
+    uint64_t m_cursor = 0;
+    //! 跳过的数据数
+    uint64_t m_lagged = 0;
+    //! 通知订阅者的fd
+    int m_fd = -1;
+    //! 是否挂起等待数据, 只有挂起时写入才通知
+    bool m_parked = false;
+};
+
+template <typename T>
+BroadcastChannel<T>::BroadcastChannel(size_t capacity, OverflowPolicy policy)
+    : m_ring(std::max<size_t>(capacity, 1))
+    , m_policy(policy)
+{}
+
+template <typename T>
+BroadcastChannel<T>::~BroadcastChannel() = default;
+
+template <typename T>
+std::unique_ptr<typename BroadcastChannel<T>::Subscriber> BroadcastChannel<T>::Subscribe()
+{
+    std::lock_guard lk(m_mut);
+    auto sub = std::make_unique<Subscriber>(this, m_tail);
+    m_subscriber.emplace_back(sub.get());
+    return sub;
+}
+
+template <typename T>
+bool BroadcastChannel<T>::Push(auto&& t)
+{
+    if (m_is_close)
+    {
+        return false;
+    }
+    auto ptr = std::make_shared<const T>(std::forward<decltype(t)>(t));
+    std::lock_guard lk(m_mut);
+    if (!HasSpaceLocked())
+    {
+        m_dropped += m_policy == OverflowPolicy::DropNewest;
+        return false;
+    }
+    PublishLocked(std::move(ptr));
+    return true;
+}
+
+template <typename T>
+Task<bool> BroadcastChannel<T>::Send(auto&& t)
+{
+    auto ptr = std::make_shared<const T>(std::forward<decltype(t)>(t));
+    while (!m_is_close)
+    {
+        {
+            std::lock_guard lk(m_mut);
+            if (HasSpaceLocked())
+            {
+                PublishLocked(std::move(ptr));
+                // 一次释放多个空位时, 由写入成功的协程继续唤醒下一个
+                NotifySpaceLocked();
+                co_return true;
+            }
+            if (m_policy == OverflowPolicy::DropNewest)
+            {
+                m_dropped++;
+                co_return false;
+            }
+        }
+        co_await BroadcastSpaceAwaiter<T>(*this);
+    }
+    co_return false;
+}
+
+template <typename T>
+void BroadcastChannel<T>::Close()
+{
+    if (m_is_close)
+    {
+        return;
+    }
+    std::lock_guard lk(m_mut);
+    m_is_close = true;
+    for (auto* sub : m_subscriber)
+    {
+        eventfd_write(sub->m_fd, 1);
+    }
+    m_send_waiters.WakeAll();
+}
+
+template <typename T>
+bool BroadcastChannel<T>::IsClose()
+{
+    return m_is_close;
+}
+
+template <typename T>
+uint64_t BroadcastChannel<T>::GetDropped()
+{
+    std::lock_guard lk(m_mut);
+    return m_dropped;
+}
+
+template <typename T>
+bool BroadcastChannel<T>::HasSpaceLocked()
+{
+    if (m_policy == OverflowPolicy::Lag)
+    {
+        return true;
+    }
+    for (auto* sub : m_subscriber)
+    {
+        if (m_tail - sub->m_cursor >= m_ring.size())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void BroadcastChannel<T>::PublishLocked(std::shared_ptr<const T> ptr)
+{
+    m_ring[m_tail % m_ring.size()] = std::move(ptr);
+    m_tail++;
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_channel_push.Add();
+    }
+    for (auto* sub : m_subscriber)
+    {
+        if (sub->m_parked)
+        {
+            sub->m_parked = false;
+            eventfd_write(sub->m_fd, 1);
+        }
+    }
+}
+
+template <typename T>
+void BroadcastChannel<T>::NotifySpaceLocked()
+{
+    if (m_send_waiters.Empty() || !HasSpaceLocked())
+    {
+        return;
+    }
+    while (auto node = m_send_waiters.Pop())
+    {
+        if (detail::Wake(node))
+        {
+            return;
+        }
+    }
+}
+
+template <typename T>
+BroadcastChannel<T>::Subscriber::Subscriber(BroadcastChannel* chan, uint64_t cursor)
+    : m_chan(chan)
+    , m_cursor(cursor)
+    , m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{}
+
+template <typename T>
+BroadcastChannel<T>::Subscriber::~Subscriber()
+{
+    {
+        std::lock_guard lk(m_chan->m_mut);
+        std::erase(m_chan->m_subscriber, this);
+        // 最慢的订阅者退出后可能有空位
+        m_chan->NotifySpaceLocked();
+    }
+    close(m_fd);
+}
+
+template <typename T>
+Task<bool> BroadcastChannel<T>::Subscriber::Pop(std::shared_ptr<const T>& t)
+{
+    EventFdAwaiter awaiter(m_fd);
+    while (true)
+    {
+        {
+            std::lock_guard lk(m_chan->m_mut);
+            if (TryPopLocked(t))
+            {
+                co_return true;
+            }
+            if (m_chan->m_is_close)
+            {
+                co_return false;
+            }
+            m_parked = true;
+        }
+        co_await awaiter;
+    }
+}
+
+template <typename T>
+bool BroadcastChannel<T>::Subscriber::TryPop(std::shared_ptr<const T>& t)
+{
+    std::lock_guard lk(m_chan->m_mut);
+    return TryPopLocked(t);
+}
+
+template <typename T>
+uint64_t BroadcastChannel<T>::Subscriber::TakeLagged()
+{
+    std::lock_guard lk(m_chan->m_mut);
+    return std::exchange(m_lagged, 0);
+}
+
+template <typename T>
+bool BroadcastChannel<T>::Subscriber::TryPopLocked(std::shared_ptr<const T>& t)
+{
+    auto tail = m_chan->m_tail;
+    auto capacity = m_chan->m_ring.size();
+    if (tail - m_cursor > capacity)
+    {
+        // 未读的数据已被覆盖, 跳到最旧的数据
+        m_lagged += tail - capacity - m_cursor;
+        m_cursor = tail - capacity;
+    }
+    if (m_cursor == tail)
+    {
+        return false;
+    }
+    t = m_chan->m_ring[m_cursor % capacity];
+    m_cursor++;
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_channel_pop.Add();
+    }
+    m_chan->NotifySpaceLocked();
+    return true;
+}
+
+/**
+ * @brief BroadcastChannel::Send的等待器, 写满时挂在channel上, 有空位或关闭时被唤醒
+ * @tparam T 数据类型
+ */
+template <typename T>
+class BroadcastSpaceAwaiter : public WaitAwaiter
+{
+public:
+    explicit BroadcastSpaceAwaiter(BroadcastChannel<T>& chan)
+        : m_chan(chan)
+    {}
+
+    ~BroadcastSpaceAwaiter() override
+    {
+        if (!m_node)
+        {
+            return;
+        }
+        // 在锁内移除并标记, 取出节点的唤醒方由标记决定归属
+        std::lock_guard lk(m_chan.m_mut);
+        m_chan.m_send_waiters.Remove(m_node);
+        if (detail::Abandon(m_node) && !m_woken)
+        {
+            // 已被唤醒但未处理, 转给下一个写入者
+            m_chan.NotifySpaceLocked();
+        }
+    }
+
+    /**
+     * @brief 加锁后重新检查, 仍写满时登记等待
+     */
+    void Handle() override
+    {
+        std::unique_lock lk(m_chan.m_mut);
+        if (m_chan.m_is_close || m_chan.HasSpaceLocked())
+        {
+            lk.unlock();
+            Resume();
+            return;
+        }
+        m_node = detail::MakeWaitNode(this, GetExecutor());
+        m_chan.m_send_waiters.Push(m_node);
+    }
+
+    void OnWake() override
+    {
+        m_woken = true;
+        Resume();
+    }
+
+private:
+    //! channel
+    BroadcastChannel<T>& m_chan;
+    //! 等待者
+    std::shared_ptr<detail::WaitNode> m_node;
+    //! 唤醒是否已处理
+    bool m_woken = false;
+};
+
+}  // namespace coro
+
+#endif  // CORO_BROADCAST_CHANNEL_H
@@ -2,24 +2,34 @@
 #define CORO_CHANNEL_H
 
 #include <sys/eventfd.h>
+#include <unistd.h>
 #include <atomic>
 #include <mutex>
 #include <optional>
-#include <set>
+#include <queue>
 #include "awaiter.h"
-#include "eventfd.h"
 #include "executor.h"
+#include "metrics.h"
+#include "spill_queue.h"
 #include "task.h"
+#include "wait_queue.h"
 
 namespace coro
 {
+template <typename T>
+class ChannelPopAwaiter;
 
+/**
+ * @brief 多生产者多消费者的channel, 不占用内核对象: 等待的协程挂在channel上,
+ *        经所在执行器的投递通知唤醒, 可创建大量channel
+ * @tparam T 数据类型
+ */
 template <typename T>
 class Channel
 {
 public:
     Channel(const Channel&) = delete;
-    Channel();
+    Channel() = default;
     ~Channel();
 
     /**
@@ -30,16 +40,17 @@ public:
     /**
      * @brief 添加一个数据
      * @param t 数据
-     * @return 添加成功后返回true
+     * @return 添加成功后返回true; 关闭后返回false, 开启溢出时写入磁盘失败也返回false且数据未添加,
+     *         可由IsClose区分
      */
     bool Push(auto&& t);
 
     /**
-     * @brief 获取一个数据
+     * @brief 获取一个数据, 有数据时不挂起协程
      * @param t 数据引用
-     * @return 获取成功后返回true
+     * @return 等待器, co_await获取成功后返回true
      */
-    Task<bool> Pop(T& t);
+    ChannelPopAwaiter<T> Pop(T& t);
 
     /**
      * @brief 尝试获取数据
@@ -61,32 +72,75 @@ public:
     bool IsEmpty();
 
     /**
-     * @brief 获取event fd
+     * @brief 获取event fd, 首次调用时创建, 之后的写入与关闭会通知该fd; 在协程中等待不需要event fd
      * @return event fd
      */
     int32_t GetEventfd();
+
+    /**
+     * @brief 开启溢出到磁盘, 内存中的数据超过上限后, 之后写入的数据序列化后追加到段文件,
+     *        读取时先取内存中的数据再按顺序读回磁盘上的数据; 生产者不阻塞, 内存占用有上限
+     * @param option 参数
+     * @return 目录不可写时返回false
+     */
+    bool EnableSpill(const SpillOption& option)
+        requires Spillable<T>;
+
+    /**
+     * @brief 获取在磁盘上等待读取的数据量
+     * @return
+     */
+    size_t GetSpillCount();
+
+    /**
+     * @brief 登记等待者, 写入数据或关闭时唤醒, 供Select使用
+     * @param node 等待者
+     * @return 已有数据时不登记, 返回false; 已关闭时不登记也不唤醒
+     */
+    bool Watch(const std::shared_ptr<detail::WaitNode>& node);
+
+    /**
+     * @brief 撤销登记的等待者
+     * @param node 等待者
+     */
+    void Unwatch(const std::shared_ptr<detail::WaitNode>& node);
 private:
-    //! 通知channel的fd
+    friend class ChannelPopAwaiter<T>;
+
+    /**
+     * @brief 通知event fd, 需持有锁
+     */
+    void NotifyFd();
+
+    //! 通知channel的fd, 调用GetEventfd后创建
     int m_fd = -1;
     //! 可重入的互斥锁
     std::recursive_mutex m_mut;
     //! 数据队列
     std::queue<std::optional<T>> m_data_queue;
-    //! 数据量
+    //! 数据量, 包括磁盘上的数据
     std::atomic_size_t m_data_count = 0;
+    //! 磁盘上的数据, 开启溢出后创建
+    std::unique_ptr<SpillQueue> m_spill;
+    //! 内存中的数据上限
+    size_t m_memory_limit = 0;
+    //! 序列化的缓冲区
+    std::string m_spill_buf;
     //! 是否关闭
     std::atomic_bool m_is_close = false;
+    //! 等待数据的协程, 只在数据队列为空时存在
+    detail::WaitQueue m_pop_waiters;
+    //! Select登记的等待者
+    detail::WaitQueue m_watchers;
 };
 
-template <typename T>
-Channel<T>::Channel()
-    : m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
-{}
-
 template <typename T>
 Channel<T>::~Channel()
 {
-    close(m_fd);
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
 }
 
 template <typename T>
@@ -98,7 +152,9 @@ void Channel<T>::Close()
     }
     std::lock_guard lk(m_mut);
     m_is_close = true;
-    eventfd_write(m_fd, 1);
+    m_pop_waiters.WakeAll();
+    m_watchers.WakeAll();
+    NotifyFd();
 }
 
 template <typename T>
@@ -109,39 +165,60 @@ bool Channel<T>::Push(auto&& t)
         return false;
     }
     std::lock_guard lk(m_mut);
-    m_data_queue.emplace(std::forward<decltype(t)>(t));
-    m_data_count++;
-    eventfd_write(m_fd, 1);
-    return true;
-}
-
-template <typename T>
-Task<bool> Channel<T>::Pop(T& t)
-{
-    if (m_is_close)
+    if constexpr (kMetricsEnabled)
     {
-        co_return false;
+        Metrics::Local().m_channel_push.Add();
     }
-
-    bool s = false;
-    EventFdAwaiter awaiter(m_fd);
-    do
+    if (auto node = m_pop_waiters.Pop())
     {
+        // 有协程在等待时队列为空, 直接交给最早等待的协程
+        auto* waiter = static_cast<ChannelPopAwaiter<T>*>(node->m_awaiter);
+        waiter->m_value = std::forward<decltype(t)>(t);
+        waiter->m_result = true;
+        if constexpr (kMetricsEnabled)
         {
-            std::lock_guard lk(m_mut);
-            if (!m_data_queue.empty())
+            Metrics::Local().m_channel_pop.Add();
+        }
+        detail::Wake(node);
+        return true;
+    }
+    if constexpr (Spillable<T>)
+    {
+        // 磁盘上有数据时之后的数据也写入磁盘, 保持顺序
+        if (m_spill && (m_spill->Size() > 0 || m_data_queue.size() >= m_memory_limit))
+        {
+            m_spill_buf.clear();
+            SpillSerializer<T>::Serialize(static_cast<const T&>(t), m_spill_buf);
+            if (!m_spill->Push(m_spill_buf))
             {
-                t = std::move(m_data_queue.front().value());
-                m_data_queue.pop();
-                m_data_count--;
-                s = true;
-                break;
+                // 创建或映射段文件失败, channel未关闭
+                return false;
+            }
+            m_data_count++;
+            if constexpr (kMetricsEnabled)
+            {
+                Metrics::Local().m_channel_depth_max.Update(m_data_count);
             }
+            m_watchers.WakeAll();
+            NotifyFd();
+            return true;
         }
-        co_await awaiter;
-    } while (!m_is_close);
-    eventfd_write(m_fd, 1);
-    co_return s;
+    }
+    m_data_queue.emplace(std::forward<decltype(t)>(t));
+    m_data_count++;
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_channel_depth_max.Update(m_data_count);
+    }
+    m_watchers.WakeAll();
+    NotifyFd();
+    return true;
+}
+
+template <typename T>
+ChannelPopAwaiter<T> Channel<T>::Pop(T& t)
+{
+    return ChannelPopAwaiter<T>(*this, t);
 }
 
 template <typename T>
@@ -158,8 +235,29 @@ bool Channel<T>::TryPop(T& t)
         t = std::move(m_data_queue.front().value());
         m_data_queue.pop();
         m_data_count--;
+        if constexpr (kMetricsEnabled)
+        {
+            Metrics::Local().m_channel_pop.Add();
+        }
         return true;
     }
+    if constexpr (Spillable<T>)
+    {
+        if (m_spill)
+        {
+            if (auto record = m_spill->Front())
+            {
+                t = SpillSerializer<T>::Deserialize(*record);
+                m_spill->PopFront();
+                m_data_count--;
+                if constexpr (kMetricsEnabled)
+                {
+                    Metrics::Local().m_channel_pop.Add();
+                }
+                return true;
+            }
+        }
+    }
     return false;
 }
 
@@ -175,12 +273,158 @@ bool Channel<T>::IsEmpty()
     return m_data_count == 0;
 }
 
+template <typename T>
+bool Channel<T>::EnableSpill(const SpillOption& option)
+    requires Spillable<T>
+{
+    if (access(option.m_dir.c_str(), W_OK) != 0)
+    {
+        return false;
+    }
+    std::lock_guard lk(m_mut);
+    if (!m_spill)
+    {
+        m_spill = std::make_unique<SpillQueue>(option.m_dir, option.m_segment_size);
+    }
+    m_memory_limit = option.m_memory_limit;
+    return true;
+}
+
+template <typename T>
+size_t Channel<T>::GetSpillCount()
+{
+    std::lock_guard lk(m_mut);
+    return m_spill ? m_spill->Size() : 0;
+}
+
 template <typename T>
 int32_t Channel<T>::GetEventfd()
 {
+    std::lock_guard lk(m_mut);
+    if (m_fd < 0)
+    {
+        m_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (m_data_count > 0 || m_is_close)
+        {
+            eventfd_write(m_fd, 1);
+        }
+    }
     return m_fd;
 }
 
+template <typename T>
+bool Channel<T>::Watch(const std::shared_ptr<detail::WaitNode>& node)
+{
+    std::lock_guard lk(m_mut);
+    if (m_data_count > 0)
+    {
+        return false;
+    }
+    if (!m_is_close)
+    {
+        m_watchers.Push(node);
+    }
+    return true;
+}
+
+template <typename T>
+void Channel<T>::Unwatch(const std::shared_ptr<detail::WaitNode>& node)
+{
+    std::lock_guard lk(m_mut);
+    m_watchers.Remove(node);
+}
+
+template <typename T>
+void Channel<T>::NotifyFd()
+{
+    if (m_fd >= 0)
+    {
+        eventfd_write(m_fd, 1);
+    }
+}
+
+/**
+ * @brief Channel::Pop的等待器, 有数据或已关闭时不挂起, 否则挂在channel上等待写入者直接交付数据
+ * @tparam T 数据类型
+ */
+template <typename T>
+class ChannelPopAwaiter : public WaitAwaiter
+{
+public:
+    ChannelPopAwaiter(Channel<T>& chan, T& t)
+        : m_chan(chan)
+        , m_value(t)
+    {}
+
+    ~ChannelPopAwaiter() override
+    {
+        if (!m_node)
+        {
+            return;
+        }
+        bool handed = false;
+        {
+            // 在锁内移除并标记, 写入者在锁内交付数据并唤醒, 未移除时数据已交付
+            std::lock_guard lk(m_chan.m_mut);
+            m_chan.m_pop_waiters.Remove(m_node);
+            handed = detail::Abandon(m_node) && !m_woken && m_result;
+        }
+        if (handed)
+        {
+            // 数据已交付但协程未恢复, 放回channel
+            m_chan.Push(std::move(m_value));
+        }
+    }
+
+    bool await_ready()
+    {
+        m_result = m_chan.TryPop(m_value);
+        return m_result || m_chan.IsClose();
+    }
+
+    /**
+     * @brief 加锁后重新检查, 仍无数据时登记等待
+     */
+    void Handle() override
+    {
+        std::unique_lock lk(m_chan.m_mut);
+        m_result = m_chan.TryPop(m_value);
+        if (m_result || m_chan.IsClose())
+        {
+            lk.unlock();
+            Resume();
+            return;
+        }
+        m_node = detail::MakeWaitNode(this, GetExecutor());
+        m_chan.m_pop_waiters.Push(m_node);
+    }
+
+    bool await_resume() const
+    {
+        return m_result;
+    }
+
+    void OnWake() override
+    {
+        m_woken = true;
+        Resume();
+    }
+
+private:
+    friend class Channel<T>;
+
+    //! channel
+    Channel<T>& m_chan;
+    //! 数据引用
+    T& m_value;
+    //! 是否取到数据, 由写入者设置时在唤醒前写入
+    bool m_result = false;
+    //! 等待者
+    std::shared_ptr<detail::WaitNode> m_node;
+    //! 是否已处理唤醒
+    bool m_woken = false;
+};
+
 }  // namespace coro
 
 #endif  // CORO_CHANNEL_H
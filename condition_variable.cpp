@@ -0,0 +1,97 @@
+#include "condition_variable.h"
+#include <cassert>
+#include <stdexcept>
+
+namespace coro
+{
+namespace
+{
+/**
+ * @brief 取得锁持有的互斥锁, 未持有coro::Mutex时抛出异常
+ */
+Mutex& HeldMutex(LockGuard& lock)
+{
+    auto* mutex = lock.GetMutex();
+    if (!mutex)
+    {
+        throw std::logic_error{"ConditionVariable::Wait requires a LockGuard that holds a coro::Mutex"};
+    }
+    return *mutex;
+}
+}  // namespace
+
+ConditionAwaiter::ConditionAwaiter(ConditionVariable& cv, LockGuard& lock)
+    : LockAwaiter(HeldMutex(lock))
+    , m_cv(cv)
+    , m_lock(lock)
+{}
+
+ConditionAwaiter::~ConditionAwaiter()
+{
+    if (m_node && !m_node->m_notified.load(std::memory_order_acquire))
+    {
+        // 协程在等待通知期间被销毁; 已移到互斥锁的等待者由LockAwaiter撤销
+        std::lock_guard lk(m_cv.m_mut);
+        m_cv.m_waiters.Remove(m_node);
+    }
+}
+
+void ConditionAwaiter::Handle()
+{
+    {
+        std::lock_guard lk(m_cv.m_mut);
+        assert((!m_cv.m_mutex || m_cv.m_mutex == &m_mutex) && "条件变量需配合同一互斥锁");
+        m_cv.m_mutex = &m_mutex;
+        m_node = detail::MakeWaitNode(this, GetExecutor());
+        m_woken = false;
+        m_cv.m_waiters.Push(m_node);
+    }
+    // 先登记再解锁, 解锁后的通知不会丢失
+    m_lock.Unlock();
+}
+
+void ConditionAwaiter::await_resume()
+{
+    m_lock = LockAwaiter::await_resume();
+}
+
+ConditionAwaiter ConditionVariable::Wait(LockGuard& lock)
+{
+    return ConditionAwaiter(*this, lock);
+}
+
+void ConditionVariable::NotifyOne()
+{
+    while (true)
+    {
+        std::shared_ptr<detail::WaitNode> node;
+        Mutex* mutex = nullptr;
+        {
+            std::lock_guard lk(m_mut);
+            node = m_waiters.Pop();
+            mutex = m_mutex;
+        }
+        // 等待者已撤销时通知下一个
+        if (!node || mutex->Requeue(node))
+        {
+            return;
+        }
+    }
+}
+
+void ConditionVariable::NotifyAll()
+{
+    detail::WaitQueue waiters;
+    Mutex* mutex = nullptr;
+    {
+        std::lock_guard lk(m_mut);
+        std::swap(waiters, m_waiters);
+        mutex = m_mutex;
+    }
+    while (auto node = waiters.Pop())
+    {
+        mutex->Requeue(node);
+    }
+}
+
+}  // namespace coro
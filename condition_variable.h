@@ -0,0 +1,98 @@
+#ifndef CORO_CONDITION_VARIABLE_H
+#define CORO_CONDITION_VARIABLE_H
+
+#include <mutex>
+#include "mutex.h"
+#include "task.h"
+#include "wait_queue.h"
+
+namespace coro
+{
+/**
+ * @brief ConditionVariable::Wait的等待器, 登记后解锁; 被通知时移到互斥锁的等待队列,
+ *        恢复时已重新上锁
+ */
+class ConditionAwaiter : public LockAwaiter
+{
+public:
+    ConditionAwaiter(ConditionVariable& cv, LockGuard& lock);
+    ~ConditionAwaiter() override;
+
+    bool await_ready() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief 登记在条件变量上, 然后解锁
+     */
+    void Handle() override;
+
+    /**
+     * @brief 重新上锁后交给调用者的LockGuard
+     */
+    void await_resume();
+
+private:
+    //! 条件变量
+    ConditionVariable& m_cv;
+    //! 调用者持有的锁
+    LockGuard& m_lock;
+};
+
+/**
+ * @brief 配合coro::Mutex使用的条件变量, 同一条件变量需配合同一互斥锁;
+ *        通知不占用fd, 被通知的等待者直接移到互斥锁的等待队列(wait morphing), 解锁时逐个在各自的执行器上恢复,
+ *        NotifyAll不会同时唤醒所有等待者去竞争锁
+ */
+class ConditionVariable
+{
+public:
+    ConditionVariable() = default;
+    ConditionVariable(const ConditionVariable&) = delete;
+
+    /**
+     * @brief 解锁并等待通知, 恢复时已重新上锁; 可能虚假唤醒, 需在循环中检查条件
+     * @param lock 持有的锁, 需由coro::Mutex上锁且未解锁, 否则抛出std::logic_error
+     * @return 等待器
+     */
+    ConditionAwaiter Wait(LockGuard& lock);
+
+    /**
+     * @brief 等待直到条件满足, 恢复时持有锁
+     * @param lock 持有的锁
+     * @param pred 条件, 持有锁时调用
+     */
+    template <typename Pred>
+    Task<void> Wait(LockGuard& lock, Pred pred)
+    {
+        while (!pred())
+        {
+            co_await Wait(lock);
+        }
+    }
+
+    /**
+     * @brief 通知最早等待的一个协程, 可在任意线程调用, 持有锁与否均可
+     */
+    void NotifyOne();
+
+    /**
+     * @brief 通知所有等待的协程
+     */
+    void NotifyAll();
+
+private:
+    friend class ConditionAwaiter;
+
+    //! 保护等待队列
+    std::mutex m_mut;
+    //! 等待的协程
+    detail::WaitQueue m_waiters;
+    //! 配合的互斥锁, 首次等待时记录
+    Mutex* m_mutex = nullptr;
+};
+
+}  // namespace coro
+
+#endif  // CORO_CONDITION_VARIABLE_H
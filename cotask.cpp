@@ -7,6 +7,7 @@ bool CoTask::Run(coro::Executor* exec)
 {
     m_task = CoHandle();
     m_task->SetExecutor(exec);
+    m_task->SetPriority(m_priority);
     m_task->resume();
     return m_task->is_ready();
 }
@@ -21,6 +21,35 @@ public:
 
     //! 被挂起的协程
     std::optional<Task<void>> m_task;
+    //! 优先级
+    Priority m_priority = Priority::Normal;
+    //! 是否固定在添加时的工作线程, 线程池缩容时不迁移
+    bool m_pinned = false;
+};
+
+/**
+ * @brief 直接保存可调用对象的cotask, 任务与可调用对象一次分配, 不经过std::function
+ * @tparam F 返回Task<void>的可调用对象
+ */
+template <typename F>
+class FunctionTask : public CoTask
+{
+public:
+    explicit FunctionTask(F func)
+        : m_func(std::move(func))
+    {}
+
+    /**
+     * @brief 协程即可调用对象返回的Task, 其捕获的变量随任务存活
+     */
+    Task<void> CoHandle() override
+    {
+        return m_func();
+    }
+
+private:
+    //! 可调用对象
+    F m_func;
 };
 }
 
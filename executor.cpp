@@ -1,23 +1,58 @@
 #include "executor.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "resolver.h"
 
 namespace coro
 {
+//! 每轮事件循环最多恢复的协程数, 超出部分让出给其他事件后继续
+static constexpr size_t kReadyBudget = 64;
 
 Executor::Executor(event_base* base)
     : m_base(base)
+    , m_ready_event(event_new(base, -1, 0, OnReady, this))
+    , m_post_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    , m_post_event(event_new(base, m_post_fd, EV_READ | EV_PERSIST, OnPost, this))
 {}
 
+Executor::~Executor()
+{
+    m_task_map.clear();
+    m_resolver.reset();
+    event_free(m_ready_event);
+    event_free(m_post_event);
+    close(m_post_fd);
+}
+
 void Executor::RunTask(const std::shared_ptr<CoTask>& task)
 {
-    if (!task->Run(this))
+    bool done = false;
+    Measure([&] { done = task->Run(this); });
+    if constexpr (kMetricsEnabled)
+    {
+        auto& metrics = Metrics::Local();
+        metrics.m_task_spawned.Add();
+        m_spawned.Add();
+        if (done)
+        {
+            metrics.m_task_completed.Add();
+            m_completed.Add();
+        }
+        else
+        {
+            metrics.m_task_suspended.Add();
+        }
+    }
+    if (!done)
     {
         void* ptr = task.get();
         m_task_map[ptr] = task;
-        task->m_task->SetDestroy([this, ptr]{m_task_map.erase(ptr);});
+        m_suspended.store(m_task_map.size(), std::memory_order_relaxed);
+        task->m_task->SetDestroy([this, ptr] { OnTaskDone(ptr); });
     }
 }
 
-void Executor::RunTask(const std::function<Task<void>()>& task)
+void Executor::RunTask(const std::function<Task<void>()>& task, Priority priority)
 {
     struct T :  CoTask
     {
@@ -29,13 +64,261 @@ void Executor::RunTask(const std::function<Task<void>()>& task)
         }
         std::function<Task<void>()> m_user_task;
     };
-    RunTask(std::make_shared<T>(task));
+    auto cotask = std::make_shared<T>(task);
+    cotask->m_priority = priority;
+    RunTask(cotask);
 }
 
 size_t Executor::GetTaskCount() { return m_task_map.size(); }
 
+size_t Executor::Cancel()
+{
+    auto task_map = std::move(m_task_map);
+    m_task_map.clear();
+    m_ready_queue = PriorityQueue<ReadyItem>();
+    m_suspended.store(0, std::memory_order_relaxed);
+    return task_map.size();
+}
+
+void Executor::SetIdleCallback(std::function<void()> cb)
+{
+    m_idle_cb = std::move(cb);
+}
+
+void Executor::Schedule(std::coroutine_handle<> handle, Priority priority)
+{
+    ReadyItem item{.m_handle = handle};
+    if constexpr (kMetricsEnabled)
+    {
+        item.m_ready_ns = NowNs();
+    }
+    m_ready_queue.Push(item, priority);
+    m_schedule_count++;
+    if (!m_ready_pending)
+    {
+        m_ready_pending = true;
+        event_active(m_ready_event, 0, 0);
+    }
+}
+
+bool Executor::Post(std::function<void()> func)
+{
+    bool notify = false;
+    {
+        std::lock_guard lk(m_post_mut);
+        if (!m_post_listen)
+        {
+            return false;
+        }
+        // 队列非空时已通知过, 尚未被取走
+        notify = m_post_queue.empty();
+        m_post_queue.emplace_back(std::move(func));
+    }
+    if (notify)
+    {
+        eventfd_write(m_post_fd, 1);
+    }
+    return true;
+}
+
+Executor* Executor::Current()
+{
+    return s_current;
+}
+
+void Executor::Ref()
+{
+    // 常驻的投递事件会使event_base_dispatch无法退出, 只在有引用时注册
+    if (m_ref++ == 0)
+    {
+        if (std::exchange(m_post_idle, false))
+        {
+            return;
+        }
+        std::lock_guard lk(m_post_mut);
+        m_post_listen = true;
+        event_add(m_post_event, nullptr);
+    }
+}
+
+void Executor::Unref()
+{
+    if (--m_ref > 0)
+    {
+        return;
+    }
+    if (s_current == this)
+    {
+        // 协程可能随即再次等待, 执行结束后仍为0再注销
+        m_post_idle = true;
+        return;
+    }
+    StopListen();
+}
+
+std::shared_ptr<void> Executor::KeepAlive()
+{
+    Ref();
+    // 引用未释放前投递必定送达, 由执行器线程减少引用
+    return std::shared_ptr<void>(this, [](void* ptr) {
+        auto* exec = static_cast<Executor*>(ptr);
+        exec->Post([exec] { exec->Unref(); });
+    });
+}
+
+void Executor::ReleasePost()
+{
+    if (std::exchange(m_post_idle, false) && m_ref == 0)
+    {
+        StopListen();
+    }
+}
+
+void Executor::StopListen()
+{
+    std::lock_guard lk(m_post_mut);
+    if (!m_post_queue.empty())
+    {
+        // 已接收的投递先执行, 执行结束后再注销
+        m_post_idle = true;
+        return;
+    }
+    m_post_listen = false;
+    event_del(m_post_event);
+}
+
+void Executor::AddTimer(event* ev, const timeval& tv)
+{
+    evtimer_add(ev, &tv);
+}
+
+void Executor::CancelTimer(event* ev)
+{
+    evtimer_del(ev);
+}
+
+size_t Executor::GetReadyCount() const
+{
+    return m_ready_queue.Size();
+}
+
+ExecutorMetrics Executor::GetMetrics() const
+{
+    return ExecutorMetrics{.m_spawned = m_spawned.Get(), .m_completed = m_completed.Get(), .m_suspended = m_suspended.load(std::memory_order_relaxed)};
+}
+
+void Executor::DumpStack(std::ostream& os)
+{
+#ifdef CORO_TRACE
+    size_t idx = 0;
+    for (auto& [ptr, task] : m_task_map)
+    {
+        os << "coroutine #" << idx++ << "\n";
+        std::vector<const PromiseBase*> chain;
+        for (const PromiseBase* promise = &task->m_task->promise(); promise; promise = promise->GetCallee())
+        {
+            chain.emplace_back(promise);
+        }
+        for (size_t i = 0; i < chain.size(); i++)
+        {
+            auto& location = chain[chain.size() - i - 1]->GetLocation();
+            os << "  #" << i << " " << location.function_name() << " at " << location.file_name() << ":" << location.line() << "\n";
+        }
+    }
+#else
+    os << "tracing disabled, " << m_task_map.size() << " coroutines suspended\n";
+#endif
+}
+
+void Executor::OnReady(evutil_socket_t, short, void* arg)
+{
+    // 处理期间新就绪的协程不再激活事件, 统一在本轮结束后处理
+    auto* pthis = static_cast<Executor*>(arg);
+    pthis->m_ready_pending = true;
+    uint64_t start = 0;
+    if constexpr (kMetricsEnabled)
+    {
+        start = NowNs();
+    }
+    for (size_t i = 0; i < kReadyBudget; i++)
+    {
+        auto item = pthis->m_ready_queue.Pop();
+        if (!item)
+        {
+            break;
+        }
+        if constexpr (kMetricsEnabled)
+        {
+            Metrics::Local().m_callback_latency.Record(NowNs() - item->m_ready_ns);
+        }
+        pthis->Measure([&] { item->m_handle.resume(); });
+    }
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_loop_time.Record(NowNs() - start);
+    }
+
+    pthis->m_ready_pending = false;
+    if (pthis->m_ready_queue.Empty() && pthis->m_post_idle)
+    {
+        pthis->ReleasePost();
+    }
+    if (!pthis->m_ready_queue.Empty())
+    {
+        // 下一轮事件循环继续, 先让出给io事件
+        pthis->m_ready_pending = true;
+        timeval tv{.tv_sec = 0, .tv_usec = 0};
+        evtimer_add(pthis->m_ready_event, &tv);
+    }
+}
+
+void Executor::OnPost(evutil_socket_t fd, short, void* arg)
+{
+    auto* pthis = static_cast<Executor*>(arg);
+    eventfd_t val = 0;
+    eventfd_read(fd, &val);
+    std::vector<std::function<void()>> queue;
+    {
+        std::lock_guard lk(pthis->m_post_mut);
+        queue.swap(pthis->m_post_queue);
+    }
+    for (auto& func : queue)
+    {
+        pthis->Measure(func);
+    }
+}
+
+uint64_t Executor::GetBusyTime() const
+{
+    return m_busy_ns.load(std::memory_order_relaxed);
+}
+
+void Executor::OnTaskDone(void* ptr)
+{
+    m_task_map.erase(ptr);
+    m_suspended.store(m_task_map.size(), std::memory_order_relaxed);
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_task_completed.Add();
+        m_completed.Add();
+    }
+    if (m_task_map.empty() && m_idle_cb)
+    {
+        m_idle_cb();
+    }
+}
+
 event_base* Executor::EventBase()
 {
     return m_base;
 }
+
+Resolver& Executor::GetResolver()
+{
+    if (!m_resolver)
+    {
+        m_resolver = std::make_unique<Resolver>(m_base);
+    }
+    return *m_resolver;
+}
 }
\ No newline at end of file
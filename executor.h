@@ -1,16 +1,44 @@
 #ifndef CORO_EXECUTOR_H
 #define CORO_EXECUTOR_H
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
 #include "cotask.h"
 #include "event2/event.h"
+#include "metrics.h"
+#include "priority.h"
 
 namespace coro
 {
+class Resolver;
+
+/**
+ * @brief 执行器的指标
+ */
+struct ExecutorMetrics
+{
+    //! 启动的协程数
+    uint64_t m_spawned = 0;
+    //! 结束的协程数
+    uint64_t m_completed = 0;
+    //! 当前挂起的协程数
+    uint64_t m_suspended = 0;
+};
 
 class Executor
 {
 public:
+    /**
+     * @brief 构造执行器, 执行器需先于event_base析构
+     * @param base 事件循环
+     */
     explicit Executor(event_base* base);
+    virtual ~Executor();
 
     /**
      * @brief 执行cotask
@@ -21,8 +49,9 @@ public:
     /**
      * @brief 执行协程，参数应按值复制
      * @param task
+     * @param priority 优先级
      */
-    void RunTask(const std::function<Task<void>()>& task);
+    void RunTask(const std::function<Task<void>()>& task, Priority priority = Priority::Normal);
 
     /**
      * @brief 获取未释放的协程句柄数
@@ -30,17 +59,215 @@ public:
      */
     size_t GetTaskCount();
 
+    /**
+     * @brief 销毁所有挂起的协程, 协程栈上的awaiter随之析构
+     * @return 被销毁的协程数
+     */
+    size_t Cancel();
+
+    /**
+     * @brief 设置空闲回调, 挂起的协程全部结束时调用
+     * @param cb 回调函数
+     */
+    void SetIdleCallback(std::function<void()> cb);
+
+    /**
+     * @brief 将协程放入就绪队列, 在事件循环中按优先级恢复, 只能在执行器所在线程调用
+     * @param handle 协程句柄
+     * @param priority 优先级
+     */
+    void Schedule(std::coroutine_handle<> handle, Priority priority);
+
+    /**
+     * @brief 投递函数到执行器所在线程执行, 可在任意线程调用;
+     *        只有引用计数大于0时事件循环才监听投递, 未监听时不接收, 调用者需持有引用(Ref/KeepAlive)保证送达
+     * @param func 函数
+     * @return 执行器未监听投递时返回false, 函数不会执行
+     */
+    bool Post(std::function<void()> func);
+
+    /**
+     * @brief 获取当前线程正在执行协程或投递函数的执行器
+     * @return 不在执行器中时为空
+     */
+    static Executor* Current();
+
+    /**
+     * @brief 增加引用, 等待其他线程投递期间保持事件循环运行, 只能在执行器所在线程调用
+     */
+    void Ref();
+
+    /**
+     * @brief 减少引用, 只能在执行器所在线程调用
+     */
+    void Unref();
+
+    /**
+     * @brief 增加引用并返回持有引用的句柄, 只能在执行器所在线程(或事件循环启动前)调用;
+     *        句柄可在任意线程释放, 释放时投递减少引用, 持有期间其他线程的投递保证送达
+     * @return 引用句柄
+     */
+    std::shared_ptr<void> KeepAlive();
+
+    /**
+     * @brief 注册定时事件, 到期后由事件循环调用其回调
+     * @param ev 定时事件, 需使用本执行器的event_base创建
+     * @param tv 超时时间
+     */
+    virtual void AddTimer(event* ev, const timeval& tv);
+
+    /**
+     * @brief 取消定时事件, 事件释放前需调用
+     * @param ev 定时事件
+     */
+    virtual void CancelTimer(event* ev);
+
+    /**
+     * @brief 获取就绪队列中的协程数
+     * @return
+     */
+    size_t GetReadyCount() const;
+
+    /**
+     * @brief 获取执行器的指标, 可在其他线程读取, 编译时未定义CORO_METRICS则为空
+     * @return
+     */
+    ExecutorMetrics GetMetrics() const;
+
+    /**
+     * @brief 输出所有挂起协程的异步调用栈, 由内向外为挂起位置与各级调用方,
+     *        编译时定义CORO_TRACE后生效, 需在执行器所在线程调用
+     * @param os 输出流
+     */
+    void DumpStack(std::ostream& os);
+
+    /**
+     * @brief 获取执行协程的累计耗时, 可在其他线程读取
+     * @return 纳秒
+     */
+    uint64_t GetBusyTime() const;
+
     /**
      * @brief 获取事件基
      * @return
      */
     event_base* EventBase();
+
+    /**
+     * @brief 获取本执行器的域名解析器, 首次调用时创建, 只能在执行器所在线程调用
+     * @return
+     */
+    Resolver& GetResolver();
+protected:
+    //! 放入就绪队列的累计次数
+    uint64_t m_schedule_count = 0;
 private:
+    /**
+     * @brief 就绪的协程
+     */
+    struct ReadyItem
+    {
+        //! 协程句柄
+        std::coroutine_handle<> m_handle;
+        //! 就绪时间, 纳秒
+        uint64_t m_ready_ns = 0;
+    };
+
+    /**
+     * @brief 按优先级恢复就绪的协程
+     * @param arg this指针
+     */
+    static void OnReady(evutil_socket_t, short, void* arg);
+
+    /**
+     * @brief 执行其他线程投递的函数
+     * @param arg this指针
+     */
+    static void OnPost(evutil_socket_t, short, void* arg);
+
+    /**
+     * @brief 引用计数仍为0时注销投递事件
+     */
+    void ReleasePost();
+
+    /**
+     * @brief 注销投递事件, 投递队列非空时先执行再注销
+     */
+    void StopListen();
+
+    /**
+     * @brief 挂起的协程结束
+     * @param ptr 任务指针
+     */
+    void OnTaskDone(void* ptr);
+
+    /**
+     * @brief 执行并统计耗时, 嵌套调用只统计最外层
+     * @param func 执行函数
+     */
+    template <typename F>
+    void Measure(F&& func)
+    {
+        auto* prev = std::exchange(s_current, this);
+        if (m_depth++ > 0)
+        {
+            func();
+            m_depth--;
+            s_current = prev;
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        m_busy_ns.fetch_add(cost.count(), std::memory_order_relaxed);
+        m_depth--;
+        s_current = prev;
+        if (m_post_idle && !m_ready_pending)
+        {
+            ReleasePost();
+        }
+    }
 
+    //! 当前线程正在执行的执行器
+    static inline thread_local Executor* s_current = nullptr;
     //! 事件循环
     event_base* m_base = nullptr;
     //! 挂起的任务列表
     std::unordered_map<void*, std::shared_ptr<CoTask>> m_task_map;
+    //! 空闲回调
+    std::function<void()> m_idle_cb;
+    //! 就绪队列
+    PriorityQueue<ReadyItem> m_ready_queue;
+    //! 处理就绪队列的事件
+    event* m_ready_event = nullptr;
+    //! 就绪事件是否已激活
+    bool m_ready_pending = false;
+    //! 投递通知的fd
+    int m_post_fd = -1;
+    //! 投递通知事件
+    event* m_post_event = nullptr;
+    //! 投递队列的锁
+    std::mutex m_post_mut;
+    //! 其他线程投递的函数
+    std::vector<std::function<void()>> m_post_queue;
+    //! 投递事件是否已注册, 由m_post_mut保护
+    bool m_post_listen = false;
+    //! 引用计数
+    size_t m_ref = 0;
+    //! 引用计数已归0但投递事件尚未注销, 执行协程期间延迟注销, 避免反复等待时频繁修改epoll
+    bool m_post_idle = false;
+    //! 域名解析器
+    std::unique_ptr<Resolver> m_resolver;
+    //! 嵌套深度
+    uint32_t m_depth = 0;
+    //! 累计耗时
+    std::atomic_uint64_t m_busy_ns = 0;
+    //! 启动的协程数
+    Counter m_spawned;
+    //! 结束的协程数
+    Counter m_completed;
+    //! 当前挂起的协程数
+    std::atomic_uint64_t m_suspended = 0;
 };
 
 }  // namespace coro
@@ -0,0 +1,244 @@
+#include "file.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+
+namespace coro
+{
+File::File(std::shared_ptr<FileEngine> engine)
+    : m_engine(std::move(engine))
+{}
+
+File::~File()
+{
+    Close();
+}
+
+bool File::Open(const char* path, int flags, mode_t mode)
+{
+    Close();
+    m_fd = open(path, flags | O_CLOEXEC, mode);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+    struct stat st
+    {};
+    if (fstat(m_fd, &st) != 0)
+    {
+        Close();
+        return false;
+    }
+    std::lock_guard lk(m_mut);
+    m_append_offset = st.st_size;
+    return true;
+}
+
+void File::Close()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+Task<ssize_t> File::ReadAt(void* buf, size_t len, off_t offset)
+{
+    co_return co_await m_engine->Read(m_fd, buf, len, offset);
+}
+
+Task<ssize_t> File::WriteAt(std::string_view data, off_t offset)
+{
+    std::vector<iovec> iov(1, iovec{.iov_base = const_cast<char*>(data.data()), .iov_len = data.size()});
+    co_return co_await WriteAll(std::move(iov), offset);
+}
+
+Task<ssize_t> File::Append(std::string_view data)
+{
+    auto [sender, future] = MakeOneshot<ssize_t>();
+    bool leader = false;
+    {
+        std::lock_guard lk(m_mut);
+        m_pending.emplace_back(PendingAppend{.m_data = data, .m_offset = m_append_offset, .m_sender = std::move(sender)});
+        m_append_offset += static_cast<off_t>(data.size());
+        leader = !std::exchange(m_flushing, true);
+    }
+    if (leader)
+    {
+        Executor::Current()->RunTask([this] { return FlushAppend(); });
+    }
+    co_return co_await WaitAppend(std::move(future));
+}
+
+Task<ssize_t> File::Append(const std::vector<std::string_view>& data)
+{
+    if (data.empty())
+    {
+        co_return GetSize();
+    }
+    auto [sender, future] = MakeOneshot<ssize_t>();
+    bool leader = false;
+    off_t offset = 0;
+    {
+        std::lock_guard lk(m_mut);
+        offset = m_append_offset;
+        for (auto& item : data)
+        {
+            m_pending.emplace_back(PendingAppend{.m_data = item, .m_offset = m_append_offset});
+            m_append_offset += static_cast<off_t>(item.size());
+        }
+        m_pending.back().m_sender = std::move(sender);
+        leader = !std::exchange(m_flushing, true);
+    }
+    if (leader)
+    {
+        Executor::Current()->RunTask([this] { return FlushAppend(); });
+    }
+    auto ret = co_await WaitAppend(std::move(future));
+    co_return ret < 0 ? ret : offset;
+}
+
+Task<ssize_t> File::Fsync()
+{
+    co_return co_await m_engine->Fsync(m_fd);
+}
+
+int File::GetFd() const
+{
+    return m_fd;
+}
+
+off_t File::GetSize()
+{
+    std::lock_guard lk(m_mut);
+    return m_append_offset;
+}
+
+uint64_t File::GetAppendWrites()
+{
+    std::lock_guard lk(m_mut);
+    return m_append_writes;
+}
+
+Task<ssize_t> File::WriteAll(std::vector<iovec> iov, off_t offset)
+{
+    ssize_t total = 0;
+    size_t idx = 0;
+    while (idx < iov.size())
+    {
+        auto cnt = std::min<size_t>(iov.size() - idx, IOV_MAX);
+        auto ret = co_await m_engine->Write(m_fd, std::vector<iovec>(iov.begin() + idx, iov.begin() + idx + cnt), offset + total);
+        if (ret < 0)
+        {
+            co_return ret;
+        }
+        total += ret;
+        // 跳过已写入的部分
+        for (auto n = static_cast<size_t>(ret); idx < iov.size() && n > 0;)
+        {
+            if (n >= iov[idx].iov_len)
+            {
+                n -= iov[idx].iov_len;
+                idx++;
+            }
+            else
+            {
+                iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + n;
+                iov[idx].iov_len -= n;
+                n = 0;
+            }
+        }
+        while (idx < iov.size() && iov[idx].iov_len == 0)
+        {
+            idx++;
+        }
+        if (ret == 0 && idx < iov.size())
+        {
+            co_return -EIO;
+        }
+    }
+    co_return total;
+}
+
+Task<void> File::FlushAppend()
+{
+    std::vector<PendingAppend> batch;
+    // 任务在队列写完前被销毁(如执行器取消)时, 取消写入中与等待中的追加,
+    // 追加位置退回到第一个取消的追加, 之后的追加重新启动写入
+    struct FlushGuard
+    {
+        ~FlushGuard()
+        {
+            if (!m_file)
+            {
+                return;
+            }
+            // 发送端在解锁后析构, 等待者得到-ECANCELED
+            std::vector<PendingAppend> pending;
+            std::lock_guard lk(m_file->m_mut);
+            pending.swap(m_file->m_pending);
+            if (!m_batch.empty())
+            {
+                m_file->m_append_offset = m_batch.front().m_offset;
+            }
+            else if (!pending.empty())
+            {
+                m_file->m_append_offset = pending.front().m_offset;
+            }
+            m_file->m_flushing = false;
+        }
+
+        //! 文件, 正常结束时为空
+        File* m_file;
+        //! 写入中的追加
+        std::vector<PendingAppend>& m_batch;
+    } guard{this, batch};
+    while (true)
+    {
+        batch.clear();
+        {
+            std::lock_guard lk(m_mut);
+            if (m_pending.empty())
+            {
+                m_flushing = false;
+                guard.m_file = nullptr;
+                co_return;
+            }
+            batch.swap(m_pending);
+            m_append_writes++;
+        }
+        // 队列中的追加位置连续, 合并为一次写入
+        std::vector<iovec> iov;
+        iov.reserve(batch.size());
+        for (auto& item : batch)
+        {
+            iov.emplace_back(iovec{.iov_base = const_cast<char*>(item.m_data.data()), .iov_len = item.m_data.size()});
+        }
+        auto ret = co_await WriteAll(std::move(iov), batch.front().m_offset);
+        for (auto& item : batch)
+        {
+            if (item.m_sender)
+            {
+                item.m_sender->Set(ret < 0 ? ret : static_cast<ssize_t>(item.m_offset));
+            }
+        }
+    }
+}
+
+Task<ssize_t> File::WaitAppend(Future<ssize_t> future)
+{
+    try
+    {
+        co_return co_await future;
+    }
+    catch (const std::future_error&)
+    {
+        // 写入任务被销毁, 发送端未设置结果
+        co_return -ECANCELED;
+    }
+}
+
+}  // namespace coro
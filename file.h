@@ -0,0 +1,151 @@
+#ifndef CORO_FILE_H
+#define CORO_FILE_H
+
+#include <fcntl.h>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "file_engine.h"
+#include "task.h"
+
+namespace coro
+{
+/**
+ * @brief 异步文件, 读写由io引擎执行, 不阻塞事件循环;
+ *        并发的Append合并为一次多段写入
+ */
+class File
+{
+public:
+    File(const File&) = delete;
+    /**
+     * @brief 构造文件
+     * @param engine io引擎
+     */
+    explicit File(std::shared_ptr<FileEngine> engine = FileEngine::Default());
+    ~File();
+
+    /**
+     * @brief 打开文件
+     * @param path 路径
+     * @param flags 打开标记
+     * @param mode 创建时的权限
+     * @return 成功返回true
+     */
+    bool Open(const char* path, int flags, mode_t mode = 0644);
+
+    /**
+     * @brief 关闭文件, 需在所有操作结束后调用
+     */
+    void Close();
+
+    /**
+     * @brief 从指定位置读取
+     * @param buf 缓冲区
+     * @param len 长度
+     * @param offset 位置
+     * @return 读取的字节数, 失败时为-errno
+     */
+    Task<ssize_t> ReadAt(void* buf, size_t len, off_t offset);
+
+    /**
+     * @brief 在指定位置写入全部数据
+     * @param data 数据
+     * @param offset 位置
+     * @return 写入的字节数, 失败时为-errno
+     */
+    Task<ssize_t> WriteAt(std::string_view data, off_t offset);
+
+    /**
+     * @brief 追加到文件末尾, 等待期间其他协程的追加与本次合并写入
+     * @param data 数据, 需保持有效直到返回
+     * @return 数据所在的位置, 失败时为-errno, 写入任务被取消时为-ECANCELED
+     */
+    Task<ssize_t> Append(std::string_view data);
+
+    /**
+     * @brief 将多段数据连续追加到文件末尾, 与其他追加合并写入
+     * @param data 数据, 需保持有效直到返回
+     * @return 第一段数据所在的位置, 失败时为-errno, 写入任务被取消时为-ECANCELED
+     */
+    Task<ssize_t> Append(const std::vector<std::string_view>& data);
+
+    /**
+     * @brief 将文件数据落盘
+     * @return 成功返回0, 失败时为-errno
+     */
+    Task<ssize_t> Fsync();
+
+    /**
+     * @brief 获取文件描述符
+     * @return
+     */
+    int GetFd() const;
+
+    /**
+     * @brief 获取追加位置, 包括尚未写完的追加
+     * @return
+     */
+    off_t GetSize();
+
+    /**
+     * @brief 获取追加实际执行的写入次数
+     * @return
+     */
+    uint64_t GetAppendWrites();
+
+private:
+    /**
+     * @brief 等待写入的追加
+     */
+    struct PendingAppend
+    {
+        //! 数据
+        std::string_view m_data;
+        //! 位置
+        off_t m_offset = 0;
+        //! 结果发送端, 多段追加只在最后一段通知
+        std::optional<Oneshot<ssize_t>> m_sender;
+    };
+
+    /**
+     * @brief 写入多段数据, 处理部分写入
+     * @param iov 数据
+     * @param offset 位置
+     * @return 写入的字节数, 失败时为-errno
+     */
+    Task<ssize_t> WriteAll(std::vector<iovec> iov, off_t offset);
+
+    /**
+     * @brief 写入所有等待的追加, 直到队列为空; 由第一个追加在所在执行器上作为独立的任务启动,
+     *        发起的追加只等待自己的结果
+     */
+    Task<void> FlushAppend();
+
+    /**
+     * @brief 等待追加的结果
+     * @param future 结果
+     * @return 数据所在的位置, 失败时为-errno
+     */
+    static Task<ssize_t> WaitAppend(Future<ssize_t> future);
+
+    //! io引擎
+    std::shared_ptr<FileEngine> m_engine;
+    //! 文件描述符
+    int m_fd = -1;
+    //! 追加队列的锁
+    std::mutex m_mut;
+    //! 下一次追加的位置
+    off_t m_append_offset = 0;
+    //! 等待写入的追加
+    std::vector<PendingAppend> m_pending;
+    //! 是否有协程在写入追加
+    bool m_flushing = false;
+    //! 追加执行的写入次数
+    uint64_t m_append_writes = 0;
+};
+
+}  // namespace coro
+
+#endif  // CORO_FILE_H
@@ -0,0 +1,301 @@
+#include "file_engine.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace coro
+{
+namespace
+{
+//! 收割线程退出的标记
+constexpr uint64_t kStopUserData = 0;
+
+int IoUringSetup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+ssize_t Result(ssize_t ret)
+{
+    return ret < 0 ? -errno : ret;
+}
+}  // namespace
+
+std::shared_ptr<FileEngine> FileEngine::Default()
+{
+    static std::shared_ptr<FileEngine> engine = []() -> std::shared_ptr<FileEngine> {
+        if (auto uring = UringFileEngine::Create())
+        {
+            return uring;
+        }
+        return std::make_shared<ThreadFileEngine>();
+    }();
+    return engine;
+}
+
+ThreadFileEngine::ThreadFileEngine(size_t threads)
+    : m_pool({.m_max_threads = threads})
+{}
+
+Future<ssize_t> ThreadFileEngine::Read(int fd, void* buf, size_t len, off_t offset)
+{
+    return m_pool.Run([=] { return Result(pread(fd, buf, len, offset)); });
+}
+
+Future<ssize_t> ThreadFileEngine::Write(int fd, std::vector<iovec> iov, off_t offset)
+{
+    return m_pool.Run([=] { return Result(pwritev(fd, iov.data(), static_cast<int>(iov.size()), offset)); });
+}
+
+Future<ssize_t> ThreadFileEngine::Fsync(int fd)
+{
+    return m_pool.Run([=] { return Result(fsync(fd)); });
+}
+
+const char* ThreadFileEngine::Name() const
+{
+    return "thread";
+}
+
+/**
+ * @brief 在途请求
+ */
+struct UringFileEngine::Op
+{
+    //! 结果发送端
+    Oneshot<ssize_t> m_sender;
+    //! 读写的数据
+    std::vector<iovec> m_iov;
+};
+
+std::shared_ptr<UringFileEngine> UringFileEngine::Create(unsigned entries)
+{
+    std::shared_ptr<UringFileEngine> engine(new UringFileEngine());
+    if (!engine->Init(entries))
+    {
+        return nullptr;
+    }
+    return engine;
+}
+
+UringFileEngine::~UringFileEngine()
+{
+    if (m_reaper.joinable())
+    {
+        Submit(IORING_OP_NOP, -1, nullptr, 0);
+        m_reaper.join();
+    }
+    if (m_sqes)
+    {
+        munmap(m_sqes, m_sqes_size);
+    }
+    if (m_cq_ptr && m_cq_ptr != m_sq_ptr)
+    {
+        munmap(m_cq_ptr, m_cq_size);
+    }
+    if (m_sq_ptr)
+    {
+        munmap(m_sq_ptr, m_sq_size);
+    }
+    if (m_ring_fd >= 0)
+    {
+        close(m_ring_fd);
+    }
+}
+
+bool UringFileEngine::Init(unsigned entries)
+{
+    io_uring_params params{};
+    m_ring_fd = IoUringSetup(entries, &params);
+    if (m_ring_fd < 0)
+    {
+        return false;
+    }
+    m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+    {
+        m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+    }
+    m_sq_ptr = mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ptr == MAP_FAILED)
+    {
+        m_sq_ptr = nullptr;
+        return false;
+    }
+    m_cq_ptr = single ? m_sq_ptr : mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+    if (m_cq_ptr == MAP_FAILED)
+    {
+        m_cq_ptr = nullptr;
+        return false;
+    }
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED)
+    {
+        m_sqes = nullptr;
+        return false;
+    }
+    auto* sq = static_cast<char*>(m_sq_ptr);
+    m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<char*>(m_cq_ptr);
+    m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    m_cqes = cq + params.cq_off.cqes;
+    // 每次提交后立即进入内核, 提交队列不会积压, 在途请求受完成队列长度限制
+    m_capacity = std::min(params.sq_entries, params.cq_entries);
+    m_reaper = std::thread([this] { Reap(); });
+    return true;
+}
+
+Future<ssize_t> UringFileEngine::Read(int fd, void* buf, size_t len, off_t offset)
+{
+    auto [sender, future] = MakeOneshot<ssize_t>();
+    auto* op = new Op{.m_sender = std::move(sender), .m_iov = {iovec{.iov_base = buf, .iov_len = len}}};
+    Submit(IORING_OP_READV, fd, op, offset);
+    return std::move(future);
+}
+
+Future<ssize_t> UringFileEngine::Write(int fd, std::vector<iovec> iov, off_t offset)
+{
+    auto [sender, future] = MakeOneshot<ssize_t>();
+    auto* op = new Op{.m_sender = std::move(sender), .m_iov = std::move(iov)};
+    Submit(IORING_OP_WRITEV, fd, op, offset);
+    return std::move(future);
+}
+
+Future<ssize_t> UringFileEngine::Fsync(int fd)
+{
+    auto [sender, future] = MakeOneshot<ssize_t>();
+    auto* op = new Op{.m_sender = std::move(sender)};
+    Submit(IORING_OP_FSYNC, fd, op, 0);
+    return std::move(future);
+}
+
+const char* UringFileEngine::Name() const
+{
+    return "io_uring";
+}
+
+void UringFileEngine::Submit(uint8_t opcode, int fd, Op* op, off_t offset)
+{
+    std::unique_lock lk(m_mut);
+    m_cv.wait(lk, [this] { return m_inflight < m_capacity || m_error != 0; });
+    if (m_error != 0)
+    {
+        // 收割线程已退出
+        if (op)
+        {
+            op->m_sender.Set(-m_error);
+            delete op;
+        }
+        return;
+    }
+    m_inflight++;
+    if (op)
+    {
+        m_pending.emplace(op);
+    }
+    auto tail = *m_sq_tail;
+    auto idx = tail & *m_sq_mask;
+    auto* sqe = static_cast<io_uring_sqe*>(m_sqes) + idx;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = offset;
+    if (op && !op->m_iov.empty())
+    {
+        sqe->addr = reinterpret_cast<uint64_t>(op->m_iov.data());
+        sqe->len = static_cast<uint32_t>(op->m_iov.size());
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(op);
+    m_sq_array[idx] = idx;
+    std::atomic_ref(*m_sq_tail).store(tail + 1, std::memory_order_release);
+    while (IoUringEnter(m_ring_fd, 1, 0, 0) < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+    {
+    }
+}
+
+void UringFileEngine::Reap()
+{
+    bool stop = false;
+    std::vector<std::pair<Op*, ssize_t>> done;
+    while (!stop)
+    {
+        if (IoUringEnter(m_ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0)
+        {
+            // 中断或资源暂时不足(完成队列溢出时为EBUSY)时先收割已完成的再重试
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                FailPending(errno);
+                return;
+            }
+        }
+        auto head = *m_cq_head;
+        auto tail = std::atomic_ref(*m_cq_tail).load(std::memory_order_acquire);
+        unsigned count = 0;
+        for (; head != tail; head++, count++)
+        {
+            auto& cqe = static_cast<io_uring_cqe*>(m_cqes)[head & *m_cq_mask];
+            if (cqe.user_data == kStopUserData)
+            {
+                stop = true;
+                continue;
+            }
+            done.emplace_back(reinterpret_cast<Op*>(cqe.user_data), static_cast<ssize_t>(cqe.res));
+        }
+        std::atomic_ref(*m_cq_head).store(head, std::memory_order_release);
+        if (count == 0)
+        {
+            continue;
+        }
+        {
+            std::lock_guard lk(m_mut);
+            m_inflight -= count;
+            for (auto& [op, res] : done)
+            {
+                m_pending.erase(op);
+            }
+        }
+        m_cv.notify_all();
+        for (auto& [op, res] : done)
+        {
+            std::unique_ptr<Op> guard(op);
+            op->m_sender.Set(res);
+        }
+        done.clear();
+    }
+}
+
+void UringFileEngine::FailPending(int err)
+{
+    std::unordered_set<Op*> pending;
+    {
+        std::lock_guard lk(m_mut);
+        m_error = err;
+        m_inflight = 0;
+        pending.swap(m_pending);
+    }
+    m_cv.notify_all();
+    for (auto* op : pending)
+    {
+        std::unique_ptr<Op> guard(op);
+        op->m_sender.Set(-err);
+    }
+}
+
+}  // namespace coro
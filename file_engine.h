@@ -0,0 +1,177 @@
+#ifndef CORO_FILE_ENGINE_H
+#define CORO_FILE_ENGINE_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "blocking_pool.h"
+#include "future.h"
+
+namespace coro
+{
+/**
+ * @brief 文件io引擎, 结果为读写的字节数, 失败时为-errno
+ */
+class FileEngine
+{
+public:
+    virtual ~FileEngine() = default;
+
+    /**
+     * @brief 从指定位置读取
+     * @param fd 文件描述符
+     * @param buf 缓冲区, 需保持有效直到结果返回
+     * @param len 长度
+     * @param offset 位置
+     * @return 读取的字节数
+     */
+    virtual Future<ssize_t> Read(int fd, void* buf, size_t len, off_t offset) = 0;
+
+    /**
+     * @brief 从指定位置写入多段数据
+     * @param fd 文件描述符
+     * @param iov 数据, 指向的内存需保持有效直到结果返回
+     * @param offset 位置
+     * @return 写入的字节数
+     */
+    virtual Future<ssize_t> Write(int fd, std::vector<iovec> iov, off_t offset) = 0;
+
+    /**
+     * @brief 将文件数据落盘
+     * @param fd 文件描述符
+     * @return 成功为0
+     */
+    virtual Future<ssize_t> Fsync(int fd) = 0;
+
+    /**
+     * @brief 获取引擎名称
+     * @return
+     */
+    virtual const char* Name() const = 0;
+
+    /**
+     * @brief 获取默认引擎, 内核支持时使用io_uring, 否则使用线程
+     * @return
+     */
+    static std::shared_ptr<FileEngine> Default();
+};
+
+/**
+ * @brief 在阻塞线程池中执行pread/pwritev/fsync
+ */
+class ThreadFileEngine : public FileEngine
+{
+public:
+    /**
+     * @brief 构造引擎
+     * @param threads 最多线程数
+     */
+    explicit ThreadFileEngine(size_t threads = 4);
+
+    Future<ssize_t> Read(int fd, void* buf, size_t len, off_t offset) override;
+    Future<ssize_t> Write(int fd, std::vector<iovec> iov, off_t offset) override;
+    Future<ssize_t> Fsync(int fd) override;
+    const char* Name() const override;
+
+private:
+    //! 执行io的线程池
+    BlockingPool m_pool;
+};
+
+/**
+ * @brief 使用io_uring提交请求, 由一个线程收割完成事件并唤醒等待的协程
+ */
+class UringFileEngine : public FileEngine
+{
+public:
+    /**
+     * @brief 创建引擎
+     * @param entries 队列长度
+     * @return 内核不支持io_uring时返回空
+     */
+    static std::shared_ptr<UringFileEngine> Create(unsigned entries = 256);
+
+    ~UringFileEngine() override;
+
+    Future<ssize_t> Read(int fd, void* buf, size_t len, off_t offset) override;
+    Future<ssize_t> Write(int fd, std::vector<iovec> iov, off_t offset) override;
+    Future<ssize_t> Fsync(int fd) override;
+    const char* Name() const override;
+
+private:
+    struct Op;
+
+    UringFileEngine() = default;
+
+    /**
+     * @brief 初始化队列
+     * @param entries 队列长度
+     * @return 成功返回true
+     */
+    bool Init(unsigned entries);
+
+    /**
+     * @brief 提交请求, 在途请求达到上限时等待
+     * @param opcode 操作码
+     * @param fd 文件描述符
+     * @param op 请求, 完成后释放
+     * @param offset 位置
+     */
+    void Submit(uint8_t opcode, int fd, Op* op, off_t offset);
+
+    /**
+     * @brief 收割完成事件, 暂时性错误时重试, 致命错误时结束所有在途请求后退出
+     */
+    void Reap();
+
+    /**
+     * @brief 队列不可用, 所有在途请求以错误完成, 之后的请求直接失败
+     * @param err 错误码
+     */
+    void FailPending(int err);
+
+    //! io_uring的fd
+    int m_ring_fd = -1;
+    //! 提交队列的映射
+    void* m_sq_ptr = nullptr;
+    size_t m_sq_size = 0;
+    //! 完成队列的映射
+    void* m_cq_ptr = nullptr;
+    size_t m_cq_size = 0;
+    //! 提交队列项
+    void* m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+    //! 提交队列
+    unsigned* m_sq_head = nullptr;
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_mask = nullptr;
+    unsigned* m_sq_array = nullptr;
+    //! 完成队列
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned* m_cq_mask = nullptr;
+    void* m_cqes = nullptr;
+    //! 在途请求上限
+    unsigned m_capacity = 0;
+    //! 提交锁
+    std::mutex m_mut;
+    //! 在途请求减少的通知
+    std::condition_variable m_cv;
+    //! 在途请求数
+    unsigned m_inflight = 0;
+    //! 在途请求
+    std::unordered_set<Op*> m_pending;
+    //! 队列不可用时的错误码
+    int m_error = 0;
+    //! 收割线程
+    std::thread m_reaper;
+};
+
+}  // namespace coro
+
+#endif  // CORO_FILE_ENGINE_H
@@ -0,0 +1,313 @@
+#ifndef CORO_FUTURE_H
+#define CORO_FUTURE_H
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "awaiter.h"
+
+namespace coro
+{
+namespace detail
+{
+/**
+ * @brief 一次性结果的状态
+ */
+enum OneshotState : uint32_t
+{
+    //! 未设置结果, 无等待者
+    kEmpty,
+    //! 协程在等待
+    kWaiting,
+    //! 正在通知等待的协程
+    kNotifying,
+    //! 结果已设置
+    kReady,
+};
+
+/**
+ * @brief 发送端与接收端共享的状态, 只分配一次
+ * @tparam T 结果类型
+ */
+template <typename T>
+struct OneshotShared
+{
+    using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    /**
+     * @brief 在执行器所在线程唤醒等待的协程
+     */
+    void Wake()
+    {
+        if (auto* waiter = std::exchange(m_waiter, nullptr))
+        {
+            m_exec->Unref();
+            waiter->Resume();
+        }
+    }
+
+    /**
+     * @brief 取出结果, 异常则重新抛出
+     */
+    T Take()
+    {
+        if (m_value.index() == 2)
+        {
+            std::rethrow_exception(std::get<2>(m_value));
+        }
+        if constexpr (!std::is_void_v<T>)
+        {
+            return std::move(std::get<1>(m_value));
+        }
+    }
+
+    //! 状态
+    std::atomic_uint32_t m_state = kEmpty;
+    //! 结果
+    std::variant<std::monostate, value_type, std::exception_ptr> m_value;
+    //! 等待者所在的执行器
+    Executor* m_exec = nullptr;
+    //! 等待者, 只在执行器所在线程读写
+    BaseAwaiter* m_waiter = nullptr;
+};
+}  // namespace detail
+
+/**
+ * @brief Future的等待器, 挂起后由发送端投递到本执行器唤醒
+ * @tparam T 结果类型
+ */
+template <typename T>
+class FutureAwaiter : public BaseAwaiter
+{
+public:
+    explicit FutureAwaiter(std::shared_ptr<detail::OneshotShared<T>> shared)
+        : m_shared(std::move(shared))
+    {}
+
+    ~FutureAwaiter() override
+    {
+        if (m_shared->m_waiter != this)
+        {
+            return;
+        }
+        // 协程在等待期间被销毁, 撤销等待
+        uint32_t state = detail::kWaiting;
+        if (!m_shared->m_state.compare_exchange_strong(state, detail::kEmpty, std::memory_order_acq_rel))
+        {
+            // 发送端已开始通知, 等待投递完成, 投递的函数不会再唤醒本协程
+            while (m_shared->m_state.load(std::memory_order_acquire) == detail::kNotifying)
+            {
+            }
+        }
+        m_shared->m_waiter = nullptr;
+        m_shared->m_exec->Unref();
+    }
+
+    bool await_ready() const
+    {
+        return m_shared->m_state.load(std::memory_order_acquire) == detail::kReady;
+    }
+
+    void Handle() override
+    {
+        m_shared->m_exec = GetExecutor();
+        m_shared->m_waiter = this;
+        m_shared->m_exec->Ref();
+        uint32_t state = detail::kEmpty;
+        if (!m_shared->m_state.compare_exchange_strong(state, detail::kWaiting, std::memory_order_acq_rel))
+        {
+            // 挂起前结果已设置
+            m_shared->Wake();
+        }
+    }
+
+    T await_resume()
+    {
+        return m_shared->Take();
+    }
+
+private:
+    //! 共享状态
+    std::shared_ptr<detail::OneshotShared<T>> m_shared;
+};
+
+/**
+ * @brief 一次性结果的接收端, 可在协程中co_await, 或在普通线程中阻塞等待
+ * @tparam T 结果类型
+ */
+template <typename T>
+class Future
+{
+public:
+    Future() = default;
+    explicit Future(std::shared_ptr<detail::OneshotShared<T>> shared)
+        : m_shared(std::move(shared))
+    {}
+
+    /**
+     * @brief 挂起当前协程直到结果设置, 在协程所在的执行器上恢复, 只能等待一次
+     */
+    FutureAwaiter<T> operator co_await() const
+    {
+        return FutureAwaiter<T>(m_shared);
+    }
+
+    /**
+     * @brief 阻塞当前线程直到结果设置, 不能在执行器所在线程调用
+     * @return 结果, 发送端设置异常时抛出
+     */
+    T Get()
+    {
+        auto state = m_shared->m_state.load(std::memory_order_acquire);
+        while (state != detail::kReady)
+        {
+            m_shared->m_state.wait(state, std::memory_order_acquire);
+            state = m_shared->m_state.load(std::memory_order_acquire);
+        }
+        return m_shared->Take();
+    }
+
+    /**
+     * @brief 结果是否已设置
+     * @return
+     */
+    bool IsReady() const
+    {
+        return m_shared->m_state.load(std::memory_order_acquire) == detail::kReady;
+    }
+
+    /**
+     * @brief 是否关联了发送端
+     * @return
+     */
+    bool IsValid() const
+    {
+        return m_shared != nullptr;
+    }
+
+private:
+    //! 共享状态
+    std::shared_ptr<detail::OneshotShared<T>> m_shared;
+};
+
+/**
+ * @brief 一次性结果的发送端, 可在任意线程设置结果; 未设置结果就析构时, 接收端得到broken_promise异常
+ * @tparam T 结果类型
+ */
+template <typename T>
+class Oneshot
+{
+public:
+    Oneshot() = default;
+    Oneshot(const Oneshot&) = delete;
+    Oneshot(Oneshot&& other) noexcept = default;
+    explicit Oneshot(std::shared_ptr<detail::OneshotShared<T>> shared)
+        : m_shared(std::move(shared))
+    {}
+
+    ~Oneshot()
+    {
+        if (m_shared && !m_is_set)
+        {
+            SetException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    /**
+     * @brief 移动赋值, 原有的发送端未设置结果时同析构
+     */
+    Oneshot& operator=(Oneshot&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Oneshot old(std::move(*this));
+            m_shared = std::move(other.m_shared);
+            m_is_set = other.m_is_set;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 设置结果并唤醒接收端
+     * @param args 构造结果的参数, T为void时为空
+     * @return 首次设置返回true
+     */
+    template <typename... Args>
+    bool Set(Args&&... args)
+    {
+        if (!m_shared || m_is_set)
+        {
+            return false;
+        }
+        m_shared->m_value.template emplace<1>(std::forward<Args>(args)...);
+        Complete();
+        return true;
+    }
+
+    /**
+     * @brief 设置异常并唤醒接收端
+     * @param ptr 异常
+     * @return 首次设置返回true
+     */
+    bool SetException(std::exception_ptr ptr)
+    {
+        if (!m_shared || m_is_set)
+        {
+            return false;
+        }
+        m_shared->m_value.template emplace<2>(std::move(ptr));
+        Complete();
+        return true;
+    }
+
+private:
+    /**
+     * @brief 发布结果, 有协程等待时投递到其执行器唤醒
+     */
+    void Complete()
+    {
+        m_is_set = true;
+        auto& state = m_shared->m_state;
+        auto cur = state.load(std::memory_order_acquire);
+        while (true)
+        {
+            if (cur == detail::kEmpty && state.compare_exchange_weak(cur, detail::kReady, std::memory_order_acq_rel))
+            {
+                state.notify_all();
+                return;
+            }
+            if (cur == detail::kWaiting && state.compare_exchange_weak(cur, detail::kNotifying, std::memory_order_acq_rel))
+            {
+                break;
+            }
+        }
+        m_shared->m_exec->Post([shared = m_shared] { shared->Wake(); });
+        state.store(detail::kReady, std::memory_order_release);
+        state.notify_all();
+    }
+
+    //! 共享状态
+    std::shared_ptr<detail::OneshotShared<T>> m_shared;
+    //! 是否已设置
+    bool m_is_set = false;
+};
+
+/**
+ * @brief 创建一对一次性结果的发送端与接收端
+ * @tparam T 结果类型
+ * @return
+ */
+template <typename T>
+std::pair<Oneshot<T>, Future<T>> MakeOneshot()
+{
+    auto shared = std::make_shared<detail::OneshotShared<T>>();
+    return {Oneshot<T>(shared), Future<T>(shared)};
+}
+
+}  // namespace coro
+
+#endif  // CORO_FUTURE_H
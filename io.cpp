@@ -0,0 +1,34 @@
+#include "io.h"
+
+namespace coro
+{
+IoAwaiter::IoAwaiter(int fd, short what)
+    : m_fd(fd)
+    , m_what(what)
+{}
+
+IoAwaiter::~IoAwaiter()
+{
+    if (m_event)
+    {
+        event_free(m_event);
+    }
+}
+
+void IoAwaiter::Handle()
+{
+    if (!m_event)
+    {
+        m_event = event_new(EventBase(), m_fd, m_what, OnReady, this);
+    }
+    m_result = 0;
+    event_add(m_event, nullptr);
+}
+
+void IoAwaiter::OnReady(evutil_socket_t, short what, void* arg)
+{
+    auto pthis = static_cast<IoAwaiter*>(arg);
+    pthis->m_result = what;
+    pthis->Resume();
+}
+}  // namespace coro
@@ -0,0 +1,56 @@
+#ifndef CORO_IO_H
+#define CORO_IO_H
+
+#include "awaiter.h"
+
+namespace coro
+{
+/**
+ * @brief 等待fd可读或可写, 不进行读写; 同一等待器可反复co_await, 事件只创建一次
+ */
+class IoAwaiter : public coro::BaseAwaiter
+{
+public:
+    /**
+     * @brief 构造等待器
+     * @param fd 非阻塞的fd
+     * @param what 等待的事件, EV_READ或EV_WRITE
+     */
+    explicit IoAwaiter(int fd, short what = EV_READ);
+    ~IoAwaiter() override;
+
+    /**
+     * @brief 注册fd的读写事件
+     */
+    void Handle() override;
+
+    /**
+     * @brief 获取触发的事件
+     * @return
+     */
+    short await_resume() const
+    {
+        return m_result;
+    }
+
+private:
+    /**
+     * @brief fd就绪回调
+     * @param what 触发的事件
+     * @param arg this指针
+     */
+    static void OnReady(evutil_socket_t, short what, void* arg);
+
+    //! fd
+    int m_fd = -1;
+    //! 等待的事件
+    short m_what = EV_READ;
+    //! 触发的事件
+    short m_result = 0;
+    //! 事件
+    event* m_event = nullptr;
+};
+
+}  // namespace coro
+
+#endif  // CORO_IO_H
@@ -0,0 +1,64 @@
+#include "latch.h"
+
+namespace coro
+{
+Latch::Latch(ptrdiff_t count)
+    : m_count(count)
+{}
+
+void Latch::CountDown(ptrdiff_t n)
+{
+    detail::WaitQueue waiters;
+    {
+        std::lock_guard lk(m_mut);
+        m_count -= n;
+        if (m_count > 0)
+        {
+            return;
+        }
+        std::swap(waiters, m_waiters);
+    }
+    // 被唤醒的协程可能立即销毁门闩, 解锁后不再访问成员
+    waiters.WakeAll();
+}
+
+bool Latch::TryWait() const
+{
+    std::lock_guard lk(m_mut);
+    return m_count <= 0;
+}
+
+LatchAwaiter Latch::Wait()
+{
+    return LatchAwaiter(*this);
+}
+
+LatchAwaiter::~LatchAwaiter()
+{
+    if (!m_node)
+    {
+        return;
+    }
+    if (!m_node->m_notified.load(std::memory_order_acquire))
+    {
+        // 协程在等待期间被销毁
+        std::lock_guard lk(m_latch.m_mut);
+        m_latch.m_waiters.Remove(m_node);
+    }
+    detail::Abandon(m_node);
+}
+
+void LatchAwaiter::Handle()
+{
+    std::unique_lock lk(m_latch.m_mut);
+    if (m_latch.m_count <= 0)
+    {
+        lk.unlock();
+        Resume();
+        return;
+    }
+    m_node = detail::MakeWaitNode(this, GetExecutor());
+    m_latch.m_waiters.Push(m_node);
+}
+
+}  // namespace coro
@@ -0,0 +1,84 @@
+#ifndef CORO_LATCH_H
+#define CORO_LATCH_H
+
+#include <cstddef>
+#include <mutex>
+#include "wait_queue.h"
+
+namespace coro
+{
+class LatchAwaiter;
+
+/**
+ * @brief 协程的倒计数门闩, 任意线程CountDown, 计数归0时唤醒所有等待的协程; 等待者挂在门闩上, 不占用fd
+ */
+class Latch
+{
+public:
+    Latch(const Latch&) = delete;
+    /**
+     * @brief 构造门闩
+     * @param count 计数
+     */
+    explicit Latch(ptrdiff_t count);
+
+    /**
+     * @brief 减少计数, 可在任意线程调用
+     * @param n 减少的值
+     */
+    void CountDown(ptrdiff_t n = 1);
+
+    /**
+     * @brief 计数是否已归0
+     * @return
+     */
+    bool TryWait() const;
+
+    /**
+     * @brief 等待计数归0, 已归0时不挂起
+     * @return 等待器
+     */
+    LatchAwaiter Wait();
+
+private:
+    friend class LatchAwaiter;
+
+    //! 计数
+    ptrdiff_t m_count = 0;
+    //! 保护计数与等待队列; 计数归0后等待者可能立即销毁门闩, 读写计数都需持锁
+    mutable std::mutex m_mut;
+    //! 等待的协程
+    detail::WaitQueue m_waiters;
+};
+
+/**
+ * @brief Latch::Wait的等待器
+ */
+class LatchAwaiter : public WaitAwaiter
+{
+public:
+    explicit LatchAwaiter(Latch& latch)
+        : m_latch(latch)
+    {}
+    ~LatchAwaiter() override;
+
+    bool await_ready() const
+    {
+        return m_latch.TryWait();
+    }
+
+    /**
+     * @brief 加锁后重新检查, 计数未归0时登记等待
+     */
+    void Handle() override;
+
+private:
+    //! 门闩
+    Latch& m_latch;
+    //! 等待者
+    std::shared_ptr<detail::WaitNode> m_node;
+};
+
+}  // namespace coro
+
+#endif  // CORO_LATCH_H
@@ -0,0 +1,104 @@
+#include "manual_executor.h"
+
+namespace coro
+{
+namespace detail
+{
+EventBaseHolder::EventBaseHolder()
+    : m_owned_base(event_base_new())
+{}
+
+EventBaseHolder::~EventBaseHolder()
+{
+    event_base_free(m_owned_base);
+}
+}  // namespace detail
+
+ManualExecutor::ManualExecutor()
+    : Executor(m_owned_base)
+{}
+
+ManualExecutor::~ManualExecutor()
+{
+    // 协程栈上的awaiter会取消定时器, 需在本类析构前销毁
+    Cancel();
+    m_timer.clear();
+    m_timer_key.clear();
+}
+
+void ManualExecutor::AddTimer(event* ev, const timeval& tv)
+{
+    CancelTimer(ev);
+    auto delay = std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+    TimerKey key{m_now + delay, m_timer_seq++};
+    m_timer.emplace(key, ev);
+    m_timer_key.emplace(ev, key);
+}
+
+void ManualExecutor::CancelTimer(event* ev)
+{
+    auto it = m_timer_key.find(ev);
+    if (it == m_timer_key.end())
+    {
+        return;
+    }
+    m_timer.erase(it->second);
+    m_timer_key.erase(it);
+}
+
+size_t ManualExecutor::RunUntilIdle()
+{
+    auto start = m_schedule_count;
+    while (true)
+    {
+        auto before = m_schedule_count;
+        event_base_loop(EventBase(), EVLOOP_NONBLOCK);
+        if (m_schedule_count != before || GetReadyCount() > 0)
+        {
+            continue;
+        }
+        if (!FireOne(m_now))
+        {
+            break;
+        }
+    }
+    return m_schedule_count - start;
+}
+
+size_t ManualExecutor::AdvanceTime(std::chrono::nanoseconds d)
+{
+    auto target = m_now + d;
+    auto count = RunUntilIdle();
+    while (!m_timer.empty() && m_timer.begin()->first.first <= target)
+    {
+        m_now = m_timer.begin()->first.first;
+        count += RunUntilIdle();
+    }
+    m_now = target;
+    return count + RunUntilIdle();
+}
+
+std::chrono::nanoseconds ManualExecutor::Now() const
+{
+    return m_now;
+}
+
+size_t ManualExecutor::GetTimerCount() const
+{
+    return m_timer.size();
+}
+
+bool ManualExecutor::FireOne(std::chrono::nanoseconds deadline)
+{
+    if (m_timer.empty() || m_timer.begin()->first.first > deadline)
+    {
+        return false;
+    }
+    auto ev = m_timer.begin()->second;
+    m_timer_key.erase(ev);
+    m_timer.erase(m_timer.begin());
+    event_active(ev, EV_TIMEOUT, 1);
+    return true;
+}
+
+}  // namespace coro
@@ -0,0 +1,99 @@
+#ifndef CORO_MANUAL_EXECUTOR_H
+#define CORO_MANUAL_EXECUTOR_H
+
+#include <chrono>
+#include <map>
+#include <unordered_map>
+#include "executor.h"
+
+namespace coro
+{
+namespace detail
+{
+/**
+ * @brief 持有event_base, 作为ManualExecutor的第一个基类, 保证在执行器之后释放
+ */
+struct EventBaseHolder
+{
+    EventBaseHolder();
+    ~EventBaseHolder();
+
+    //! 事件循环
+    event_base* m_owned_base = nullptr;
+};
+}  // namespace detail
+
+/**
+ * @brief 单线程的测试执行器, 使用虚拟时间, 定时器只在AdvanceTime时到期,
+ *        由调用方驱动事件循环, 不需要额外的线程与真实等待
+ */
+class ManualExecutor : private detail::EventBaseHolder, public Executor
+{
+public:
+    ManualExecutor();
+    ~ManualExecutor() override;
+
+    /**
+     * @brief 以虚拟时间注册定时事件
+     * @param ev 定时事件
+     * @param tv 超时时间
+     */
+    void AddTimer(event* ev, const timeval& tv) override;
+
+    /**
+     * @brief 取消定时事件
+     * @param ev 定时事件
+     */
+    void CancelTimer(event* ev) override;
+
+    /**
+     * @brief 运行事件循环直到没有可执行的协程, 已到期的定时器同时触发
+     * @return 本次恢复的协程数
+     */
+    size_t RunUntilIdle();
+
+    /**
+     * @brief 推进虚拟时间, 按到期顺序触发定时器, 每次触发后运行到空闲
+     * @param d 推进的时长
+     * @return 本次恢复的协程数
+     */
+    size_t AdvanceTime(std::chrono::nanoseconds d);
+
+    /**
+     * @brief 获取虚拟时间, 从0开始
+     * @return
+     */
+    std::chrono::nanoseconds Now() const;
+
+    /**
+     * @brief 获取未到期的定时器数
+     * @return
+     */
+    size_t GetTimerCount() const;
+
+private:
+    /**
+     * @brief 定时器的排序键, 到期时间相同时按注册顺序
+     */
+    using TimerKey = std::pair<std::chrono::nanoseconds, uint64_t>;
+
+    /**
+     * @brief 触发到期时间不晚于deadline的第一个定时器
+     * @param deadline 截止时间
+     * @return 有定时器触发返回true
+     */
+    bool FireOne(std::chrono::nanoseconds deadline);
+
+    //! 虚拟时间
+    std::chrono::nanoseconds m_now{0};
+    //! 定时器注册序号
+    uint64_t m_timer_seq = 0;
+    //! 按到期时间排序的定时器
+    std::map<TimerKey, event*> m_timer;
+    //! 定时器所在的位置, 用于取消
+    std::unordered_map<event*, TimerKey> m_timer_key;
+};
+
+}  // namespace coro
+
+#endif  // CORO_MANUAL_EXECUTOR_H
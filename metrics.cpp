@@ -0,0 +1,164 @@
+#include "metrics.h"
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <vector>
+
+namespace coro
+{
+namespace
+{
+struct Registry
+{
+    //! 互斥锁
+    std::mutex m_mut;
+    //! 存活线程的指标
+    std::vector<Metrics*> m_shard;
+    //! 已退出线程的指标
+    MetricsSnapshot m_retired;
+};
+
+Registry& GetRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+struct ShardHolder
+{
+    ShardHolder()
+    {
+        auto& registry = GetRegistry();
+        std::lock_guard lk(registry.m_mut);
+        registry.m_shard.emplace_back(&m_shard);
+    }
+
+    ~ShardHolder()
+    {
+        auto& registry = GetRegistry();
+        std::lock_guard lk(registry.m_mut);
+        m_shard.Collect(registry.m_retired);
+        std::erase(registry.m_shard, &m_shard);
+    }
+
+    Metrics m_shard;
+};
+
+void Dump(std::ostream& os, const char* name, const HistogramSnapshot& h)
+{
+    os << name << "_count " << h.m_count << "\n";
+    os << name << "_sum_ns " << h.m_sum << "\n";
+    os << name << "_max_ns " << h.m_max << "\n";
+    os << name << "_p50_ns " << h.Percentile(0.5) << "\n";
+    os << name << "_p99_ns " << h.Percentile(0.99) << "\n";
+}
+}  // namespace
+
+HistogramSnapshot& HistogramSnapshot::operator+=(const HistogramSnapshot& other)
+{
+    for (size_t i = 0; i < kHistogramBucket; i++)
+    {
+        m_bucket[i] += other.m_bucket[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max(m_max, other.m_max);
+    return *this;
+}
+
+uint64_t HistogramSnapshot::Percentile(double p) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+    auto target = static_cast<uint64_t>(p * static_cast<double>(m_count));
+    uint64_t sum = 0;
+    for (size_t i = 0; i < kHistogramBucket; i++)
+    {
+        sum += m_bucket[i];
+        if (sum > target)
+        {
+            return std::min(m_max, (uint64_t(1) << i) - 1);
+        }
+    }
+    return m_max;
+}
+
+void Histogram::Record(uint64_t ns)
+{
+    auto idx = std::min<size_t>(std::bit_width(ns), kHistogramBucket - 1);
+    m_bucket[idx].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    m_max.Update(ns);
+}
+
+HistogramSnapshot Histogram::Snapshot() const
+{
+    HistogramSnapshot snapshot;
+    for (size_t i = 0; i < kHistogramBucket; i++)
+    {
+        snapshot.m_bucket[i] = m_bucket[i].load(std::memory_order_relaxed);
+    }
+    snapshot.m_count = m_count.load(std::memory_order_relaxed);
+    snapshot.m_sum = m_sum.load(std::memory_order_relaxed);
+    snapshot.m_max = m_max.Get();
+    return snapshot;
+}
+
+void MetricsSnapshot::Dump(std::ostream& os) const
+{
+    os << "coro_task_spawned " << m_task_spawned << "\n";
+    os << "coro_task_completed " << m_task_completed << "\n";
+    os << "coro_task_suspended " << m_task_suspended << "\n";
+    coro::Dump(os, "coro_loop_time", m_loop_time);
+    coro::Dump(os, "coro_callback_latency", m_callback_latency);
+    os << "coro_queue_depth_max " << m_queue_depth_max << "\n";
+    os << "coro_channel_push " << m_channel_push << "\n";
+    os << "coro_channel_pop " << m_channel_pop << "\n";
+    os << "coro_channel_depth_max " << m_channel_depth_max << "\n";
+    os << "coro_mutex_lock " << m_mutex_lock << "\n";
+    os << "coro_mutex_contended " << m_mutex_contended << "\n";
+    coro::Dump(os, "coro_mutex_wait", m_mutex_wait);
+    os << "coro_blocking_task " << m_blocking_task << "\n";
+    coro::Dump(os, "coro_blocking_queue_time", m_blocking_queue_time);
+}
+
+Metrics& Metrics::Local()
+{
+    thread_local ShardHolder holder;
+    return holder.m_shard;
+}
+
+MetricsSnapshot Metrics::Snapshot()
+{
+    auto& registry = GetRegistry();
+    std::lock_guard lk(registry.m_mut);
+    auto snapshot = registry.m_retired;
+    for (auto* shard : registry.m_shard)
+    {
+        shard->Collect(snapshot);
+    }
+    return snapshot;
+}
+
+void Metrics::Collect(MetricsSnapshot& snapshot) const
+{
+    snapshot.m_task_spawned += m_task_spawned.Get();
+    snapshot.m_task_completed += m_task_completed.Get();
+    snapshot.m_task_suspended += m_task_suspended.Get();
+    snapshot.m_loop_time += m_loop_time.Snapshot();
+    snapshot.m_callback_latency += m_callback_latency.Snapshot();
+    snapshot.m_queue_depth_max = std::max(snapshot.m_queue_depth_max, m_queue_depth_max.Get());
+    snapshot.m_channel_push += m_channel_push.Get();
+    snapshot.m_channel_pop += m_channel_pop.Get();
+    snapshot.m_channel_depth_max = std::max(snapshot.m_channel_depth_max, m_channel_depth_max.Get());
+    snapshot.m_mutex_lock += m_mutex_lock.Get();
+    snapshot.m_mutex_contended += m_mutex_contended.Get();
+    snapshot.m_mutex_wait += m_mutex_wait.Snapshot();
+    snapshot.m_blocking_task += m_blocking_task.Get();
+    snapshot.m_blocking_queue_time += m_blocking_queue_time.Snapshot();
+}
+
+}  // namespace coro
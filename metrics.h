@@ -0,0 +1,197 @@
+#ifndef CORO_METRICS_H
+#define CORO_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace coro
+{
+#ifdef CORO_METRICS
+constexpr bool kMetricsEnabled = true;
+#else
+constexpr bool kMetricsEnabled = false;
+#endif
+
+//! 直方图桶数, 第i个桶统计[2^(i-1), 2^i)纳秒
+constexpr size_t kHistogramBucket = 64;
+
+/**
+ * @brief 获取单调时钟的纳秒数
+ */
+inline uint64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 直方图快照
+ */
+struct HistogramSnapshot
+{
+    HistogramSnapshot& operator+=(const HistogramSnapshot& other);
+
+    /**
+     * @brief 估算分位数
+     * @param p 分位, 取值[0, 1]
+     * @return 所在桶的上界, 纳秒
+     */
+    uint64_t Percentile(double p) const;
+
+    //! 各桶计数
+    std::array<uint64_t, kHistogramBucket> m_bucket{};
+    //! 样本数
+    uint64_t m_count = 0;
+    //! 样本和
+    uint64_t m_sum = 0;
+    //! 最大值
+    uint64_t m_max = 0;
+};
+
+/**
+ * @brief 计数器, 只由所属线程写入, 任意线程读取
+ */
+class Counter
+{
+public:
+    void Add(uint64_t n = 1) { m_val.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Get() const { return m_val.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic_uint64_t m_val = 0;
+};
+
+/**
+ * @brief 记录最大值
+ */
+class MaxGauge
+{
+public:
+    void Update(uint64_t val)
+    {
+        auto cur = m_val.load(std::memory_order_relaxed);
+        while (val > cur && !m_val.compare_exchange_weak(cur, val, std::memory_order_relaxed))
+        {
+        }
+    }
+    uint64_t Get() const { return m_val.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic_uint64_t m_val = 0;
+};
+
+/**
+ * @brief 以2的幂分桶的直方图
+ */
+class Histogram
+{
+public:
+    /**
+     * @brief 记录一个样本
+     * @param ns 纳秒
+     */
+    void Record(uint64_t ns);
+
+    /**
+     * @brief 获取快照
+     * @return
+     */
+    HistogramSnapshot Snapshot() const;
+
+private:
+    //! 各桶计数
+    std::array<std::atomic_uint64_t, kHistogramBucket> m_bucket{};
+    //! 样本数
+    std::atomic_uint64_t m_count = 0;
+    //! 样本和
+    std::atomic_uint64_t m_sum = 0;
+    //! 最大值
+    MaxGauge m_max;
+};
+
+/**
+ * @brief 运行时指标快照, 所有线程的指标之和
+ */
+struct MetricsSnapshot
+{
+    /**
+     * @brief 以"名称 值"的文本格式输出
+     * @param os 输出流
+     */
+    void Dump(std::ostream& os) const;
+
+    //! 启动的协程数
+    uint64_t m_task_spawned = 0;
+    //! 结束的协程数
+    uint64_t m_task_completed = 0;
+    //! 启动后被挂起的协程数
+    uint64_t m_task_suspended = 0;
+    //! 每轮处理就绪队列的耗时
+    HistogramSnapshot m_loop_time;
+    //! 协程就绪到被恢复的延迟
+    HistogramSnapshot m_callback_latency;
+    //! 线程池任务队列的最大深度
+    uint64_t m_queue_depth_max = 0;
+    //! channel写入次数
+    uint64_t m_channel_push = 0;
+    //! channel读取次数
+    uint64_t m_channel_pop = 0;
+    //! channel的最大深度
+    uint64_t m_channel_depth_max = 0;
+    //! 互斥锁加锁次数
+    uint64_t m_mutex_lock = 0;
+    //! 互斥锁需要等待的次数
+    uint64_t m_mutex_contended = 0;
+    //! 互斥锁的等待时间
+    HistogramSnapshot m_mutex_wait;
+    //! 阻塞线程池执行的任务数
+    uint64_t m_blocking_task = 0;
+    //! 阻塞任务的排队时间
+    HistogramSnapshot m_blocking_queue_time;
+};
+
+/**
+ * @brief 运行时指标, 每个线程一份, 读取时汇总
+ */
+class Metrics
+{
+public:
+    /**
+     * @brief 获取当前线程的指标
+     * @return
+     */
+    static Metrics& Local();
+
+    /**
+     * @brief 汇总所有线程的指标, 包括已退出的线程
+     * @return
+     */
+    static MetricsSnapshot Snapshot();
+
+    /**
+     * @brief 累加到快照
+     * @param snapshot 快照
+     */
+    void Collect(MetricsSnapshot& snapshot) const;
+
+    Counter m_task_spawned;
+    Counter m_task_completed;
+    Counter m_task_suspended;
+    Histogram m_loop_time;
+    Histogram m_callback_latency;
+    MaxGauge m_queue_depth_max;
+    Counter m_channel_push;
+    Counter m_channel_pop;
+    MaxGauge m_channel_depth_max;
+    Counter m_mutex_lock;
+    Counter m_mutex_contended;
+    Histogram m_mutex_wait;
+    Counter m_blocking_task;
+    Histogram m_blocking_queue_time;
+};
+
+}  // namespace coro
+
+#endif  // CORO_METRICS_H
@@ -1,7 +1,5 @@
 #include "mutex.h"
-#include <sys/eventfd.h>
 #include <utility>
-#include "eventfd.h"
 
 namespace coro
 {
@@ -9,44 +7,205 @@ LockGuard::LockGuard(std::function<void()> unlock)
     : m_unlock(std::move(unlock))
 {}
 
+LockGuard::LockGuard(Mutex* mutex)
+    : m_mutex(mutex)
+{}
+
+LockGuard::LockGuard(LockGuard&& x) noexcept
+    : m_unlock(std::exchange(x.m_unlock, nullptr))
+    , m_mutex(std::exchange(x.m_mutex, nullptr))
+{}
+
 LockGuard::~LockGuard()
 {
-    if (m_unlock)
+    Unlock();
+}
+
+LockGuard& LockGuard::operator=(LockGuard&& x) noexcept
+{
+    if (this != &x)
     {
-        m_unlock();
+        Unlock();
+        m_unlock = std::exchange(x.m_unlock, nullptr);
+        m_mutex = std::exchange(x.m_mutex, nullptr);
     }
+    return *this;
 }
 
-Mutex::Mutex()
-    : m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
-{}
+void LockGuard::Unlock()
+{
+    if (m_mutex)
+    {
+        std::exchange(m_mutex, nullptr)->Unlock();
+    }
+    else if (m_unlock)
+    {
+        std::exchange(m_unlock, nullptr)();
+    }
+}
+
+Mutex* LockGuard::GetMutex() const
+{
+    return m_mutex;
+}
 
-Mutex::~Mutex()
+LockAwaiter Mutex::Lock()
 {
-    close(m_fd);
+    return LockAwaiter(*this);
 }
 
-Task<LockGuard&&> Mutex::Lock()
+bool Mutex::TryLock()
 {
-    EventFdAwaiter awaiter(m_fd);
-    do
+    bool expected = false;
+    return m_is_lock.compare_exchange_strong(expected, true, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+void Mutex::Unlock()
+{
+    // 与等待者的计数和重试构成先写后读的配对, 需要seq_cst:
+    // 要么等待者重试时上锁成功, 要么此处看到等待者
+    m_is_lock.store(false, std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_seq_cst) > 0)
+    {
+        WakeOne();
+    }
+}
+
+void Mutex::WakeOne()
+{
+    while (true)
     {
+        std::shared_ptr<detail::WaitNode> node;
         {
             std::lock_guard lk(m_mut);
-            if (!m_is_lock)
+            node = m_queue.Pop();
+            if (!node)
             {
-                m_is_lock = true;
-                break;
+                return;
             }
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+        // 在锁外唤醒, 同一执行器上的等待者会直接重试上锁; 等待者已撤销时唤醒下一个
+        if (detail::Wake(node))
+        {
+            return;
         }
-        co_await awaiter;
-    } while (true);
-    co_return LockGuard([this] { Unlock(); });
+    }
 }
 
-void Mutex::Unlock()
+bool Mutex::Requeue(const std::shared_ptr<detail::WaitNode>& node)
+{
+    {
+        // 与等待者析构时的撤销互斥, 检查后等待者不会被销毁
+        std::lock_guard lk(m_mut);
+        if (node->m_notified.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        m_queue.Push(node);
+    }
+    // 与Park相同, 计数前已解锁时解锁方可能未看到等待者, 唤醒一个等待者重试
+    if (!m_is_lock.load(std::memory_order_seq_cst))
+    {
+        WakeOne();
+    }
+    return true;
+}
+
+LockAwaiter::LockAwaiter(Mutex& mut)
+    : m_mutex(mut)
+{}
+
+LockAwaiter::~LockAwaiter()
+{
+    if (m_node)
+    {
+        bool notified = false;
+        {
+            // 在锁内移除并标记, Requeue不会再把节点放入队列, WakeOne取出的节点由标记决定归属
+            std::lock_guard lk(m_mutex.m_mut);
+            if (m_mutex.m_queue.Remove(m_node))
+            {
+                m_mutex.m_waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+            notified = detail::Abandon(m_node);
+        }
+        if (notified && !m_woken)
+        {
+            // 已被唤醒但未处理, 转给下一个等待者
+            m_mutex.WakeOne();
+        }
+    }
+    if (m_locked && !m_resumed)
+    {
+        // 已上锁但协程未恢复
+        m_mutex.Unlock();
+    }
+}
+
+bool LockAwaiter::await_ready()
 {
-    eventfd_write(m_fd, 1);
-    m_is_lock = false;
+    return m_mutex.TryLock();
+}
+
+void LockAwaiter::Handle()
+{
+    if constexpr (kMetricsEnabled)
+    {
+        m_start = NowNs();
+        Metrics::Local().m_mutex_contended.Add();
+    }
+    Park();
+}
+
+void LockAwaiter::OnWake()
+{
+    m_woken = true;
+    if (m_mutex.TryLock())
+    {
+        m_locked = true;
+        Resume();
+        return;
+    }
+    Park();
+}
+
+void LockAwaiter::Park()
+{
+    std::unique_lock lk(m_mutex.m_mut);
+    m_mutex.m_waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (m_mutex.TryLock())
+    {
+        // 计数前已解锁, 解锁方可能未看到等待者
+        m_mutex.m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        lk.unlock();
+        m_locked = true;
+        Resume();
+        return;
+    }
+    if (m_node)
+    {
+        // 上一个等待者已唤醒, 其引用在唤醒结束后释放
+        m_node->m_awaiter = nullptr;
+    }
+    m_node = detail::MakeWaitNode(this, GetExecutor());
+    m_woken = false;
+    m_mutex.m_queue.Push(m_node);
+}
+
+LockGuard LockAwaiter::await_resume()
+{
+    m_resumed = true;
+    if constexpr (kMetricsEnabled)
+    {
+        auto& metrics = Metrics::Local();
+        metrics.m_mutex_lock.Add();
+        if (m_start != 0)
+        {
+            metrics.m_mutex_wait.Record(NowNs() - m_start);
+        }
+    }
+    return LockGuard(&m_mutex);
 }
-}  // namespace coro
\ No newline at end of file
+}  // namespace coro
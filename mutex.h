@@ -3,44 +3,144 @@
 
 #include <atomic>
 #include <functional>
+#include <mutex>
+#include "awaiter.h"
+#include "metrics.h"
 #include "task.h"
+#include "wait_queue.h"
 namespace coro
 {
+class Mutex;
+class ConditionVariable;
+
 class LockGuard
 {
 public:
+    LockGuard() = default;
     LockGuard(const LockGuard& x) = delete;
-    LockGuard(LockGuard&& x) = default;
+    LockGuard(LockGuard&& x) noexcept;
     explicit LockGuard(std::function<void()> unlock);
+    /**
+     * @brief 持有互斥锁
+     * @param mutex 已上锁的互斥锁
+     */
+    explicit LockGuard(Mutex* mutex);
     ~LockGuard();
+
+    /**
+     * @brief 移动赋值, 原先持有的锁先解锁
+     */
+    LockGuard& operator=(LockGuard&& x) noexcept;
+
+    /**
+     * @brief 提前解锁
+     */
+    void Unlock();
+
+    /**
+     * @brief 获取持有的互斥锁
+     * @return 由解锁函数构造或已解锁时为空
+     */
+    Mutex* GetMutex() const;
 private:
     //! 解锁函数
     std::function<void()> m_unlock;
+    //! 持有的互斥锁
+    Mutex* m_mutex = nullptr;
+};
+
+/**
+ * @brief Mutex::Lock的等待器, 未上锁时不挂起协程, 否则挂在互斥体上等待解锁时唤醒
+ */
+class LockAwaiter : public WaitAwaiter
+{
+public:
+    explicit LockAwaiter(Mutex& mut);
+    ~LockAwaiter() override;
+
+    bool await_ready();
+
+    /**
+     * @brief 登记等待
+     */
+    void Handle() override;
+
+    /**
+     * @brief 被唤醒后在本线程重试上锁, 失败则重新登记
+     */
+    void OnWake() override;
+
+    LockGuard await_resume();
+protected:
+    /**
+     * @brief 加锁后重试上锁, 仍被占用时登记等待
+     */
+    void Park();
+
+    //! 互斥体
+    Mutex& m_mutex;
+    //! 等待者
+    std::shared_ptr<detail::WaitNode> m_node;
+    //! 开始等待的时间
+    uint64_t m_start = 0;
+    //! 当前等待者的唤醒是否已处理
+    bool m_woken = false;
+    //! 是否已为本协程上锁
+    bool m_locked = false;
+    //! 是否已恢复, 锁的所有权转移给LockGuard
+    bool m_resumed = false;
 };
 
+/**
+ * @brief 协程互斥锁, 不占用内核对象, 等待的协程经所在执行器的投递通知唤醒
+ */
 class Mutex
 {
 public:
-    Mutex();
-    ~Mutex();
+    Mutex() = default;
+    Mutex(const Mutex&) = delete;
 
     /**
-     * @brief 锁定互斥体
-     * @return 互斥体包装器
+     * @brief 锁定互斥体, 未上锁时不挂起协程
+     * @return 等待器, co_await返回互斥体包装器
      */
-    Task<LockGuard&&> Lock();
+    LockAwaiter Lock();
 
     /**
-     * @brief 解锁互斥体
+     * @brief 尝试锁定互斥体
+     * @return 上锁成功返回true
+     */
+    bool TryLock();
+
+    /**
+     * @brief 解锁互斥体, 有协程等待时唤醒最早等待的协程, 由其在所在线程重试上锁;
+     *        不直接交付锁, 避免持有者未被调度时其他协程都无法上锁
      */
     void Unlock();
 private:
-    //! 互斥锁
+    friend class LockAwaiter;
+    friend class ConditionVariable;
+
+    /**
+     * @brief 唤醒一个等待的协程
+     */
+    void WakeOne();
+
+    /**
+     * @brief 把条件变量上被通知的等待者直接移到等待队列, 由解锁唤醒, 避免唤醒后再竞争锁
+     * @param node 等待者, 其等待器需继承LockAwaiter
+     * @return 等待者已撤销时返回false
+     */
+    bool Requeue(const std::shared_ptr<detail::WaitNode>& node);
+
+    //! 保护等待队列
     std::mutex m_mut;
-    //! event fd
-    int32_t m_fd = 0;
+    //! 等待的协程
+    detail::WaitQueue m_queue;
     //! 是否上锁
     std::atomic_bool m_is_lock = false;
+    //! 等待的协程数, 只在持有m_mut时修改, 为0时解锁不加锁
+    std::atomic_uint32_t m_waiters = 0;
 };
 }  // namespace coro
 
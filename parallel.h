@@ -0,0 +1,209 @@
+#ifndef CORO_PARALLEL_H
+#define CORO_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <vector>
+#include "latch.h"
+#include "thread_pool.h"
+
+namespace coro
+{
+namespace detail
+{
+//! 默认每个工作线程分得的块数, 块数多于线程数以平衡负载
+constexpr size_t kChunksPerWorker = 4;
+
+/**
+ * @brief 计算块大小
+ * @param size 元素数
+ * @param workers 工作线程数
+ * @param grain 指定的块大小, 为0时按线程数计算
+ * @return
+ */
+inline size_t ChunkSize(size_t size, size_t workers, size_t grain)
+{
+    if (grain > 0)
+    {
+        return grain;
+    }
+    return std::max<size_t>(1, size / (std::max<size_t>(workers, 1) * kChunksPerWorker));
+}
+
+/**
+ * @brief 在线程池中执行count个块并挂起等待全部完成, 第一个异常在等待结束后重新抛出;
+ *        线程池已关闭时在当前协程中顺序执行
+ * @param pool 线程池
+ * @param count 块数
+ * @param fn 块函数, 参数为块的序号
+ */
+template <typename F>
+Task<void> RunChunks(ThreadPool& pool, size_t count, F& fn)
+{
+    if (count == 0)
+    {
+        co_return;
+    }
+    Latch latch(static_cast<ptrdiff_t>(count));
+    std::atomic_flag failed;
+    std::exception_ptr error;
+    auto make = [&](size_t idx) {
+        return [&, idx]() -> Task<void> {
+            try
+            {
+                fn(idx);
+            }
+            catch (...)
+            {
+                if (!failed.test_and_set())
+                {
+                    error = std::current_exception();
+                }
+            }
+            latch.CountDown();
+            co_return;
+        };
+    };
+    std::vector<decltype(make(0))> tasks;
+    tasks.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        tasks.emplace_back(make(i));
+    }
+    if (!pool.AddBatch(std::move(tasks)))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            fn(i);
+        }
+        co_return;
+    }
+    co_await latch.Wait();
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief 并行地对每个元素调用函数, 元素按块分配到线程池, 当前协程挂起直到全部完成, 不阻塞事件循环
+ * @param pool 线程池
+ * @param range 随机访问的范围, 需保持有效直到返回
+ * @param fn 元素函数, 在工作线程中并发调用
+ * @param grain 每块的元素数, 为0时按线程数计算
+ */
+template <std::ranges::random_access_range R, typename F>
+Task<void> ParallelFor(ThreadPool& pool, R&& range, F fn, size_t grain = 0)
+{
+    auto first = std::ranges::begin(range);
+    auto size = static_cast<size_t>(std::ranges::distance(range));
+    auto chunk = detail::ChunkSize(size, pool.GetWorkerCount(), grain);
+    auto body = [&](size_t idx) {
+        auto begin = first + static_cast<ptrdiff_t>(idx * chunk);
+        auto end = first + static_cast<ptrdiff_t>(std::min(size, (idx + 1) * chunk));
+        for (auto it = begin; it != end; ++it)
+        {
+            fn(*it);
+        }
+    };
+    co_await detail::RunChunks(pool, (size + chunk - 1) / chunk, body);
+}
+
+/**
+ * @brief 并行归约, 每块先各自归约, 再按块的顺序与初值合并; op需满足结合律
+ * @param pool 线程池
+ * @param range 随机访问的范围, 元素可转换为T
+ * @param init 初值
+ * @param op 二元运算, 参数与结果为T
+ * @param grain 每块的元素数, 为0时按线程数计算
+ * @return init op e0 op e1 ...
+ */
+template <std::ranges::random_access_range R, typename T, typename Op = std::plus<>>
+Task<T> ParallelReduce(ThreadPool& pool, R&& range, T init, Op op = {}, size_t grain = 0)
+{
+    auto first = std::ranges::begin(range);
+    auto size = static_cast<size_t>(std::ranges::distance(range));
+    auto chunk = detail::ChunkSize(size, pool.GetWorkerCount(), grain);
+    auto count = (size + chunk - 1) / chunk;
+    std::vector<std::optional<T>> partials(count);
+    auto body = [&](size_t idx) {
+        auto begin = first + static_cast<ptrdiff_t>(idx * chunk);
+        auto end = first + static_cast<ptrdiff_t>(std::min(size, (idx + 1) * chunk));
+        T acc = *begin;
+        for (auto it = begin + 1; it != end; ++it)
+        {
+            acc = op(std::move(acc), *it);
+        }
+        partials[idx].emplace(std::move(acc));
+    };
+    co_await detail::RunChunks(pool, count, body);
+    for (auto& partial : partials)
+    {
+        init = op(std::move(init), std::move(*partial));
+    }
+    co_return init;
+}
+
+/**
+ * @brief 并行排序, 各块并行排序后逐轮两两归并, 每轮的归并也并行执行; 不稳定
+ * @param pool 线程池
+ * @param range 随机访问的范围
+ * @param comp 比较函数
+ * @param grain 每块的元素数, 为0时每个工作线程一块
+ */
+template <std::ranges::random_access_range R, typename Comp = std::ranges::less>
+Task<void> ParallelSort(ThreadPool& pool, R&& range, Comp comp = {}, size_t grain = 0)
+{
+    auto first = std::ranges::begin(range);
+    auto size = static_cast<size_t>(std::ranges::distance(range));
+    if (grain == 0)
+    {
+        // 归并的轮数随块数增长, 每个线程一块即可
+        grain = std::max<size_t>(1, (size + pool.GetWorkerCount() - 1) / std::max<size_t>(pool.GetWorkerCount(), 1));
+    }
+    // 有序段的边界
+    std::vector<size_t> bounds;
+    for (size_t pos = 0; pos < size; pos += grain)
+    {
+        bounds.emplace_back(pos);
+    }
+    bounds.emplace_back(size);
+
+    auto sort = [&](size_t idx) {
+        std::sort(first + static_cast<ptrdiff_t>(bounds[idx]), first + static_cast<ptrdiff_t>(bounds[idx + 1]), comp);
+    };
+    co_await detail::RunChunks(pool, bounds.size() - 1, sort);
+
+    while (bounds.size() > 2)
+    {
+        // 段[2i, 2i+1]归并为一段, 段数为奇数时最后一段留到下一轮
+        auto merge = [&](size_t idx) {
+            auto begin = first + static_cast<ptrdiff_t>(bounds[idx * 2]);
+            auto mid = first + static_cast<ptrdiff_t>(bounds[idx * 2 + 1]);
+            auto end = first + static_cast<ptrdiff_t>(bounds[idx * 2 + 2]);
+            std::inplace_merge(begin, mid, end, comp);
+        };
+        auto runs = bounds.size() - 1;
+        co_await detail::RunChunks(pool, runs / 2, merge);
+        std::vector<size_t> next;
+        for (size_t i = 0; i < bounds.size(); i += 2)
+        {
+            next.emplace_back(bounds[i]);
+        }
+        if (next.back() != size)
+        {
+            next.emplace_back(size);
+        }
+        bounds = std::move(next);
+    }
+}
+
+}  // namespace coro
+
+#endif  // CORO_PARALLEL_H
@@ -0,0 +1,128 @@
+#include "pipeline.h"
+#include <stdexcept>
+
+namespace coro
+{
+bool Pipeline::Start(Executor* exec)
+{
+    if (m_latch)
+    {
+        return false;
+    }
+    exec = exec ? exec : Executor::Current();
+    size_t total = 0;
+    for (auto& stage : m_stages)
+    {
+        if (!stage->m_option.m_pool && !stage->m_option.m_exec && !exec)
+        {
+            return false;
+        }
+        stage->m_running = stage->m_tasks.size();
+        total += stage->m_tasks.size();
+    }
+    m_latch = std::make_unique<Latch>(total);
+    // 依次分配工作线程, 相邻阶段的协程落在不同线程上
+    size_t slot = 0;
+    for (auto& stage : m_stages)
+    {
+        for (auto& body : stage->m_tasks)
+        {
+            std::function<Task<void>()> func = [this, st = stage.get(), body] { return RunWorker(this, st, body); };
+            auto* pool = stage->m_option.m_pool;
+            if (pool && pool->AddTo(slot++, func))
+            {
+                continue;
+            }
+            auto* target = stage->m_option.m_exec ? stage->m_option.m_exec : exec;
+            if (target == exec || target == Executor::Current())
+            {
+                target->RunTask(func);
+            }
+            else if (!target->Post([target, func] { target->RunTask(func); }))
+            {
+                // 阶段的执行器未监听投递, 协程无法启动, 按异常结束
+                Fail(std::make_exception_ptr(std::runtime_error{"pipeline stage executor is not accepting posts"}));
+                if (stage->m_running.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    stage->m_close();
+                }
+                m_latch->CountDown();
+            }
+        }
+    }
+    return true;
+}
+
+Task<void> Pipeline::Wait()
+{
+    if (!m_latch)
+    {
+        co_return;
+    }
+    co_await m_latch->Wait();
+    if (m_error)
+    {
+        std::rethrow_exception(m_error);
+    }
+}
+
+void Pipeline::Cancel()
+{
+    for (auto& close : m_closers)
+    {
+        close();
+    }
+}
+
+std::vector<StageStats> Pipeline::GetStats() const
+{
+    std::vector<StageStats> stats;
+    stats.reserve(m_stages.size());
+    for (auto& stage : m_stages)
+    {
+        stats.emplace_back(StageStats{
+            .m_name = stage->m_name,
+            .m_workers = stage->m_workers,
+            .m_in = stage->m_in.load(std::memory_order_relaxed),
+            .m_out = stage->m_out.load(std::memory_order_relaxed),
+            .m_queued = stage->m_queued(),
+            .m_capacity = stage->m_capacity,
+            .m_busy_ns = stage->m_busy_ns.load(std::memory_order_relaxed),
+            .m_blocked_ns = stage->m_blocked_ns.load(std::memory_order_relaxed),
+        });
+    }
+    return stats;
+}
+
+void Pipeline::Fail(std::exception_ptr e)
+{
+    {
+        std::lock_guard lk(m_mut);
+        if (m_error)
+        {
+            return;
+        }
+        m_error = std::move(e);
+    }
+    Cancel();
+}
+
+Task<void> Pipeline::RunWorker(Pipeline* pipeline, detail::StageState* stage, std::function<Task<void>()> body)
+{
+    try
+    {
+        co_await body();
+    }
+    catch (...)
+    {
+        pipeline->Fail(std::current_exception());
+    }
+    if (stage->m_running.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        stage->m_close();
+    }
+    // 最后一次计数后流水线可能被销毁
+    pipeline->m_latch->CountDown();
+}
+
+}  // namespace coro
@@ -0,0 +1,576 @@
+#ifndef CORO_PIPELINE_H
+#define CORO_PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bounded_channel.h"
+#include "future.h"
+#include "latch.h"
+#include "metrics.h"
+#include "task.h"
+#include "thread_pool.h"
+
+namespace coro
+{
+/**
+ * @brief 流水线阶段的参数
+ */
+struct StageOption
+{
+    //! 阶段名, 为空时按阶段类型与序号命名
+    std::string m_name;
+    //! 输出channel的容量, 写满时阶段挂起, 背压传递到上游
+    size_t m_capacity = 64;
+    //! 运行阶段的执行器, 为空时使用Pipeline::Start指定的执行器
+    Executor* m_exec = nullptr;
+    //! 运行阶段的线程池, 设置时阶段的协程分散到各工作线程, 优先于m_exec
+    ThreadPool* m_pool = nullptr;
+};
+
+/**
+ * @brief ParallelMap的输出顺序
+ */
+enum class MapOrder
+{
+    //! 按输入顺序输出
+    Ordered,
+    //! 按完成顺序输出
+    Unordered,
+};
+
+/**
+ * @brief 阶段的统计, 输入channel长期排满且下游等待时间少的阶段是瓶颈
+ */
+struct StageStats
+{
+    //! 阶段名
+    std::string m_name;
+    //! 并发数
+    size_t m_workers = 0;
+    //! 读取的数据数
+    uint64_t m_in = 0;
+    //! 写出的数据数
+    uint64_t m_out = 0;
+    //! 输入channel中排队的数据数
+    size_t m_queued = 0;
+    //! 输入channel的容量
+    size_t m_capacity = 0;
+    //! 处理函数的耗时, 包括异步处理函数挂起的时间; 按采样估计
+    uint64_t m_busy_ns = 0;
+    //! 等待下游channel空间的时间
+    uint64_t m_blocked_ns = 0;
+};
+
+class Pipeline;
+
+namespace detail
+{
+/**
+ * @brief 阶段的状态与统计, 统计使用relaxed原子计数
+ */
+struct StageState
+{
+    //! 阶段名
+    std::string m_name;
+    //! 参数
+    StageOption m_option;
+    //! 并发数
+    size_t m_workers = 1;
+    //! 读取的数据数
+    std::atomic_uint64_t m_in = 0;
+    //! 写出的数据数
+    std::atomic_uint64_t m_out = 0;
+    //! 处理函数的耗时
+    std::atomic_uint64_t m_busy_ns = 0;
+    //! 等待下游空间的时间
+    std::atomic_uint64_t m_blocked_ns = 0;
+    //! 输入channel的排队数
+    std::function<size_t()> m_queued;
+    //! 输入channel的容量
+    size_t m_capacity = 0;
+    //! 关闭输出channel
+    std::function<void()> m_close;
+    //! 阶段的协程
+    std::vector<std::function<Task<void>()>> m_tasks;
+    //! 未结束的协程数, 归0时关闭输出channel
+    std::atomic_size_t m_running = 0;
+
+    //! 处理函数耗时的采样间隔减1, 每16条计时一次, 读时钟的开销与处理函数相当
+    static constexpr uint64_t kSampleMask = 15;
+
+    /**
+     * @brief 是否对本条数据计时
+     * @param count 协程内的计数
+     * @return 需要计时返回开始时间, 否则为0
+     */
+    static uint64_t SampleStart(uint64_t& count)
+    {
+        return (count++ & kSampleMask) == 0 ? NowNs() : 0;
+    }
+
+    /**
+     * @brief 记录采样的耗时
+     * @param start SampleStart的返回值
+     */
+    void AddBusy(uint64_t start)
+    {
+        if (start != 0)
+        {
+            m_busy_ns.fetch_add((NowNs() - start) * (kSampleMask + 1), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 写出数据并记录等待下游的时间
+     * @return 等待器, co_await写入成功返回true
+     */
+    template <typename U>
+    auto Emit(BoundedChannel<U>& out, U value);
+};
+
+/**
+ * @brief 写出数据的等待器, 只在下游写满挂起时计时, 不创建协程
+ */
+template <typename U>
+class EmitAwaiter
+{
+public:
+    EmitAwaiter(BoundedChannel<U>& out, U value, StageState* stage)
+        : m_push(out, std::move(value))
+        , m_stage(stage)
+    {}
+
+    bool await_ready()
+    {
+        if (m_push.await_ready())
+        {
+            m_stage->m_out.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        m_start = NowNs();
+        return false;
+    }
+
+    template <typename H>
+    void await_suspend(H handle)
+    {
+        m_push.await_suspend(handle);
+    }
+
+    bool await_resume()
+    {
+        bool ok = m_push.await_resume();
+        if (m_start != 0)
+        {
+            m_stage->m_blocked_ns.fetch_add(NowNs() - m_start, std::memory_order_relaxed);
+            if (ok)
+            {
+                m_stage->m_out.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        return ok;
+    }
+
+private:
+    //! 写入的等待器
+    BoundedPushAwaiter<U> m_push;
+    //! 阶段
+    StageState* m_stage;
+    //! 开始等待的时间, 未挂起时为0
+    uint64_t m_start = 0;
+};
+
+template <typename U>
+auto StageState::Emit(BoundedChannel<U>& out, U value)
+{
+    return EmitAwaiter<U>(out, std::move(value), this);
+}
+
+template <typename T, typename U, typename F>
+Task<void> MapWorker(std::shared_ptr<BoundedChannel<T>> in, std::shared_ptr<BoundedChannel<U>> out, std::shared_ptr<F> fn, StageState* stage)
+{
+    T value;
+    uint64_t count = 0;
+    while (co_await in->Pop(value))
+    {
+        stage->m_in.fetch_add(1, std::memory_order_relaxed);
+        auto start = StageState::SampleStart(count);
+        U result = co_await Invoke(*fn, std::move(value));
+        stage->AddBusy(start);
+        if (!co_await stage->Emit(*out, std::move(result)))
+        {
+            break;
+        }
+    }
+}
+
+template <typename T, typename F>
+Task<void> FilterWorker(std::shared_ptr<BoundedChannel<T>> in, std::shared_ptr<BoundedChannel<T>> out, std::shared_ptr<F> pred, StageState* stage)
+{
+    T value;
+    uint64_t count = 0;
+    while (co_await in->Pop(value))
+    {
+        stage->m_in.fetch_add(1, std::memory_order_relaxed);
+        auto start = StageState::SampleStart(count);
+        bool keep = co_await Invoke(*pred, std::as_const(value));
+        stage->AddBusy(start);
+        if (!keep)
+        {
+            continue;
+        }
+        if (!co_await stage->Emit(*out, std::move(value)))
+        {
+            break;
+        }
+    }
+}
+
+template <typename T>
+Task<void> BatchWorker(std::shared_ptr<BoundedChannel<T>> in, std::shared_ptr<BoundedChannel<std::vector<T>>> out, size_t n, std::chrono::milliseconds timeout, StageState* stage)
+{
+    T value;
+    while (co_await in->Pop(value))
+    {
+        // 第一条数据到达后开始计时, 凑满n条或超时后输出
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::vector<T> batch;
+        batch.reserve(n);
+        batch.emplace_back(std::move(value));
+        while (batch.size() < n)
+        {
+            if (in->TryPop(value))
+            {
+                batch.emplace_back(std::move(value));
+                continue;
+            }
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0)
+            {
+                break;
+            }
+            if (!co_await in->PopFor(value, left))
+            {
+                break;
+            }
+            batch.emplace_back(std::move(value));
+        }
+        stage->m_in.fetch_add(batch.size(), std::memory_order_relaxed);
+        if (!co_await stage->Emit(*out, std::move(batch)))
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 保序ParallelMap的分发协程: 为每条数据创建一次性结果, 结果按输入顺序排队, 数据交给处理协程
+ */
+template <typename T, typename U>
+Task<void> OrderedDispatch(std::shared_ptr<BoundedChannel<T>> in, std::shared_ptr<BoundedChannel<std::pair<T, Oneshot<U>>>> work,
+                           std::shared_ptr<BoundedChannel<Future<U>>> order, StageState* stage)
+{
+    T value;
+    while (co_await in->Pop(value))
+    {
+        stage->m_in.fetch_add(1, std::memory_order_relaxed);
+        auto [sender, future] = MakeOneshot<U>();
+        if (!co_await order->Push(std::move(future)))
+        {
+            break;
+        }
+        if (!co_await work->Push(std::pair<T, Oneshot<U>>(std::move(value), std::move(sender))))
+        {
+            break;
+        }
+    }
+    work->Close();
+    order->Close();
+}
+
+template <typename T, typename U, typename F>
+Task<void> OrderedWorker(std::shared_ptr<BoundedChannel<std::pair<T, Oneshot<U>>>> work, std::shared_ptr<F> fn, StageState* stage)
+{
+    std::pair<T, Oneshot<U>> item;
+    uint64_t count = 0;
+    while (co_await work->Pop(item))
+    {
+        auto start = StageState::SampleStart(count);
+        try
+        {
+            U result = co_await Invoke(*fn, std::move(item.first));
+            stage->AddBusy(start);
+            item.second.Set(std::move(result));
+        }
+        catch (...)
+        {
+            // 异常交给输出协程, 保证流水线记录的是原始异常
+            item.second.SetException(std::current_exception());
+            throw;
+        }
+    }
+}
+
+/**
+ * @brief 保序ParallelMap的输出协程, 按输入顺序等待结果
+ */
+template <typename U>
+Task<void> OrderedEmit(std::shared_ptr<BoundedChannel<Future<U>>> order, std::shared_ptr<BoundedChannel<U>> out, StageState* stage)
+{
+    Future<U> future;
+    while (co_await order->Pop(future))
+    {
+        U result = co_await future;
+        if (!co_await stage->Emit(*out, std::move(result)))
+        {
+            break;
+        }
+    }
+}
+}  // namespace detail
+
+/**
+ * @brief 流水线中某个阶段的输出, 用于继续添加阶段
+ * @tparam T 数据类型, 需可默认构造与移动
+ */
+template <typename T>
+class Flow
+{
+public:
+    Flow(Pipeline* pipeline, std::shared_ptr<BoundedChannel<T>> chan)
+        : m_pipeline(pipeline)
+        , m_chan(std::move(chan))
+    {}
+
+    /**
+     * @brief 输出channel, Source的channel用于写入数据, 最后一个阶段的channel用于读取结果
+     * @return
+     */
+    const std::shared_ptr<BoundedChannel<T>>& GetChannel() const
+    {
+        return m_chan;
+    }
+
+    /**
+     * @brief 逐条转换
+     * @param fn 处理函数, U(T)或Task<U>(T)
+     * @param option 参数
+     * @return
+     */
+    template <typename F>
+    Flow<detail::InvokeResult<F, T&&>> Map(F fn, StageOption option = {});
+
+    /**
+     * @brief 过滤
+     * @param pred 谓词, bool(const T&)或Task<bool>(const T&), 返回false时丢弃
+     * @param option 参数
+     * @return
+     */
+    template <typename F>
+    Flow<T> Filter(F pred, StageOption option = {});
+
+    /**
+     * @brief 攒批, 凑满n条或第一条到达后超过timeout时输出一批
+     * @param n 每批的条数上限
+     * @param timeout 等待凑批的时间
+     * @param option 参数
+     * @return
+     */
+    Flow<std::vector<T>> Batch(size_t n, std::chrono::milliseconds timeout, StageOption option = {});
+
+    /**
+     * @brief k个协程并发转换, 设置m_pool时分散到线程池的各工作线程
+     * @param k 并发数
+     * @param fn 处理函数, 需可并发调用
+     * @param order 输出顺序, 保序时结果按输入顺序等待输出
+     * @param option 参数
+     * @return
+     */
+    template <typename F>
+    Flow<detail::InvokeResult<F, T&&>> ParallelMap(size_t k, F fn, MapOrder order = MapOrder::Ordered, StageOption option = {});
+
+private:
+    //! 流水线
+    Pipeline* m_pipeline = nullptr;
+    //! 输出channel
+    std::shared_ptr<BoundedChannel<T>> m_chan;
+};
+
+/**
+ * @brief 由有界channel连接的多阶段流水线: 每个阶段运行在指定的执行器或分散到线程池,
+ *        上游关闭后各阶段处理完剩余数据依次关闭输出; 任一阶段抛出异常时关闭所有channel,
+ *        Wait重新抛出第一个异常. 需在Wait返回后析构
+ */
+class Pipeline
+{
+public:
+    Pipeline() = default;
+    Pipeline(const Pipeline&) = delete;
+
+    /**
+     * @brief 创建输入channel
+     * @param capacity 容量
+     * @return
+     */
+    template <typename T>
+    Flow<T> Source(size_t capacity = 64)
+    {
+        return Flow<T>(this, MakeChannel<T>(capacity));
+    }
+
+    /**
+     * @brief 启动所有阶段, 需在exec所在线程调用; 指定了其他执行器的阶段经Executor::Post启动,
+     *        该执行器需在监听投递(线程池的工作线程, 或持有KeepAlive), 否则流水线以异常结束
+     * @param exec 未指定执行器的阶段运行的执行器, 为空时为当前执行器
+     * @return 已启动或需要执行器而未指定时返回false
+     */
+    bool Start(Executor* exec = nullptr);
+
+    /**
+     * @brief 等待所有阶段结束
+     * @return 有阶段抛出异常时重新抛出第一个异常
+     */
+    Task<void> Wait();
+
+    /**
+     * @brief 关闭所有channel, 各阶段处理完手中的数据后结束
+     */
+    void Cancel();
+
+    /**
+     * @brief 获取各阶段的统计
+     * @return
+     */
+    std::vector<StageStats> GetStats() const;
+
+private:
+    template <typename T>
+    friend class Flow;
+
+    /**
+     * @brief 创建channel, 取消时关闭
+     */
+    template <typename T>
+    std::shared_ptr<BoundedChannel<T>> MakeChannel(size_t capacity)
+    {
+        auto chan = std::make_shared<BoundedChannel<T>>(capacity);
+        m_closers.emplace_back([chan] { chan->Close(); });
+        return chan;
+    }
+
+    /**
+     * @brief 添加阶段
+     * @param kind 阶段类型, 用于命名
+     * @param option 参数
+     * @param in 输入channel
+     * @param out 输出channel
+     * @return
+     */
+    template <typename T, typename U>
+    detail::StageState& AddStage(const char* kind, const StageOption& option, const std::shared_ptr<BoundedChannel<T>>& in,
+                                 const std::shared_ptr<BoundedChannel<U>>& out)
+    {
+        auto stage = std::make_unique<detail::StageState>();
+        stage->m_name = option.m_name.empty() ? kind + std::to_string(m_stages.size()) : option.m_name;
+        stage->m_option = option;
+        stage->m_queued = [in] { return in->Size(); };
+        stage->m_capacity = in->Capacity();
+        stage->m_close = [out] { out->Close(); };
+        return *m_stages.emplace_back(std::move(stage));
+    }
+
+    /**
+     * @brief 记录第一个异常并取消
+     * @param e 异常
+     */
+    void Fail(std::exception_ptr e);
+
+    /**
+     * @brief 运行阶段的协程, 阶段的最后一个协程结束时关闭输出channel
+     */
+    static Task<void> RunWorker(Pipeline* pipeline, detail::StageState* stage, std::function<Task<void>()> body);
+
+    //! 阶段
+    std::vector<std::unique_ptr<detail::StageState>> m_stages;
+    //! 关闭各channel
+    std::vector<std::function<void()>> m_closers;
+    //! 等待所有协程结束
+    std::unique_ptr<Latch> m_latch;
+    //! 保护异常
+    std::mutex m_mut;
+    //! 第一个异常
+    std::exception_ptr m_error;
+};
+
+template <typename T>
+template <typename F>
+Flow<detail::InvokeResult<F, T&&>> Flow<T>::Map(F fn, StageOption option)
+{
+    using U = detail::InvokeResult<F, T&&>;
+    auto out = m_pipeline->MakeChannel<U>(option.m_capacity);
+    auto& stage = m_pipeline->AddStage("map", option, m_chan, out);
+    stage.m_tasks.emplace_back([in = m_chan, out, fn = std::make_shared<F>(std::move(fn)), st = &stage] { return detail::MapWorker<T, U, F>(in, out, fn, st); });
+    return Flow<U>(m_pipeline, out);
+}
+
+template <typename T>
+template <typename F>
+Flow<T> Flow<T>::Filter(F pred, StageOption option)
+{
+    static_assert(std::is_convertible_v<detail::InvokeResult<F, const T&>, bool>, "谓词需返回bool或Task<bool>");
+    auto out = m_pipeline->MakeChannel<T>(option.m_capacity);
+    auto& stage = m_pipeline->AddStage("filter", option, m_chan, out);
+    stage.m_tasks.emplace_back([in = m_chan, out, pred = std::make_shared<F>(std::move(pred)), st = &stage] { return detail::FilterWorker<T, F>(in, out, pred, st); });
+    return Flow<T>(m_pipeline, out);
+}
+
+template <typename T>
+Flow<std::vector<T>> Flow<T>::Batch(size_t n, std::chrono::milliseconds timeout, StageOption option)
+{
+    n = n == 0 ? 1 : n;
+    auto out = m_pipeline->MakeChannel<std::vector<T>>(option.m_capacity);
+    auto& stage = m_pipeline->AddStage("batch", option, m_chan, out);
+    stage.m_tasks.emplace_back([in = m_chan, out, n, timeout, st = &stage] { return detail::BatchWorker<T>(in, out, n, timeout, st); });
+    return Flow<std::vector<T>>(m_pipeline, out);
+}
+
+template <typename T>
+template <typename F>
+Flow<detail::InvokeResult<F, T&&>> Flow<T>::ParallelMap(size_t k, F fn, MapOrder order, StageOption option)
+{
+    using U = detail::InvokeResult<F, T&&>;
+    k = k == 0 ? 1 : k;
+    auto out = m_pipeline->MakeChannel<U>(option.m_capacity);
+    auto& stage = m_pipeline->AddStage(order == MapOrder::Ordered ? "ordered_map" : "parallel_map", option, m_chan, out);
+    stage.m_workers = k;
+    auto func = std::make_shared<F>(std::move(fn));
+    if (order == MapOrder::Unordered)
+    {
+        for (size_t i = 0; i < k; i++)
+        {
+            stage.m_tasks.emplace_back([in = m_chan, out, func, st = &stage] { return detail::MapWorker<T, U, F>(in, out, func, st); });
+        }
+        return Flow<U>(m_pipeline, out);
+    }
+    // 排队的结果数即乱序完成时需要暂存的上限
+    auto work = m_pipeline->MakeChannel<std::pair<T, Oneshot<U>>>(k);
+    auto pending = m_pipeline->MakeChannel<Future<U>>(option.m_capacity);
+    stage.m_tasks.emplace_back([in = m_chan, work, pending, st = &stage] { return detail::OrderedDispatch<T, U>(in, work, pending, st); });
+    for (size_t i = 0; i < k; i++)
+    {
+        stage.m_tasks.emplace_back([work, func, st = &stage] { return detail::OrderedWorker<T, U, F>(work, func, st); });
+    }
+    stage.m_tasks.emplace_back([pending, out, st = &stage] { return detail::OrderedEmit<U>(pending, out, st); });
+    return Flow<U>(m_pipeline, out);
+}
+
+}  // namespace coro
+
+#endif  // CORO_PIPELINE_H
@@ -0,0 +1,113 @@
+#ifndef CORO_PRIORITY_H
+#define CORO_PRIORITY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace coro
+{
+/**
+ * @brief 任务优先级, 数值越小越优先
+ */
+enum class Priority : uint8_t
+{
+    //! 延迟敏感的任务
+    High = 0,
+    //! 默认
+    Normal = 1,
+    //! 后台批处理任务
+    Background = 2,
+};
+
+//! 优先级数量
+constexpr size_t kPriorityCount = 3;
+
+/**
+ * @brief 多级队列, 优先取出高优先级元素;
+ *        低优先级队列连续被跳过m_starve_limit次后取出一次, 防止饿死
+ * @tparam T 元素类型
+ */
+template <typename T>
+class PriorityQueue
+{
+public:
+    PriorityQueue() = default;
+    explicit PriorityQueue(size_t starve_limit)
+        : m_starve_limit(starve_limit)
+    {}
+
+    /**
+     * @brief 添加元素
+     * @param t 元素
+     * @param priority 优先级
+     */
+    void Push(T t, Priority priority)
+    {
+        m_queue[static_cast<size_t>(priority)].emplace_back(std::move(t));
+        m_size++;
+    }
+
+    /**
+     * @brief 取出元素
+     * @return 队列为空返回std::nullopt
+     */
+    std::optional<T> Pop()
+    {
+        if (m_size == 0)
+        {
+            return std::nullopt;
+        }
+
+        size_t level = kPriorityCount;
+        for (size_t i = 0; i < kPriorityCount; i++)
+        {
+            if (m_queue[i].empty())
+            {
+                continue;
+            }
+            if (level == kPriorityCount)
+            {
+                level = i;
+            }
+            else if (m_skip[i]++ >= m_starve_limit && m_skip[level] < m_starve_limit)
+            {
+                level = i;
+            }
+        }
+
+        m_skip[level] = 0;
+        auto t = std::move(m_queue[level].front());
+        m_queue[level].pop_front();
+        m_size--;
+        return t;
+    }
+
+    /**
+     * @brief 获取元素数量
+     * @return
+     */
+    size_t Size() const { return m_size; }
+
+    /**
+     * @brief 是否为空
+     * @return
+     */
+    bool Empty() const { return m_size == 0; }
+
+private:
+    //! 各优先级的队列
+    std::array<std::deque<T>, kPriorityCount> m_queue;
+    //! 各优先级连续被跳过的次数
+    std::array<size_t, kPriorityCount> m_skip{};
+    //! 被跳过多少次后强制取出
+    size_t m_starve_limit = 16;
+    //! 元素数量
+    size_t m_size = 0;
+};
+
+}  // namespace coro
+
+#endif  // CORO_PRIORITY_H
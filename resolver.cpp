@@ -0,0 +1,374 @@
+#include "resolver.h"
+#include <arpa/inet.h>
+#include <event2/dns.h>
+#include <event2/util.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace coro
+{
+namespace
+{
+/**
+ * @brief 解析数字地址
+ * @param host 地址
+ * @param family 地址族
+ * @param addr 结果
+ * @return 是数字地址返回true
+ */
+bool ParseNumeric(const std::string& host, int family, sockaddr_storage& addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    if (family != AF_INET6)
+    {
+        auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+        if (evutil_inet_pton(AF_INET, host.c_str(), &in->sin_addr) == 1)
+        {
+            in->sin_family = AF_INET;
+            return true;
+        }
+    }
+    if (family != AF_INET)
+    {
+        auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);
+        if (evutil_inet_pton(AF_INET6, host.c_str(), &in6->sin6_addr) == 1)
+        {
+            in6->sin6_family = AF_INET6;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 统一域名的大小写与末尾的点
+ * @param host 域名
+ */
+void Normalize(std::string& host)
+{
+    std::transform(host.begin(), host.end(), host.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (!host.empty() && host.back() == '.')
+    {
+        host.pop_back();
+    }
+}
+
+std::string MakeKey(int family, const std::string& host)
+{
+    return std::to_string(family) + ":" + host;
+}
+}  // namespace
+
+ResolveAwaiter::~ResolveAwaiter()
+{
+    if (m_resolver)
+    {
+        // 协程在等待期间被销毁, 查询继续进行并写入缓存
+        m_resolver->Remove(this);
+    }
+}
+
+void ResolveAwaiter::Handle()
+{
+    m_resolver = &GetExecutor()->GetResolver();
+    if (m_resolver->Start(this))
+    {
+        m_resolver = nullptr;
+        Resume();
+    }
+}
+
+Resolver::Resolver(event_base* base)
+    : m_base(base)
+{}
+
+Resolver::~Resolver()
+{
+    if (m_dns)
+    {
+        // 不回调未完成的查询, 等待的协程已随执行器销毁
+        evdns_base_free(m_dns, 0);
+    }
+}
+
+bool Resolver::SetOption(const ResolverOption& option)
+{
+    if (!m_lookups.empty())
+    {
+        return false;
+    }
+    if (m_dns)
+    {
+        evdns_base_free(m_dns, 0);
+        m_dns = nullptr;
+    }
+    m_option = option;
+    m_hosts_loaded = false;
+    m_hosts.clear();
+    m_cache.clear();
+    return true;
+}
+
+void Resolver::ClearCache()
+{
+    m_cache.clear();
+}
+
+ResolverStats Resolver::GetStats() const
+{
+    return m_stats;
+}
+
+bool Resolver::Start(ResolveAwaiter* awaiter)
+{
+    auto& host = awaiter->m_host;
+    auto& result = awaiter->m_result;
+    sockaddr_storage addr{};
+    if (ParseNumeric(host, awaiter->m_family, addr))
+    {
+        result.m_addrs.emplace_back(addr);
+        return true;
+    }
+    Normalize(host);
+    if (!m_hosts_loaded)
+    {
+        LoadHosts();
+    }
+    if (auto it = m_hosts.find(host); it != m_hosts.end())
+    {
+        for (auto& item : it->second)
+        {
+            if (awaiter->m_family == AF_UNSPEC || awaiter->m_family == item.ss_family)
+            {
+                result.m_addrs.emplace_back(item);
+            }
+        }
+        if (!result.m_addrs.empty())
+        {
+            return true;
+        }
+    }
+
+    auto key = MakeKey(awaiter->m_family, host);
+    if (auto it = m_cache.find(key); it != m_cache.end())
+    {
+        if (it->second.m_expire > std::chrono::steady_clock::now())
+        {
+            m_stats.m_cache_hit++;
+            result.m_addrs = it->second.m_addrs;
+            return true;
+        }
+        m_cache.erase(it);
+    }
+    if (auto it = m_lookups.find(key); it != m_lookups.end())
+    {
+        m_stats.m_coalesced++;
+        it->second->m_waiters.emplace_back(awaiter);
+        return false;
+    }
+    if (!Init())
+    {
+        result.m_error = DNS_ERR_UNKNOWN;
+        return true;
+    }
+
+    m_stats.m_lookup++;
+    auto& lookup = m_lookups[key];
+    lookup = std::make_unique<Lookup>();
+    lookup->m_resolver = this;
+    lookup->m_key = key;
+    lookup->m_waiters.emplace_back(awaiter);
+    auto* ptr = lookup.get();
+    if (awaiter->m_family != AF_INET6)
+    {
+        ptr->m_pending++;
+        if (!evdns_base_resolve_ipv4(m_dns, host.c_str(), 0, OnResolve, ptr))
+        {
+            ptr->m_pending--;
+            ptr->m_error = DNS_ERR_UNKNOWN;
+        }
+    }
+    if (awaiter->m_family != AF_INET)
+    {
+        ptr->m_pending++;
+        if (!evdns_base_resolve_ipv6(m_dns, host.c_str(), 0, OnResolve, ptr))
+        {
+            ptr->m_pending--;
+            ptr->m_error = ptr->m_error ? ptr->m_error : DNS_ERR_UNKNOWN;
+        }
+    }
+    if (ptr->m_pending == 0)
+    {
+        // 查询未能发出
+        result.m_error = ptr->m_error;
+        m_lookups.erase(key);
+        return true;
+    }
+    return false;
+}
+
+void Resolver::Remove(ResolveAwaiter* awaiter)
+{
+    if (auto it = m_lookups.find(MakeKey(awaiter->m_family, awaiter->m_host)); it != m_lookups.end())
+    {
+        it->second->m_waiters.remove(awaiter);
+    }
+}
+
+bool Resolver::Init()
+{
+    if (m_dns)
+    {
+        return true;
+    }
+    // 没有查询时不监听域名服务器的socket, 使事件循环能够退出
+    m_dns = evdns_base_new(m_base, EVDNS_BASE_DISABLE_WHEN_INACTIVE);
+    if (!m_dns)
+    {
+        return false;
+    }
+    if (m_option.m_nameservers.empty())
+    {
+        evdns_base_resolv_conf_parse(m_dns, DNS_OPTIONS_ALL, "/etc/resolv.conf");
+    }
+    for (auto& ns : m_option.m_nameservers)
+    {
+        if (evdns_base_nameserver_ip_add(m_dns, ns.c_str()) != 0)
+        {
+            evdns_base_free(m_dns, 0);
+            m_dns = nullptr;
+            return false;
+        }
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(m_option.m_timeout.count()) / 1000);
+    evdns_base_set_option(m_dns, "timeout:", buf);
+    evdns_base_set_option(m_dns, "attempts:", std::to_string(m_option.m_attempts).c_str());
+    return true;
+}
+
+void Resolver::LoadHosts()
+{
+    m_hosts_loaded = true;
+    if (m_option.m_hosts_path.empty())
+    {
+        return;
+    }
+    std::ifstream in(m_option.m_hosts_path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        std::string ip;
+        std::string name;
+        sockaddr_storage addr{};
+        if (!(ss >> ip) || !ParseNumeric(ip, AF_UNSPEC, addr))
+        {
+            continue;
+        }
+        while (ss >> name)
+        {
+            Normalize(name);
+            m_hosts[name].emplace_back(addr);
+        }
+    }
+}
+
+void Resolver::OnResolve(int result, char type, int count, int ttl, void* addresses, void* arg)
+{
+    auto* lookup = static_cast<Lookup*>(arg);
+    lookup->m_pending--;
+    if (result == DNS_ERR_NONE)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            sockaddr_storage addr{};
+            if (type == DNS_IPv4_A)
+            {
+                auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+                in->sin_family = AF_INET;
+                memcpy(&in->sin_addr, static_cast<in_addr*>(addresses) + i, sizeof(in_addr));
+            }
+            else if (type == DNS_IPv6_AAAA)
+            {
+                auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);
+                in6->sin6_family = AF_INET6;
+                memcpy(&in6->sin6_addr, static_cast<in6_addr*>(addresses) + i, sizeof(in6_addr));
+            }
+            else
+            {
+                continue;
+            }
+            lookup->m_addrs.emplace_back(addr);
+        }
+        lookup->m_ttl = lookup->m_ttl < 0 ? ttl : std::min(lookup->m_ttl, ttl);
+    }
+    else if (lookup->m_error == 0)
+    {
+        lookup->m_error = result;
+    }
+    if (lookup->m_pending == 0)
+    {
+        lookup->m_resolver->Finish(lookup);
+    }
+}
+
+void Resolver::Finish(Lookup* lookup)
+{
+    ResolveResult result;
+    if (lookup->m_addrs.empty())
+    {
+        result.m_error = lookup->m_error ? lookup->m_error : DNS_ERR_NODATA;
+    }
+    else
+    {
+        result.m_addrs = std::move(lookup->m_addrs);
+        auto ttl = std::min<std::chrono::seconds>(std::chrono::seconds(lookup->m_ttl), m_option.m_max_ttl);
+        if (ttl.count() > 0)
+        {
+            if (m_cache.size() >= m_option.m_max_cache)
+            {
+                auto now = std::chrono::steady_clock::now();
+                std::erase_if(m_cache, [&](auto& item) { return item.second.m_expire <= now; });
+            }
+            if (m_cache.size() >= m_option.m_max_cache && !m_cache.empty())
+            {
+                m_cache.erase(m_cache.begin());
+            }
+            m_cache[lookup->m_key] = CacheEntry{.m_addrs = result.m_addrs, .m_expire = std::chrono::steady_clock::now() + ttl};
+        }
+    }
+    // 逐个取出再唤醒, 唤醒期间查询仍可被Remove找到, 被唤醒者销毁其他等待者时不会留下失效的指针
+    while (!lookup->m_waiters.empty())
+    {
+        auto* waiter = lookup->m_waiters.front();
+        lookup->m_waiters.pop_front();
+        waiter->m_result = result;
+        waiter->m_resolver = nullptr;
+        waiter->Resume();
+    }
+    m_lookups.erase(m_lookups.find(lookup->m_key));
+}
+
+Task<ResolveResult> Resolve(std::string host, uint16_t port, int family)
+{
+    auto result = co_await ResolveAwaiter(std::move(host), family);
+    for (auto& addr : result.m_addrs)
+    {
+        if (addr.ss_family == AF_INET)
+        {
+            reinterpret_cast<sockaddr_in*>(&addr)->sin_port = htons(port);
+        }
+        else
+        {
+            reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port = htons(port);
+        }
+    }
+    co_return result;
+}
+
+}  // namespace coro
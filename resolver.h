@@ -0,0 +1,230 @@
+#ifndef CORO_RESOLVER_H
+#define CORO_RESOLVER_H
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "awaiter.h"
+#include "task.h"
+
+struct evdns_base;
+
+namespace coro
+{
+/**
+ * @brief 域名解析参数
+ */
+struct ResolverOption
+{
+    //! 域名服务器, 格式为ip或ip:port, 为空时读取/etc/resolv.conf
+    std::vector<std::string> m_nameservers;
+    //! hosts文件, 为空时不读取
+    std::string m_hosts_path = "/etc/hosts";
+    //! 单次查询的超时
+    std::chrono::milliseconds m_timeout{5000};
+    //! 查询的尝试次数
+    int m_attempts = 2;
+    //! 缓存时间的上限, 记录的TTL超出时截断
+    std::chrono::seconds m_max_ttl{300};
+    //! 缓存的域名数上限
+    size_t m_max_cache = 4096;
+};
+
+/**
+ * @brief 域名解析结果
+ */
+struct ResolveResult
+{
+    //! 错误码, 成功为0, 失败为DNS_ERR_*, 可用evdns_err_to_string转换
+    int m_error = 0;
+    //! 地址, 端口已设置
+    std::vector<sockaddr_storage> m_addrs;
+};
+
+/**
+ * @brief 解析器的统计
+ */
+struct ResolverStats
+{
+    //! 命中缓存的次数
+    uint64_t m_cache_hit = 0;
+    //! 发出的查询次数
+    uint64_t m_lookup = 0;
+    //! 合并到进行中查询的次数
+    uint64_t m_coalesced = 0;
+};
+
+class Resolver;
+
+/**
+ * @brief 域名解析的等待器
+ */
+class ResolveAwaiter : public BaseAwaiter
+{
+public:
+    ResolveAwaiter(std::string host, int family)
+        : m_host(std::move(host))
+        , m_family(family)
+    {}
+    ~ResolveAwaiter() override;
+
+    /**
+     * @brief 查询缓存或发起查询, 已有相同的查询时合并等待
+     */
+    void Handle() override;
+
+    ResolveResult await_resume()
+    {
+        return std::move(m_result);
+    }
+
+private:
+    friend class Resolver;
+
+    //! 域名
+    std::string m_host;
+    //! 地址族
+    int m_family = AF_UNSPEC;
+    //! 结果
+    ResolveResult m_result;
+    //! 等待的解析器, 完成后为空
+    Resolver* m_resolver = nullptr;
+};
+
+/**
+ * @brief 异步域名解析器, 每个执行器一个, 只在执行器所在线程使用;
+ *        按记录的TTL缓存结果, 同一域名的并发查询合并为一次
+ */
+class Resolver
+{
+public:
+    Resolver(const Resolver&) = delete;
+    /**
+     * @brief 构造解析器
+     * @param base 事件循环
+     */
+    explicit Resolver(event_base* base);
+    ~Resolver();
+
+    /**
+     * @brief 设置参数, 需在没有进行中的查询时调用, 同时清空缓存
+     * @param option 参数
+     * @return 成功返回true
+     */
+    bool SetOption(const ResolverOption& option);
+
+    /**
+     * @brief 清空缓存
+     */
+    void ClearCache();
+
+    /**
+     * @brief 获取统计
+     * @return
+     */
+    ResolverStats GetStats() const;
+
+private:
+    friend class ResolveAwaiter;
+
+    /**
+     * @brief 缓存的地址
+     */
+    struct CacheEntry
+    {
+        //! 地址, 端口为0
+        std::vector<sockaddr_storage> m_addrs;
+        //! 过期时间
+        std::chrono::steady_clock::time_point m_expire;
+    };
+
+    /**
+     * @brief 进行中的查询, A与AAAA查询共用
+     */
+    struct Lookup
+    {
+        //! 解析器
+        Resolver* m_resolver = nullptr;
+        //! 缓存键
+        std::string m_key;
+        //! 未完成的查询数
+        int m_pending = 0;
+        //! 第一个失败查询的错误码
+        int m_error = 0;
+        //! 所有记录的最小TTL
+        int m_ttl = -1;
+        //! 地址
+        std::vector<sockaddr_storage> m_addrs;
+        //! 等待的协程
+        std::list<ResolveAwaiter*> m_waiters;
+    };
+
+    /**
+     * @brief 开始解析, 能立即得到结果时返回true
+     * @param awaiter 等待器
+     */
+    bool Start(ResolveAwaiter* awaiter);
+
+    /**
+     * @brief 撤销等待
+     * @param awaiter 等待器
+     */
+    void Remove(ResolveAwaiter* awaiter);
+
+    /**
+     * @brief 确保evdns_base已创建
+     * @return 成功返回true
+     */
+    bool Init();
+
+    /**
+     * @brief 读取hosts文件
+     */
+    void LoadHosts();
+
+    /**
+     * @brief 查询完成的回调
+     */
+    static void OnResolve(int result, char type, int count, int ttl, void* addresses, void* arg);
+
+    /**
+     * @brief 所有查询完成, 写入缓存并唤醒等待的协程
+     * @param lookup 查询
+     */
+    void Finish(Lookup* lookup);
+
+    //! 事件循环
+    event_base* m_base = nullptr;
+    //! 参数
+    ResolverOption m_option;
+    //! evdns, 首次查询时创建
+    evdns_base* m_dns = nullptr;
+    //! 是否已读取hosts文件
+    bool m_hosts_loaded = false;
+    //! hosts文件中的地址
+    std::unordered_map<std::string, std::vector<sockaddr_storage>> m_hosts;
+    //! 缓存, 键为地址族与域名
+    std::unordered_map<std::string, CacheEntry> m_cache;
+    //! 进行中的查询
+    std::unordered_map<std::string, std::unique_ptr<Lookup>> m_lookups;
+    //! 统计
+    ResolverStats m_stats;
+};
+
+/**
+ * @brief 异步解析域名, 不阻塞事件循环, 数字地址与hosts文件中的域名直接返回
+ * @param host 域名
+ * @param port 端口, 写入结果的每个地址
+ * @param family 地址族, AF_UNSPEC时同时查询A与AAAA记录
+ * @return
+ */
+Task<ResolveResult> Resolve(std::string host, uint16_t port, int family = AF_UNSPEC);
+
+}  // namespace coro
+
+#endif  // CORO_RESOLVER_H
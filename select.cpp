@@ -1,38 +1,42 @@
 #include "select.h"
 
-#include <utility>
+#include <algorithm>
 
 namespace coro
 {
-MultiEventfd::MultiEventfd(std::vector<int32_t> fd_vect)
-    : m_fd(std::move(fd_vect))
-{}
+SelectAwaiterBase::~SelectAwaiterBase()
+{
+    std::for_each(m_events.begin(), m_events.end(), [](event* e){ event_free(e); });
+}
 
-MultiEventfd::~MultiEventfd()
+void SelectAwaiterBase::Park()
 {
-    std::for_each(m_ev.begin(), m_ev.end(), [](event* e){ event_free(e); });
+    m_node = detail::MakeWaitNode(this, GetExecutor());
 }
 
-void MultiEventfd::Handle()
+void SelectAwaiterBase::WatchFd(int32_t fd)
 {
-    for (auto& fd : m_fd)
-    {
-        auto ev = event_new(EventBase(), fd, EV_READ, OnRead, this);
-        event_add(ev, nullptr);
-        m_ev.emplace_back(ev);
-    }
+    auto ev = event_new(EventBase(), fd, EV_READ, OnRead, this);
+    event_add(ev, nullptr);
+    m_events.emplace_back(ev);
 }
 
-void MultiEventfd::OnRead(int fd, short, void* arg)
+void SelectAwaiterBase::Finish()
 {
-    auto pthis = static_cast<MultiEventfd*>(arg);
+    std::for_each(m_events.begin(), m_events.end(), [](event* e){ event_del(e); });
+    detail::Abandon(m_node);
+}
+
+void SelectAwaiterBase::OnRead(int fd, short, void* arg)
+{
+    auto pthis = static_cast<SelectAwaiterBase*>(arg);
     eventfd_t val = 0;
     eventfd_read(fd, &val);
-    for (auto& ev : pthis->m_ev)
+    for (auto& ev : pthis->m_events)
     {
         event_del(ev);
     }
-    pthis->Resume();
+    detail::Wake(pthis->m_node);
 }
 
-}
\ No newline at end of file
+}
@@ -1,23 +1,122 @@
 #ifndef CORO_SELECT_H
 #define CORO_SELECT_H
 
+#include <tuple>
 #include "channel.h"
 
 namespace coro
 {
+/**
+ * @brief Select等待器中与channel类型无关的部分
+ */
+class SelectAwaiterBase : public WaitAwaiter
+{
+public:
+    ~SelectAwaiterBase() override;
+
+protected:
+    /**
+     * @brief 创建等待者
+     */
+    void Park();
+
+    /**
+     * @brief 通过event fd等待没有Watch接口的channel
+     * @param fd event fd
+     */
+    void WatchFd(int32_t fd);
+
+    /**
+     * @brief 释放fd事件并撤销等待, 需先从所有channel撤销登记
+     */
+    void Finish();
+
+    //! 等待者, 同时登记在所有channel上, 只唤醒一次
+    std::shared_ptr<detail::WaitNode> m_node;
 
-class MultiEventfd : public BaseAwaiter
+private:
+    /**
+     * @brief event fd可读回调
+     * @param arg this指针
+     */
+    static void OnRead(evutil_socket_t fd, short, void* arg);
+
+    //! fd事件
+    std::vector<event*> m_events;
+};
+
+/**
+ * @brief 等待任意一个channel可读或关闭
+ * @tparam CHANNEL channel类型
+ */
+template <typename... CHANNEL>
+class SelectAwaiter : public SelectAwaiterBase
 {
 public:
-    explicit MultiEventfd(std::vector<int32_t> fd_vect);
-    ~MultiEventfd() override;
-    void Handle() override;
+    explicit SelectAwaiter(CHANNEL&... chan)
+        : m_chan(chan...)
+    {}
+
+    ~SelectAwaiter() override
+    {
+        if (m_node)
+        {
+            std::apply([this](auto&... chan) { (Unwatch(chan), ...); }, m_chan);
+            Finish();
+        }
+    }
+
+    /**
+     * @brief 在每个channel上登记, 登记时已可读或全部关闭则立即唤醒;
+     *        已关闭的channel不再唤醒, 避免Select在其余channel无数据时空转
+     */
+    void Handle() override
+    {
+        Park();
+        std::apply([this](auto&... chan) {
+            (Watch(chan), ...);
+            if ((... && chan.IsClose()))
+            {
+                detail::Wake(m_node);
+            }
+        }, m_chan);
+    }
+
 private:
-    static void OnRead(evutil_socket_t, short, void* arg);
-    std::vector<int32_t> m_fd;
-    std::vector<event*> m_ev;
+    template <typename C>
+    void Watch(C& chan)
+    {
+        if constexpr (requires { chan.Watch(m_node); })
+        {
+            if (!chan.Watch(m_node))
+            {
+                detail::Wake(m_node);
+            }
+        }
+        else
+        {
+            WatchFd(chan.GetEventfd());
+        }
+    }
+
+    template <typename C>
+    void Unwatch(C& chan)
+    {
+        if constexpr (requires { chan.Unwatch(m_node); })
+        {
+            chan.Unwatch(m_node);
+        }
+    }
+
+    //! channel
+    std::tuple<CHANNEL&...> m_chan;
 };
 
+/**
+ * @brief 等待任意一个channel有数据
+ * @param chan channel
+ * @return 所有channel都关闭时返回false
+ */
 template <typename... CHANNEL>
 coro::Task<bool> Select(CHANNEL&&... chan)
 {
@@ -25,7 +124,7 @@ coro::Task<bool> Select(CHANNEL&&... chan)
     {
         co_return true;
     }
-    co_await MultiEventfd({chan.GetEventfd()...});
+    co_await SelectAwaiter<std::remove_reference_t<CHANNEL>...>(chan...);
     co_return !(... && chan.IsClose());
 }
 
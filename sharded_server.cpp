@@ -0,0 +1,219 @@
+#include "sharded_server.h"
+#include <event2/util.h>
+#include <linux/filter.h>
+#include <unistd.h>
+#include <cerrno>
+#include <iterator>
+#include "io.h"
+#include "sleep.h"
+
+namespace coro
+{
+//! 每次连续accept的上限, 超出后让出事件循环给已有的连接
+static constexpr size_t kAcceptBudget = 64;
+
+ShardedServer::ShardedServer(ThreadPool& pool, Handler handler, const ShardedServerOption& option)
+    : m_pool(pool)
+    , m_handler(std::move(handler))
+    , m_option(option)
+{}
+
+ShardedServer::~ShardedServer()
+{
+    Stop();
+}
+
+int ShardedServer::Start()
+{
+    if (!m_shards.empty())
+    {
+        return -EALREADY;
+    }
+    sockaddr_storage addr{};
+    socklen_t len = 0;
+    auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+    auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);
+    if (evutil_inet_pton(AF_INET, m_option.m_addr.c_str(), &in->sin_addr) == 1)
+    {
+        in->sin_family = AF_INET;
+        in->sin_port = htons(m_option.m_port);
+        len = sizeof(sockaddr_in);
+    }
+    else if (evutil_inet_pton(AF_INET6, m_option.m_addr.c_str(), &in6->sin6_addr) == 1)
+    {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(m_option.m_port);
+        len = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        return -EINVAL;
+    }
+
+    auto num = m_pool.GetWorkerCount();
+    for (size_t i = 0; i < num; i++)
+    {
+        int fd = Listen(addr, len);
+        if (fd < 0)
+        {
+            CloseShards();
+            return fd;
+        }
+        m_shards.emplace_back(std::make_unique<Shard>())->m_fd = fd;
+        if (i == 0)
+        {
+            // 端口为0时, 其余分片绑定到第一个分片分配到的端口
+            socklen_t bound_len = sizeof(addr);
+            getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &bound_len);
+        }
+    }
+    m_port = ntohs(addr.ss_family == AF_INET ? in->sin_port : in6->sin6_port);
+    if (m_option.m_cpu_steering)
+    {
+        if (auto ret = AttachSteering(m_shards.front()->m_fd); ret < 0)
+        {
+            CloseShards();
+            return ret;
+        }
+    }
+
+    for (size_t i = 0; i < m_shards.size(); i++)
+    {
+        auto* shard = m_shards[i].get();
+        auto [sender, future] = MakeOneshot<void>();
+        shard->m_done = std::move(future);
+        // std::function要求可复制, 发送端共享; 任务未执行时接收端得到broken_promise
+        auto shared = std::make_shared<Oneshot<void>>(std::move(sender));
+        m_pool.AddTo(i, [this, shard, shared]() -> Task<void> {
+            co_await AcceptLoop(shard);
+            shared->Set();
+        });
+    }
+    return 0;
+}
+
+void ShardedServer::Stop()
+{
+    if (m_stop.exchange(true))
+    {
+        return;
+    }
+    // 关闭读端使监听socket离开reuseport组, 并唤醒等待可读的accept循环
+    for (auto& shard : m_shards)
+    {
+        shutdown(shard->m_fd, SHUT_RD);
+    }
+    for (auto& shard : m_shards)
+    {
+        try
+        {
+            shard->m_done.Get();
+        }
+        catch (const std::future_error&)
+        {
+            // 线程池已关闭, accept循环未执行或已被销毁
+        }
+    }
+    CloseShards();
+    // accept循环都已结束, 复位后可再次启动
+    m_stop = false;
+}
+
+uint16_t ShardedServer::GetPort() const
+{
+    return m_port;
+}
+
+std::vector<uint64_t> ShardedServer::GetAcceptCounts() const
+{
+    std::vector<uint64_t> counts;
+    counts.reserve(m_shards.size());
+    for (auto& shard : m_shards)
+    {
+        counts.emplace_back(shard->m_accepted.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
+
+int ShardedServer::Listen(const sockaddr_storage& addr, socklen_t len)
+{
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    int on = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        bind(fd, reinterpret_cast<const sockaddr*>(&addr), len) != 0 || listen(fd, m_option.m_backlog) != 0)
+    {
+        int err = errno;
+        close(fd);
+        return -err;
+    }
+    return fd;
+}
+
+int ShardedServer::AttachSteering(int fd)
+{
+    // A = 当前CPU; A %= 分片数; 返回A作为组内socket的下标
+    sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(m_shards.size())},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    sock_fprog prog{.len = static_cast<unsigned short>(std::size(code)), .filter = code};
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) != 0)
+    {
+        return -errno;
+    }
+    return 0;
+}
+
+Task<void> ShardedServer::AcceptLoop(Shard* shard)
+{
+    auto* exec = Executor::Current();
+    IoAwaiter readable(shard->m_fd, EV_READ);
+    size_t budget = 0;
+    while (!m_stop)
+    {
+        int fd = accept4(shard->m_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0)
+        {
+            shard->m_accepted.fetch_add(1, std::memory_order_relaxed);
+            // 处理函数随任务复制, 连接可比服务存活更久
+            exec->RunTask([handler = m_handler, fd] { return handler(fd); });
+            if (++budget < kAcceptBudget)
+            {
+                continue;
+            }
+        }
+        else if (errno == EINTR || errno == ECONNABORTED)
+        {
+            continue;
+        }
+        else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM)
+        {
+            // 资源耗尽时监听socket持续可读, 暂停一段时间避免空转
+            co_await Sleep(0, 100);
+            continue;
+        }
+        else if (errno != EAGAIN)
+        {
+            // 停止后accept返回EINVAL
+            break;
+        }
+        budget = 0;
+        co_await readable;
+    }
+}
+
+void ShardedServer::CloseShards()
+{
+    for (auto& shard : m_shards)
+    {
+        close(shard->m_fd);
+    }
+    m_shards.clear();
+}
+
+}  // namespace coro
@@ -0,0 +1,134 @@
+#ifndef CORO_SHARDED_SERVER_H
+#define CORO_SHARDED_SERVER_H
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "future.h"
+#include "thread_pool.h"
+
+namespace coro
+{
+/**
+ * @brief 分片监听参数
+ */
+struct ShardedServerOption
+{
+    //! 监听地址, ipv4或ipv6
+    std::string m_addr = "0.0.0.0";
+    //! 端口, 为0时由系统分配, 所有分片共用
+    uint16_t m_port = 0;
+    //! 每个分片的全连接队列长度
+    int m_backlog = 1024;
+    //! 是否按收到连接的CPU选择分片(SO_ATTACH_REUSEPORT_CBPF), 第i个分片接收CPU i % 分片数上的连接;
+    //! 需网卡队列中断与工作线程绑定到对应的CPU才能使连接全程在同一CPU处理, 否则按四元组哈希分配
+    bool m_cpu_steering = false;
+};
+
+/**
+ * @brief 分片监听的TCP服务, 线程池的每个工作线程一个SO_REUSEPORT监听socket,
+ *        由内核将新连接分散到各分片; 每个分片的accept循环运行在对应工作线程的执行器上,
+ *        连接的处理协程在接收它的线程上启动, 不经过线程池的任务队列
+ */
+class ShardedServer
+{
+public:
+    /**
+     * @brief 连接的处理函数, 参数为非阻塞的连接fd, 由处理函数负责关闭
+     */
+    using Handler = std::function<Task<void>(int fd)>;
+
+    ShardedServer(const ShardedServer&) = delete;
+    /**
+     * @brief 构造服务
+     * @param pool 线程池, 线程数固定时每个分片始终在同一线程; 需在服务停止后关闭
+     * @param handler 连接的处理函数, 在接收连接的工作线程上调用
+     * @param option 参数
+     */
+    ShardedServer(ThreadPool& pool, Handler handler, const ShardedServerOption& option = {});
+    ~ShardedServer();
+
+    /**
+     * @brief 按当前的工作线程数创建监听socket并启动accept循环
+     * @return 成功返回0, 失败返回-errno, 已启动返回-EALREADY
+     */
+    int Start();
+
+    /**
+     * @brief 停止接收新连接并等待accept循环结束, 已建立的连接不受影响, 之后可再次Start; 不能在线程池内调用
+     */
+    void Stop();
+
+    /**
+     * @brief 获取监听的端口
+     * @return
+     */
+    uint16_t GetPort() const;
+
+    /**
+     * @brief 获取各分片接收的连接数, 可在任意线程读取
+     * @return
+     */
+    std::vector<uint64_t> GetAcceptCounts() const;
+
+private:
+    /**
+     * @brief 监听分片
+     */
+    struct Shard
+    {
+        //! 监听socket
+        int m_fd = -1;
+        //! 接收的连接数
+        std::atomic_uint64_t m_accepted = 0;
+        //! accept循环结束的通知
+        Future<void> m_done;
+    };
+
+    /**
+     * @brief 创建绑定到同一端口的监听socket
+     * @param addr 地址
+     * @param len 地址长度
+     * @return 成功返回fd, 失败返回-errno
+     */
+    int Listen(const sockaddr_storage& addr, socklen_t len);
+
+    /**
+     * @brief 按CPU选择分片的CBPF程序, 附加到任一socket即对整组生效
+     * @param fd 监听socket
+     * @return 成功返回0, 失败返回-errno
+     */
+    int AttachSteering(int fd);
+
+    /**
+     * @brief 分片的accept循环, 在分片对应的工作线程上运行
+     * @param shard 分片
+     */
+    Task<void> AcceptLoop(Shard* shard);
+
+    /**
+     * @brief 关闭所有监听socket
+     */
+    void CloseShards();
+
+    //! 线程池
+    ThreadPool& m_pool;
+    //! 连接的处理函数
+    Handler m_handler;
+    //! 参数
+    ShardedServerOption m_option;
+    //! 监听的端口
+    uint16_t m_port = 0;
+    //! 是否停止
+    std::atomic_bool m_stop = false;
+    //! 分片, 下标即工作线程的索引
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+}  // namespace coro
+
+#endif  // CORO_SHARDED_SERVER_H
@@ -0,0 +1,432 @@
+#ifndef CORO_SHM_CHANNEL_H
+#define CORO_SHM_CHANNEL_H
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <type_traits>
+#include "spsc_channel.h"
+
+namespace coro
+{
+namespace detail
+{
+//! 共享内存头部的标识
+constexpr uint64_t kShmMagic = 0x636f726f73686d31;
+
+/**
+ * @brief 共享内存的头部, 之后是数据槽; 读写位置分别位于不同缓存行
+ */
+struct ShmHeader
+{
+    //! 标识
+    uint64_t m_magic = 0;
+    //! 容量, 2的幂
+    uint64_t m_capacity = 0;
+    //! 数据大小, 映射时校验
+    uint64_t m_elem_size = 0;
+    //! 是否关闭
+    std::atomic_uint32_t m_closed = 0;
+
+    //! 消费者读取的位置
+    alignas(kCacheLine) std::atomic_uint64_t m_head = 0;
+    //! 消费者是否在等待
+    std::atomic_uint32_t m_waiting = 0;
+
+    //! 生产者写入的位置
+    alignas(kCacheLine) std::atomic_uint64_t m_tail = 0;
+};
+
+static_assert(std::atomic_uint64_t::is_always_lock_free && std::atomic_uint32_t::is_always_lock_free, "跨进程的原子变量需无锁");
+}  // namespace detail
+
+/**
+ * @brief 跨进程的单生产者单消费者channel, 环形缓冲区位于memfd共享内存, 以eventfd通知;
+ *        数据直接写入共享内存, 消费者未等待时收发不进行系统调用; 两端的fd经fork继承或SendTo/ReceiveFrom传递,
+ *        接口与SpscChannel相同, 可用于Select
+ * @tparam T 数据类型, 需可平凡复制
+ */
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class ShmChannel
+{
+public:
+    ShmChannel(const ShmChannel&) = delete;
+    ~ShmChannel();
+
+    /**
+     * @brief 创建共享内存与eventfd
+     * @param capacity 容量, 向上取整为2的幂
+     * @return 失败返回空
+     */
+    static std::unique_ptr<ShmChannel> Create(size_t capacity = 1024);
+
+    /**
+     * @brief 映射其他进程创建的channel, 接管fd, 失败时关闭
+     * @param mem_fd 共享内存的fd
+     * @param event_fd 通知的fd
+     * @return 失败或数据类型的大小不一致时返回空
+     */
+    static std::unique_ptr<ShmChannel> Attach(int mem_fd, int event_fd);
+
+    /**
+     * @brief 经unix socket发送两端的fd
+     * @param sock unix socket
+     * @return 成功返回true
+     */
+    bool SendTo(int sock) const;
+
+    /**
+     * @brief 从unix socket接收fd并映射channel, 阻塞直到收到
+     * @param sock unix socket
+     * @return 失败返回空
+     */
+    static std::unique_ptr<ShmChannel> ReceiveFrom(int sock);
+
+    /**
+     * @brief 关闭channel，唤醒消费者
+     */
+    void Close();
+
+    /**
+     * @brief 添加一个数据, 只能由生产者调用
+     * @param t 数据
+     * @return 添加成功后返回true, 关闭或写满时返回false
+     */
+    bool Push(const T& t);
+
+    /**
+     * @brief 获取一个数据, 只能由消费者调用, 关闭后仍先取完已有的数据
+     * @param t 数据引用
+     * @return 获取成功后返回true
+     */
+    Task<bool> Pop(T& t);
+
+    /**
+     * @brief 尝试获取数据, 只能由消费者调用
+     * @param t 数据引用
+     * @return 获取成功后返回true
+     */
+    bool TryPop(T& t);
+
+    /**
+     * @brief 判断channel是否关闭
+     * @return channel关闭返回true
+     */
+    bool IsClose();
+
+    /**
+     * @brief 判断数据队列是否为空
+     * @return 数据队列为空返回true
+     */
+    bool IsEmpty();
+
+    /**
+     * @brief 获取event fd并登记等待, 之后写入的数据会通知该fd
+     * @return event fd
+     */
+    int32_t GetEventfd();
+
+    /**
+     * @brief 获取共享内存的fd
+     * @return
+     */
+    int GetMemfd() const;
+
+private:
+    ShmChannel(int mem_fd, int event_fd, void* addr, size_t size);
+
+    /**
+     * @brief 映射的总大小
+     * @param capacity 容量
+     * @return
+     */
+    static size_t MapSize(size_t capacity);
+
+    /**
+     * @brief 登记等待, 登记后已有数据时立即通知
+     */
+    void Park();
+
+    //! 共享内存的fd
+    int m_mem_fd = -1;
+    //! 通知的fd
+    int m_fd = -1;
+    //! 映射的地址
+    void* m_addr = nullptr;
+    //! 映射的大小
+    size_t m_size = 0;
+    //! 头部
+    detail::ShmHeader* m_header = nullptr;
+    //! 数据槽
+    T* m_data = nullptr;
+    //! 容量减一
+    uint64_t m_mask = 0;
+    //! 消费者缓存的写入位置, 每个进程一份
+    uint64_t m_tail_cache = 0;
+    //! 生产者缓存的读取位置, 每个进程一份
+    uint64_t m_head_cache = 0;
+};
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+ShmChannel<T>::ShmChannel(int mem_fd, int event_fd, void* addr, size_t size)
+    : m_mem_fd(mem_fd)
+    , m_fd(event_fd)
+    , m_addr(addr)
+    , m_size(size)
+    , m_header(static_cast<detail::ShmHeader*>(addr))
+    , m_data(reinterpret_cast<T*>(static_cast<char*>(addr) + MapSize(0)))
+    , m_mask(m_header->m_capacity - 1)
+{}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+ShmChannel<T>::~ShmChannel()
+{
+    munmap(m_addr, m_size);
+    close(m_mem_fd);
+    close(m_fd);
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+size_t ShmChannel<T>::MapSize(size_t capacity)
+{
+    auto header = (sizeof(detail::ShmHeader) + alignof(T) - 1) / alignof(T) * alignof(T);
+    return header + capacity * sizeof(T);
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+std::unique_ptr<ShmChannel<T>> ShmChannel<T>::Create(size_t capacity)
+{
+    capacity = std::bit_ceil(std::max<size_t>(capacity, 2));
+    int mem_fd = memfd_create("coro_shm_channel", MFD_CLOEXEC);
+    if (mem_fd < 0)
+    {
+        return nullptr;
+    }
+    auto size = MapSize(capacity);
+    void* addr = MAP_FAILED;
+    if (ftruncate(mem_fd, static_cast<off_t>(size)) == 0)
+    {
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+    }
+    int event_fd = addr == MAP_FAILED ? -1 : eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd < 0)
+    {
+        if (addr != MAP_FAILED)
+        {
+            munmap(addr, size);
+        }
+        close(mem_fd);
+        return nullptr;
+    }
+    auto* header = new (addr) detail::ShmHeader();
+    header->m_capacity = capacity;
+    header->m_elem_size = sizeof(T);
+    header->m_magic = detail::kShmMagic;
+    return std::unique_ptr<ShmChannel>(new ShmChannel(mem_fd, event_fd, addr, size));
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+std::unique_ptr<ShmChannel<T>> ShmChannel<T>::Attach(int mem_fd, int event_fd)
+{
+    auto fail = [&] {
+        close(mem_fd);
+        close(event_fd);
+        return nullptr;
+    };
+    struct stat st{};
+    if (fstat(mem_fd, &st) != 0 || static_cast<size_t>(st.st_size) < MapSize(0))
+    {
+        return fail();
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        return fail();
+    }
+    auto* header = static_cast<detail::ShmHeader*>(addr);
+    if (header->m_magic != detail::kShmMagic || header->m_elem_size != sizeof(T) || size < MapSize(header->m_capacity) ||
+        !std::has_single_bit(header->m_capacity))
+    {
+        munmap(addr, size);
+        return fail();
+    }
+    return std::unique_ptr<ShmChannel>(new ShmChannel(mem_fd, event_fd, addr, size));
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+bool ShmChannel<T>::SendTo(int sock) const
+{
+    int fds[2] = {m_mem_fd, m_fd};
+    char byte = 0;
+    iovec iov{.iov_base = &byte, .iov_len = 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == 1;
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+std::unique_ptr<ShmChannel<T>> ShmChannel<T>::ReceiveFrom(int sock)
+{
+    int fds[2] = {-1, -1};
+    char byte = 0;
+    iovec iov{.iov_base = &byte, .iov_len = 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))]{};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != 1)
+    {
+        return nullptr;
+    }
+    auto* cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds)))
+    {
+        return nullptr;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    return Attach(fds[0], fds[1]);
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+void ShmChannel<T>::Close()
+{
+    if (m_header->m_closed.exchange(1))
+    {
+        return;
+    }
+    eventfd_write(m_fd, 1);
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+bool ShmChannel<T>::Push(const T& t)
+{
+    if (m_header->m_closed.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    auto tail = m_header->m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head_cache > m_mask)
+    {
+        m_head_cache = m_header->m_head.load(std::memory_order_acquire);
+        if (tail - m_head_cache > m_mask)
+        {
+            return false;
+        }
+    }
+    memcpy(static_cast<void*>(&m_data[tail & m_mask]), &t, sizeof(T));
+    // 与消费者登记等待构成先写后读, 需要顺序一致
+    m_header->m_tail.store(tail + 1, std::memory_order_seq_cst);
+    if (m_header->m_waiting.load(std::memory_order_seq_cst) && m_header->m_waiting.exchange(0))
+    {
+        eventfd_write(m_fd, 1);
+    }
+    return true;
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+Task<bool> ShmChannel<T>::Pop(T& t)
+{
+    EventFdAwaiter awaiter(m_fd);
+    while (true)
+    {
+        if (TryPop(t))
+        {
+            co_return true;
+        }
+        if (IsClose())
+        {
+            // 关闭前写入的数据已在关闭标记之前可见
+            co_return TryPop(t);
+        }
+        Park();
+        co_await awaiter;
+    }
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+bool ShmChannel<T>::TryPop(T& t)
+{
+    auto head = m_header->m_head.load(std::memory_order_relaxed);
+    if (head == m_tail_cache)
+    {
+        m_tail_cache = m_header->m_tail.load(std::memory_order_acquire);
+        if (head == m_tail_cache)
+        {
+            return false;
+        }
+    }
+    memcpy(static_cast<void*>(&t), &m_data[head & m_mask], sizeof(T));
+    m_header->m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+bool ShmChannel<T>::IsClose()
+{
+    return m_header->m_closed.load(std::memory_order_acquire);
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+bool ShmChannel<T>::IsEmpty()
+{
+    return m_header->m_head.load(std::memory_order_acquire) == m_header->m_tail.load(std::memory_order_acquire);
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+int32_t ShmChannel<T>::GetEventfd()
+{
+    Park();
+    return m_fd;
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+int ShmChannel<T>::GetMemfd() const
+{
+    return m_mem_fd;
+}
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+void ShmChannel<T>::Park()
+{
+    m_header->m_waiting.store(1, std::memory_order_seq_cst);
+    // 登记前写入的数据不会通知, 需要重新检查
+    if (m_header->m_head.load(std::memory_order_relaxed) != m_header->m_tail.load(std::memory_order_seq_cst) &&
+        m_header->m_waiting.exchange(0))
+    {
+        eventfd_write(m_fd, 1);
+    }
+}
+
+}  // namespace coro
+
+#endif  // CORO_SHM_CHANNEL_H
@@ -3,13 +3,14 @@
 namespace coro
 {
 Sleep::Sleep(int sec, int ms)
-    : m_tv({.tv_sec = sec, .tv_usec = ms * 1000})
+    : m_tv({.tv_sec = sec + ms / 1000, .tv_usec = ms % 1000 * 1000})
 {}
 
 Sleep::~Sleep()
 {
     if (m_event)
     {
+        GetExecutor()->CancelTimer(m_event);
         event_free(m_event);
     }
 }
@@ -20,7 +21,7 @@ void Sleep::Handle()
     {
         m_event = evtimer_new(EventBase(), OnTimeout, this);
     }
-    evtimer_add(m_event, &m_tv);
+    GetExecutor()->AddTimer(m_event, m_tv);
 }
 
 void Sleep::OnTimeout(int, short, void* arg)
@@ -8,6 +8,11 @@ namespace coro
 class Sleep : public coro::BaseAwaiter
 {
 public:
+    /**
+     * @brief 构造等待器, 毫秒数可超过1000, 按秒进位
+     * @param sec 秒
+     * @param ms 毫秒
+     */
     explicit Sleep(int sec, int ms = 0);
     ~Sleep() override;
     /**
@@ -0,0 +1,169 @@
+#include "spill_queue.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace coro
+{
+//! 记录长度的字节数
+static constexpr size_t kLengthSize = sizeof(uint32_t);
+
+SpillQueue::SpillQueue(std::string dir, size_t segment_size)
+    : m_dir(std::move(dir))
+    , m_segment_size(segment_size)
+{}
+
+SpillQueue::~SpillQueue()
+{
+    for (auto& seg : m_segments)
+    {
+        Release(seg);
+    }
+}
+
+bool SpillQueue::Push(std::string_view record)
+{
+    auto need = kLengthSize + record.size();
+    if (m_segments.empty() || m_segments.back().m_size - m_segments.back().m_write < need)
+    {
+        if (!m_segments.empty())
+        {
+            Seal(m_segments.back());
+        }
+        if (!NewSegment(std::max(m_segment_size, need)))
+        {
+            return false;
+        }
+    }
+    auto& seg = m_segments.back();
+    if (!seg.m_addr && !Map(seg))
+    {
+        return false;
+    }
+    auto len = static_cast<uint32_t>(record.size());
+    memcpy(seg.m_addr + seg.m_write, &len, kLengthSize);
+    memcpy(seg.m_addr + seg.m_write + kLengthSize, record.data(), record.size());
+    seg.m_write += need;
+    seg.m_count++;
+    m_count++;
+    return true;
+}
+
+std::optional<std::string_view> SpillQueue::Front()
+{
+    if (m_count == 0)
+    {
+        return std::nullopt;
+    }
+    // 超长记录另起一段时, 之前读空的段留在队首
+    while (m_segments.front().m_count == 0)
+    {
+        Release(m_segments.front());
+        m_segments.pop_front();
+    }
+    auto& seg = m_segments.front();
+    if (!seg.m_addr && !Map(seg))
+    {
+        return std::nullopt;
+    }
+    uint32_t len = 0;
+    memcpy(&len, seg.m_addr + seg.m_read, kLengthSize);
+    return std::string_view(seg.m_addr + seg.m_read + kLengthSize, len);
+}
+
+void SpillQueue::PopFront()
+{
+    auto record = Front();
+    if (!record)
+    {
+        return;
+    }
+    auto& seg = m_segments.front();
+    seg.m_read += kLengthSize + record->size();
+    seg.m_count--;
+    m_count--;
+    if (seg.m_count > 0)
+    {
+        return;
+    }
+    if (m_segments.size() > 1)
+    {
+        // 读完且不再写入的段删除
+        Release(seg);
+        m_segments.pop_front();
+        return;
+    }
+    // 唯一的段读空后从头复用
+    seg.m_read = 0;
+    seg.m_write = 0;
+}
+
+size_t SpillQueue::Size() const
+{
+    return m_count;
+}
+
+size_t SpillQueue::GetSegmentCount() const
+{
+    return m_segments.size();
+}
+
+bool SpillQueue::NewSegment(size_t size)
+{
+    // 匿名的临时文件, 进程退出后自动回收
+    int fd = open(m_dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        auto path = m_dir + "/coro_spill_XXXXXX";
+        fd = mkostemp(path.data(), O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    m_segments.emplace_back(Segment{.m_fd = fd, .m_size = size});
+    return true;
+}
+
+bool SpillQueue::Map(Segment& seg)
+{
+    void* addr = mmap(nullptr, seg.m_size, PROT_READ | PROT_WRITE, MAP_SHARED, seg.m_fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+    madvise(addr, seg.m_size, MADV_SEQUENTIAL);
+    seg.m_addr = static_cast<char*>(addr);
+    return true;
+}
+
+void SpillQueue::Seal(Segment& seg)
+{
+    if (&seg == &m_segments.front() || !seg.m_addr)
+    {
+        return;
+    }
+    // 提前回写, 解除映射后页缓存可被回收
+    sync_file_range(seg.m_fd, 0, static_cast<off_t>(seg.m_write), SYNC_FILE_RANGE_WRITE);
+    munmap(seg.m_addr, seg.m_size);
+    seg.m_addr = nullptr;
+}
+
+void SpillQueue::Release(Segment& seg)
+{
+    if (seg.m_addr)
+    {
+        munmap(seg.m_addr, seg.m_size);
+    }
+    close(seg.m_fd);
+}
+
+}  // namespace coro
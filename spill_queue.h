@@ -0,0 +1,180 @@
+#ifndef CORO_SPILL_QUEUE_H
+#define CORO_SPILL_QUEUE_H
+
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace coro
+{
+/**
+ * @brief 溢出到磁盘的参数
+ */
+struct SpillOption
+{
+    //! 段文件所在的目录, 文件创建后即删除, 不留在磁盘上
+    std::string m_dir = "/tmp";
+    //! 内存中的数据超过该数量后, 之后写入的数据追加到磁盘
+    size_t m_memory_limit = 65536;
+    //! 每个段文件的大小, 大于该值的数据单独占用一个段
+    size_t m_segment_size = 64 << 20;
+};
+
+/**
+ * @brief 溢出到磁盘时的序列化, 需提供
+ *        static void Serialize(const T&, std::string& out) 追加到out,
+ *        static T Deserialize(std::string_view in);
+ *        可平凡复制的类型与std::string已提供
+ * @tparam T 数据类型
+ */
+template <typename T>
+struct SpillSerializer;
+
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+struct SpillSerializer<T>
+{
+    static void Serialize(const T& t, std::string& out)
+    {
+        out.append(reinterpret_cast<const char*>(&t), sizeof(T));
+    }
+
+    static T Deserialize(std::string_view in)
+    {
+        T t;
+        memcpy(static_cast<void*>(&t), in.data(), sizeof(T));
+        return t;
+    }
+};
+
+template <>
+struct SpillSerializer<std::string>
+{
+    static void Serialize(const std::string& t, std::string& out)
+    {
+        out.append(t);
+    }
+
+    static std::string Deserialize(std::string_view in)
+    {
+        return std::string(in);
+    }
+};
+
+/**
+ * @brief 提供了SpillSerializer的类型可溢出到磁盘
+ */
+template <typename T>
+concept Spillable = requires(const T& t, std::string& out, std::string_view in) {
+    SpillSerializer<T>::Serialize(t, out);
+    { SpillSerializer<T>::Deserialize(in) } -> std::convertible_to<T>;
+};
+
+/**
+ * @brief 磁盘上的先进先出队列, 记录依次追加到mmap映射的段文件;
+ *        写满的段开始回写并解除映射, 读取到时重新映射, 读完即关闭删除, 内存占用与积压量无关; 不加锁
+ */
+class SpillQueue
+{
+public:
+    SpillQueue(const SpillQueue&) = delete;
+    /**
+     * @brief 构造队列, 段文件在首次写入时创建
+     * @param dir 段文件所在的目录
+     * @param segment_size 段文件的大小
+     */
+    SpillQueue(std::string dir, size_t segment_size);
+    ~SpillQueue();
+
+    /**
+     * @brief 追加一条记录
+     * @param record 记录
+     * @return 创建或映射段文件失败返回false
+     */
+    bool Push(std::string_view record);
+
+    /**
+     * @brief 获取最早的记录, 在PopFront或Push之前有效
+     * @return 队列为空或映射失败时为空
+     */
+    std::optional<std::string_view> Front();
+
+    /**
+     * @brief 移除最早的记录
+     */
+    void PopFront();
+
+    /**
+     * @brief 获取记录数
+     * @return
+     */
+    size_t Size() const;
+
+    /**
+     * @brief 获取段文件数
+     * @return
+     */
+    size_t GetSegmentCount() const;
+
+private:
+    /**
+     * @brief 段文件, 记录为4字节长度加数据
+     */
+    struct Segment
+    {
+        //! 文件
+        int m_fd = -1;
+        //! 映射的地址, 未映射时为空
+        char* m_addr = nullptr;
+        //! 文件大小
+        size_t m_size = 0;
+        //! 写入位置
+        size_t m_write = 0;
+        //! 读取位置
+        size_t m_read = 0;
+        //! 记录数
+        size_t m_count = 0;
+    };
+
+    /**
+     * @brief 创建段文件并追加到队尾
+     * @param size 文件大小
+     * @return 成功返回true
+     */
+    bool NewSegment(size_t size);
+
+    /**
+     * @brief 映射段文件
+     * @param seg 段
+     * @return 成功返回true
+     */
+    static bool Map(Segment& seg);
+
+    /**
+     * @brief 写满的段开始回写并解除映射, 读取者仍在读的段除外
+     * @param seg 段
+     */
+    void Seal(Segment& seg);
+
+    /**
+     * @brief 关闭段文件
+     * @param seg 段
+     */
+    static void Release(Segment& seg);
+
+    //! 段文件所在的目录
+    std::string m_dir;
+    //! 段文件的大小
+    size_t m_segment_size = 0;
+    //! 段, 队首在读, 队尾在写
+    std::deque<Segment> m_segments;
+    //! 记录数
+    size_t m_count = 0;
+};
+
+}  // namespace coro
+
+#endif  // CORO_SPILL_QUEUE_H
@@ -0,0 +1,238 @@
+#ifndef CORO_SPSC_CHANNEL_H
+#define CORO_SPSC_CHANNEL_H
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+#include "eventfd.h"
+#include "metrics.h"
+#include "task.h"
+
+namespace coro
+{
+//! 缓存行大小
+constexpr size_t kCacheLine = 64;
+
+/**
+ * @brief 单生产者单消费者的channel, 使用无锁环形缓冲区;
+ *        只能有一个线程写入, 一个协程读取, 接口与Channel相同, 可用于Select
+ * @tparam T 数据类型
+ */
+template <typename T>
+class SpscChannel
+{
+public:
+    SpscChannel(const SpscChannel&) = delete;
+    /**
+     * @brief 构造channel
+     * @param capacity 容量, 向上取整为2的幂
+     */
+    explicit SpscChannel(size_t capacity = 1024);
+    ~SpscChannel();
+
+    /**
+     * @brief 关闭channel，唤醒协程
+     */
+    void Close();
+
+    /**
+     * @brief 添加一个数据, 只能由生产者调用
+     * @param t 数据
+     * @return 添加成功后返回true, 关闭或写满时返回false
+     */
+    bool Push(auto&& t);
+
+    /**
+     * @brief 获取一个数据, 只能由消费者调用
+     * @param t 数据引用
+     * @return 获取成功后返回true
+     */
+    Task<bool> Pop(T& t);
+
+    /**
+     * @brief 尝试获取数据, 只能由消费者调用
+     * @param t 数据引用
+     * @return 获取成功后返回true
+     */
+    bool TryPop(T& t);
+
+    /**
+     * @brief 判断channel是否关闭
+     * @return channel关闭返回true
+     */
+    bool IsClose();
+
+    /**
+     * @brief 判断数据队列是否为空
+     * @return 数据队列为空返回true
+     */
+    bool IsEmpty();
+
+    /**
+     * @brief 获取event fd并登记等待, 之后写入的数据会通知该fd
+     * @return event fd
+     */
+    int32_t GetEventfd();
+
+private:
+    /**
+     * @brief 登记等待, 登记后已有数据时立即通知
+     */
+    void Park();
+
+    //! 容量减一
+    const size_t m_mask;
+    //! 数据
+    std::unique_ptr<std::optional<T>[]> m_data;
+    //! 通知channel的fd
+    int m_fd = -1;
+    //! 是否关闭
+    std::atomic_bool m_is_close = false;
+
+    //! 消费者读取的位置
+    alignas(kCacheLine) std::atomic_size_t m_head = 0;
+    //! 消费者缓存的写入位置
+    size_t m_tail_cache = 0;
+    //! 消费者是否在等待
+    std::atomic_bool m_waiting = false;
+
+    //! 生产者写入的位置
+    alignas(kCacheLine) std::atomic_size_t m_tail = 0;
+    //! 生产者缓存的读取位置
+    size_t m_head_cache = 0;
+};
+
+template <typename T>
+SpscChannel<T>::SpscChannel(size_t capacity)
+    : m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1)
+    , m_data(std::make_unique<std::optional<T>[]>(m_mask + 1))
+    , m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+{}
+
+template <typename T>
+SpscChannel<T>::~SpscChannel()
+{
+    close(m_fd);
+}
+
+template <typename T>
+void SpscChannel<T>::Close()
+{
+    if (m_is_close.exchange(true))
+    {
+        return;
+    }
+    eventfd_write(m_fd, 1);
+}
+
+template <typename T>
+bool SpscChannel<T>::Push(auto&& t)
+{
+    if (m_is_close)
+    {
+        return false;
+    }
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head_cache > m_mask)
+    {
+        m_head_cache = m_head.load(std::memory_order_acquire);
+        if (tail - m_head_cache > m_mask)
+        {
+            return false;
+        }
+    }
+    m_data[tail & m_mask].emplace(std::forward<decltype(t)>(t));
+    // 与消费者登记等待构成先写后读, 需要顺序一致
+    m_tail.store(tail + 1, std::memory_order_seq_cst);
+    if constexpr (kMetricsEnabled)
+    {
+        auto& metrics = Metrics::Local();
+        metrics.m_channel_push.Add();
+        metrics.m_channel_depth_max.Update(tail + 1 - m_head_cache);
+    }
+    if (m_waiting.load(std::memory_order_seq_cst) && m_waiting.exchange(false))
+    {
+        eventfd_write(m_fd, 1);
+    }
+    return true;
+}
+
+template <typename T>
+Task<bool> SpscChannel<T>::Pop(T& t)
+{
+    EventFdAwaiter awaiter(m_fd);
+    while (true)
+    {
+        if (TryPop(t))
+        {
+            co_return true;
+        }
+        if (m_is_close)
+        {
+            co_return false;
+        }
+        Park();
+        co_await awaiter;
+    }
+}
+
+template <typename T>
+bool SpscChannel<T>::TryPop(T& t)
+{
+    auto head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail_cache)
+    {
+        m_tail_cache = m_tail.load(std::memory_order_acquire);
+        if (head == m_tail_cache)
+        {
+            return false;
+        }
+    }
+    auto& slot = m_data[head & m_mask];
+    t = std::move(slot.value());
+    slot.reset();
+    m_head.store(head + 1, std::memory_order_release);
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_channel_pop.Add();
+    }
+    return true;
+}
+
+template <typename T>
+bool SpscChannel<T>::IsClose()
+{
+    return m_is_close;
+}
+
+template <typename T>
+bool SpscChannel<T>::IsEmpty()
+{
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+}
+
+template <typename T>
+int32_t SpscChannel<T>::GetEventfd()
+{
+    Park();
+    return m_fd;
+}
+
+template <typename T>
+void SpscChannel<T>::Park()
+{
+    m_waiting.store(true, std::memory_order_seq_cst);
+    // 登记前写入的数据不会通知, 需要重新检查
+    if (m_head.load(std::memory_order_relaxed) != m_tail.load(std::memory_order_seq_cst) && m_waiting.exchange(false))
+    {
+        eventfd_write(m_fd, 1);
+    }
+}
+
+}  // namespace coro
+
+#endif  // CORO_SPSC_CHANNEL_H
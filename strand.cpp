@@ -0,0 +1,274 @@
+#include "strand.h"
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace coro
+{
+namespace detail
+{
+MpscQueue::MpscQueue()
+    : m_head(&m_stub)
+    , m_tail(&m_stub)
+{}
+
+MpscQueue::~MpscQueue()
+{
+    while (auto* node = Pop())
+    {
+        delete node;
+    }
+}
+
+void MpscQueue::Push(StrandNode* node)
+{
+    node->m_next.store(nullptr, std::memory_order_relaxed);
+    auto* prev = m_head.exchange(node, std::memory_order_acq_rel);
+    // 交换与链接之间读取端看到的队列是断开的, 由Pop返回空处理
+    prev->m_next.store(node, std::memory_order_release);
+}
+
+StrandNode* MpscQueue::Pop()
+{
+    auto* tail = m_tail;
+    auto* next = tail->m_next.load(std::memory_order_acquire);
+    if (tail == &m_stub)
+    {
+        if (!next)
+        {
+            return nullptr;
+        }
+        m_tail = next;
+        tail = next;
+        next = next->m_next.load(std::memory_order_acquire);
+    }
+    if (next)
+    {
+        m_tail = next;
+        return tail;
+    }
+    if (tail != m_head.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+    // 只剩最后一个节点, 放回哨兵后才能取出
+    Push(&m_stub);
+    next = tail->m_next.load(std::memory_order_acquire);
+    if (next)
+    {
+        m_tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+}  // namespace detail
+
+StrandGuard::~StrandGuard()
+{
+    if (m_strand)
+    {
+        m_strand->Leave();
+    }
+}
+
+StrandAwaiter::~StrandAwaiter()
+{
+    if (m_node)
+    {
+        m_node->m_awaiter = nullptr;
+        if (!m_node->m_notified.exchange(true, std::memory_order_acq_rel))
+        {
+            // 协程在排队期间被销毁, 节点留在队列中, 轮到时跳过
+            m_node->m_exec->Unref();
+            return;
+        }
+        // 已轮到, 执行权交给了本协程
+        m_entered = true;
+    }
+    if (m_entered && !m_resumed)
+    {
+        m_strand.Leave();
+    }
+}
+
+bool StrandAwaiter::await_ready()
+{
+    if (m_strand.m_count.load(std::memory_order_relaxed) > 0)
+    {
+        // 多半需要排队, 计数前分配节点, 离开者等待链接的时间只剩挂起与一次交换
+        m_queued = std::make_unique<detail::StrandNode>();
+        m_queued->m_waiter = std::make_shared<detail::WaitNode>();
+    }
+    m_entered = m_strand.m_count.fetch_add(1, std::memory_order_acq_rel) == 0;
+    return m_entered;
+}
+
+void StrandAwaiter::Handle()
+{
+    if (!m_queued)
+    {
+        // 检查后strand才变为忙
+        m_queued = std::make_unique<detail::StrandNode>();
+        m_queued->m_waiter = std::make_shared<detail::WaitNode>();
+    }
+    m_node = m_queued->m_waiter;
+    m_node->m_awaiter = this;
+    m_node->m_exec = GetExecutor();
+    m_node->m_exec->Ref();
+    m_strand.m_queue.Push(m_queued.release());
+}
+
+StrandGuard StrandAwaiter::await_resume()
+{
+    m_resumed = true;
+    return StrandGuard(&m_strand);
+}
+
+Strand::Strand(Executor* exec)
+    : m_exec(exec)
+{}
+
+Strand::Strand(ThreadPool& pool)
+    : m_pool(&pool)
+{}
+
+Strand::~Strand() = default;
+
+StrandAwaiter Strand::Enter()
+{
+    return StrandAwaiter(*this);
+}
+
+bool Strand::Post(std::function<Task<void>()> task)
+{
+    // 计数前填好节点, 计数与链接之间只有一次交换
+    auto node = std::make_unique<detail::StrandNode>();
+    node->m_task = std::move(task);
+    if (m_count.fetch_add(1, std::memory_order_acq_rel) == 0)
+    {
+        if (Launch(std::move(node->m_task)))
+        {
+            return true;
+        }
+        // 已计数, 交出执行权
+        Leave();
+        return false;
+    }
+    m_queue.Push(node.release());
+    return true;
+}
+
+void Strand::SetExceptionHandler(std::function<void(std::exception_ptr)> handler)
+{
+    m_handler = std::move(handler);
+}
+
+bool Strand::IsIdle() const
+{
+    return m_count.load(std::memory_order_acquire) == 0;
+}
+
+void Strand::Leave()
+{
+    while (auto task = Next())
+    {
+        if (Launch(std::move(task)))
+        {
+            return;
+        }
+        // 已接收的任务无法启动, 报告后交给下一个
+        Report(std::make_exception_ptr(std::runtime_error{"strand task dropped: no executor accepts it"}));
+    }
+}
+
+std::function<Task<void>()> Strand::Next()
+{
+    while (m_count.fetch_sub(1, std::memory_order_acq_rel) > 1)
+    {
+        auto node = PopNext();
+        if (node->m_task)
+        {
+            return std::move(node->m_task);
+        }
+        if (detail::Wake(node->m_waiter))
+        {
+            return nullptr;
+        }
+        // 等待的协程已销毁, 代其离开
+    }
+    return nullptr;
+}
+
+std::unique_ptr<detail::StrandNode> Strand::PopNext()
+{
+    while (true)
+    {
+        if (auto* node = m_queue.Pop())
+        {
+            return std::unique_ptr<detail::StrandNode>(node);
+        }
+        // 写入者已计数, 节点已分配, 只差交换后的链接
+        std::this_thread::yield();
+    }
+}
+
+bool Strand::Launch(std::function<Task<void>()> task)
+{
+    std::function<Task<void>()> func = [this, task = std::move(task)] { return Drain(this, task); };
+    if (m_pool)
+    {
+        return m_pool->Add(func);
+    }
+    auto* current = Executor::Current();
+    auto* exec = m_exec ? m_exec : current;
+    if (!exec)
+    {
+        return false;
+    }
+    if (exec == current)
+    {
+        exec->RunTask(func);
+        return true;
+    }
+    return exec->Post([exec, func] { exec->RunTask(func); });
+}
+
+void Strand::Report(std::exception_ptr e)
+{
+    if (m_handler)
+    {
+        m_handler(std::move(e));
+        return;
+    }
+    try
+    {
+        std::rethrow_exception(std::move(e));
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "coro::Strand task threw: " << ex.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "coro::Strand task threw an unknown exception" << std::endl;
+    }
+}
+
+Task<void> Strand::Drain(Strand* strand, std::function<Task<void>()> task)
+{
+    while (task)
+    {
+        try
+        {
+            co_await task();
+        }
+        catch (...)
+        {
+            // 任务的异常不影响后续任务
+            strand->Report(std::current_exception());
+        }
+        task = strand->Next();
+    }
+}
+
+}  // namespace coro
@@ -0,0 +1,285 @@
+#ifndef CORO_STRAND_H
+#define CORO_STRAND_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include "task.h"
+#include "thread_pool.h"
+#include "wait_queue.h"
+
+namespace coro
+{
+class Strand;
+
+namespace detail
+{
+/**
+ * @brief strand队列中的一项, 等待进入的协程或投递的任务
+ */
+struct StrandNode
+{
+    //! 下一项
+    std::atomic<StrandNode*> m_next = nullptr;
+    //! 等待进入的协程
+    std::shared_ptr<WaitNode> m_waiter;
+    //! 投递的任务
+    std::function<Task<void>()> m_task;
+};
+
+/**
+ * @brief 侵入式的无锁多生产者单消费者队列(Vyukov), 写入只有一次原子交换;
+ *        读取端同一时刻只有strand的持有者
+ */
+class MpscQueue
+{
+public:
+    MpscQueue();
+    MpscQueue(const MpscQueue&) = delete;
+    ~MpscQueue();
+
+    /**
+     * @brief 写入, 可在任意线程调用
+     * @param node 节点, 取出后由读取者释放
+     */
+    void Push(StrandNode* node);
+
+    /**
+     * @brief 取出, 写入者交换后尚未链接时返回空
+     * @return
+     */
+    StrandNode* Pop();
+
+private:
+    //! 写入端
+    std::atomic<StrandNode*> m_head;
+    //! 读取端
+    StrandNode* m_tail;
+    //! 哨兵节点
+    StrandNode m_stub;
+};
+}  // namespace detail
+
+/**
+ * @brief Strand::Enter返回的持有者, 析构时离开strand
+ */
+class StrandGuard
+{
+public:
+    StrandGuard() = default;
+    StrandGuard(const StrandGuard&) = delete;
+    StrandGuard(StrandGuard&& other) noexcept
+        : m_strand(std::exchange(other.m_strand, nullptr))
+    {}
+    explicit StrandGuard(Strand* strand)
+        : m_strand(strand)
+    {}
+    ~StrandGuard();
+
+private:
+    //! strand
+    Strand* m_strand = nullptr;
+};
+
+/**
+ * @brief Strand::Enter的等待器, 空闲时不挂起; 否则排入队列, 轮到时在协程所在的执行器上恢复
+ */
+class StrandAwaiter : public WaitAwaiter
+{
+public:
+    explicit StrandAwaiter(Strand& strand)
+        : m_strand(strand)
+    {}
+    ~StrandAwaiter() override;
+
+    bool await_ready();
+
+    /**
+     * @brief 排入队列
+     */
+    void Handle() override;
+
+    StrandGuard await_resume();
+
+private:
+    //! strand
+    Strand& m_strand;
+    //! 等待者
+    std::shared_ptr<detail::WaitNode> m_node;
+    //! 计数前分配的队列节点, 排队时写入队列
+    std::unique_ptr<detail::StrandNode> m_queued;
+    //! 是否已进入
+    bool m_entered = false;
+    //! 是否已恢复, 离开的责任转给StrandGuard
+    bool m_resumed = false;
+};
+
+/**
+ * @brief 串行执行单元: 进入strand的协程与投递的任务依次执行, 同一时刻至多一个, 但不绑定线程;
+ *        空闲时进入只有一次原子加法, 不挂起协程; 排队使用无锁队列, 离开时把执行权直接交给下一个
+ */
+class Strand
+{
+public:
+    Strand(const Strand&) = delete;
+    /**
+     * @brief 构造strand, 投递的任务在执行器上运行
+     * @param exec 执行器, 为空时使用投递时所在的执行器
+     */
+    explicit Strand(Executor* exec = nullptr);
+    /**
+     * @brief 构造strand, 投递的任务在线程池中运行
+     * @param pool 线程池
+     */
+    explicit Strand(ThreadPool& pool);
+    ~Strand();
+
+    /**
+     * @brief 进入strand, 持有返回的StrandGuard期间(包括挂起)其他协程与任务不会进入
+     * @return 等待器, co_await返回StrandGuard
+     */
+    StrandAwaiter Enter();
+
+    /**
+     * @brief 投递任务, 轮到时运行, 运行结束(包括挂起后结束)才轮到下一个; 可在任意线程调用,
+     *        在其他线程投递到Strand(exec)时exec需在监听投递(线程池的工作线程, 或持有KeepAlive)
+     * @param task 任务, 抛出的异常交给异常处理函数
+     * @return 空闲时立即启动, 没有可用的执行器(未指定执行器且不在执行器中, 线程池已停止, 执行器未监听投递)时返回false
+     */
+    bool Post(std::function<Task<void>()> task);
+
+    /**
+     * @brief 设置异常处理函数, 投递的任务抛出的异常及已接收但无法启动的任务交给它处理, 未设置时输出到标准错误;
+     *        需在投递任务前设置
+     * @param handler 处理函数
+     */
+    void SetExceptionHandler(std::function<void(std::exception_ptr)> handler);
+
+    /**
+     * @brief 是否没有持有者
+     * @return
+     */
+    bool IsIdle() const;
+
+private:
+    friend class StrandAwaiter;
+    friend class StrandGuard;
+
+    /**
+     * @brief 离开strand, 执行权交给下一个; 下一个是任务时在strand的执行器上运行
+     */
+    void Leave();
+
+    /**
+     * @brief 离开strand并取出下一个任务; 下一个是协程时唤醒它并返回空
+     * @return 需要由调用者运行的任务
+     */
+    std::function<Task<void>()> Next();
+
+    /**
+     * @brief 取出队列中的下一项, 写入者已计数但尚未链接时等待
+     * @return
+     */
+    std::unique_ptr<detail::StrandNode> PopNext();
+
+    /**
+     * @brief 在strand的执行器上运行任务
+     * @param task 任务
+     * @return 没有可用的执行器时返回false
+     */
+    bool Launch(std::function<Task<void>()> task);
+
+    /**
+     * @brief 报告任务的异常
+     * @param e 异常
+     */
+    void Report(std::exception_ptr e);
+
+    /**
+     * @brief 依次运行任务, 下一个仍是任务时在同一协程中继续, 不切换
+     */
+    static Task<void> Drain(Strand* strand, std::function<Task<void>()> task);
+
+    //! 持有者与排队者的总数
+    std::atomic_size_t m_count = 0;
+    //! 排队者
+    detail::MpscQueue m_queue;
+    //! 运行任务的执行器
+    Executor* m_exec = nullptr;
+    //! 运行任务的线程池
+    ThreadPool* m_pool = nullptr;
+    //! 异常处理函数
+    std::function<void(std::exception_ptr)> m_handler;
+};
+
+/**
+ * @brief 状态只在strand中访问的actor, 不需要锁
+ * @tparam State 状态类型
+ */
+template <typename State>
+class Actor
+{
+public:
+    /**
+     * @brief 构造actor
+     * @param exec Tell的消息运行的执行器, 为空时使用发送时所在的执行器
+     * @param args 构造状态的参数
+     */
+    template <typename... Args>
+    explicit Actor(Executor* exec, Args&&... args)
+        : m_strand(exec)
+        , m_state(std::forward<Args>(args)...)
+    {}
+
+    /**
+     * @brief 构造actor
+     * @param pool Tell的消息运行的线程池
+     * @param args 构造状态的参数
+     */
+    template <typename... Args>
+    explicit Actor(ThreadPool& pool, Args&&... args)
+        : m_strand(pool)
+        , m_state(std::forward<Args>(args)...)
+    {}
+
+    /**
+     * @brief 在strand中访问状态并返回结果, 在调用者的执行器上运行
+     * @param func R(State&)或Task<R>(State&)
+     * @return
+     */
+    template <typename F>
+    auto Ask(F func) -> Task<detail::InvokeResult<F, State&>>
+    {
+        auto guard = co_await m_strand.Enter();
+        co_return co_await detail::Invoke(func, m_state);
+    }
+
+    /**
+     * @brief 发送消息, 不等待结果, 异常交给strand的异常处理函数
+     * @param func void(State&)或Task<void>(State&)
+     * @return 同Strand::Post
+     */
+    template <typename F>
+    bool Tell(F func)
+    {
+        return m_strand.Post([this, func = std::move(func)]() mutable -> Task<void> {
+            co_await detail::Invoke(func, m_state);
+        });
+    }
+
+    Strand& GetStrand()
+    {
+        return m_strand;
+    }
+
+private:
+    //! 串行执行单元
+    Strand m_strand;
+    //! 状态
+    State m_state;
+};
+
+}  // namespace coro
+
+#endif  // CORO_STRAND_H
@@ -7,8 +7,10 @@
 #include <memory>
 #include <optional>
 #include <queue>
+#include <source_location>
 #include <utility>
 #include <variant>
+#include "priority.h"
 
 namespace coro
 {
@@ -17,6 +19,7 @@ struct Context
 {
     Executor* m_exec = nullptr;
     std::function<void()> m_destroy = []{};
+    Priority m_priority = Priority::Normal;
 };
 
 template <typename T = void>
@@ -32,6 +35,12 @@ struct PromiseBase
         std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
         {
             auto& promise = coroutine.promise();
+#ifdef CORO_TRACE
+            if (promise.m_caller)
+            {
+                promise.m_caller->m_callee = nullptr;
+            }
+#endif
             if (promise.m_continuation != nullptr)
             {
                 return promise.m_continuation;
@@ -56,9 +65,39 @@ struct PromiseBase
 
     std::weak_ptr<Context> GetContext() { return m_ctx; }
 
+#ifdef CORO_TRACE
+    /**
+     * @brief 记录每个co_await的位置
+     */
+    template <typename awaitable_type>
+    awaitable_type&& await_transform(awaitable_type&& awaitable, std::source_location location = std::source_location::current()) noexcept
+    {
+        m_location = location;
+        return std::forward<awaitable_type>(awaitable);
+    }
+
+    void SetCaller(PromiseBase* caller) noexcept
+    {
+        m_caller = caller;
+        caller->m_callee = this;
+    }
+
+    PromiseBase* GetCallee() const noexcept { return m_callee; }
+
+    const std::source_location& GetLocation() const noexcept { return m_location; }
+#endif
+
 protected:
     std::coroutine_handle<> m_continuation{nullptr};
     std::weak_ptr<Context> m_ctx;
+#ifdef CORO_TRACE
+    //! 最近一次co_await的位置
+    std::source_location m_location;
+    //! 正在等待本协程的协程
+    PromiseBase* m_caller = nullptr;
+    //! 本协程正在等待的协程
+    PromiseBase* m_callee = nullptr;
+#endif
 };
 
 template <typename return_type>
@@ -248,6 +287,9 @@ public:
         {
             m_coroutine.promise().SetContinuation(awaiting_coroutine);
             m_coroutine.promise().SetContext(awaiting_coroutine.promise().GetContext());
+#ifdef CORO_TRACE
+            m_coroutine.promise().SetCaller(&awaiting_coroutine.promise());
+#endif
             return m_coroutine;
         }
 
@@ -346,6 +388,7 @@ public:
     std::shared_ptr<Context> GetContext() { return m_ctx; }
     void SetExecutor(Executor* exec) { m_ctx->m_exec = exec; }
     void SetDestroy(std::function<void()> destroy) { m_ctx->m_destroy = std::move(destroy); }
+    void SetPriority(Priority priority) { m_ctx->m_priority = priority; }
 
 private:
     coroutine_handle m_coroutine{nullptr};
@@ -367,6 +410,77 @@ inline auto Promise<void>::get_return_object() noexcept -> Task<>
     return t;
 }
 
+namespace detail
+{
+/**
+ * @brief 可调用对象的结果类型, 返回Task<U>时为U
+ */
+template <typename R>
+struct AwaitResultOf
+{
+    using type = R;
+    static constexpr bool kIsTask = false;
+};
+
+template <typename U>
+struct AwaitResultOf<Task<U>>
+{
+    using type = U;
+    static constexpr bool kIsTask = true;
+};
+
+template <typename F, typename... Args>
+using InvokeResult = typename AwaitResultOf<std::invoke_result_t<F&, Args...>>::type;
+
+/**
+ * @brief 已有的结果, 不挂起
+ */
+template <typename R>
+struct ReadyAwaiter
+{
+    explicit ReadyAwaiter(R value)
+        : m_value(std::move(value))
+    {}
+
+    bool await_ready() const
+    {
+        return true;
+    }
+
+    void await_suspend(std::coroutine_handle<>)
+    {}
+
+    R await_resume()
+    {
+        return std::move(m_value);
+    }
+
+    R m_value;
+};
+
+/**
+ * @brief 调用普通函数或协程函数, 统一为可co_await的结果; 普通函数直接调用, 不创建协程
+ */
+template <typename F, typename... Args>
+auto Invoke(F& fn, Args&&... args)
+{
+    using R = std::invoke_result_t<F&, Args...>;
+    if constexpr (AwaitResultOf<R>::kIsTask)
+    {
+        return fn(std::forward<Args>(args)...);
+    }
+    else if constexpr (std::is_void_v<R>)
+    {
+        fn(std::forward<Args>(args)...);
+        return std::suspend_never{};
+    }
+    else
+    {
+        return ReadyAwaiter<R>(fn(std::forward<Args>(args)...));
+    }
+}
+}  // namespace detail
+
 }  // namespace coro
 
-#endif  // CORO_TASK_H
\ No newline at end of file
+#endif  // CORO_TASK_H
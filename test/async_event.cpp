@@ -0,0 +1,121 @@
+#include "async_event.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include "manual_executor.h"
+#include "thread_pool.h"
+
+TEST(event, manual_reset)
+{
+    coro::Event event;
+    coro::ThreadPool pool(2);
+    constexpr int kWaiters = 8;
+    std::atomic_int woken = 0;
+    for (int i = 0; i < kWaiters; i++)
+    {
+        pool.Add([&]() -> coro::Task<void> {
+            co_await event.Wait();
+            woken++;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(woken, 0);
+    event.Set();
+    while (woken < kWaiters)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(event.IsSet());
+
+    // 已设置时不挂起, 复位后重新等待
+    coro::ManualExecutor exec;
+    int passed = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        co_await event.Wait();
+        passed++;
+        event.Reset();
+        co_await event.Wait();
+        passed++;
+    });
+    EXPECT_EQ(passed, 1);
+    event.Set();
+    exec.RunUntilIdle();
+    EXPECT_EQ(passed, 2);
+}
+
+TEST(event, auto_reset)
+{
+    coro::Event event(coro::EventMode::AutoReset);
+    coro::ManualExecutor exec;
+    int woken = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        exec.RunTask([&]() -> coro::Task<void> {
+            co_await event.Wait();
+            woken++;
+        });
+    }
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 0);
+    // 每次设置只放行一个
+    event.Set();
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 1);
+    EXPECT_FALSE(event.IsSet());
+    event.Set();
+    event.Set();
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 3);
+    EXPECT_FALSE(event.IsSet());
+
+    // 没有等待者时保持设置, 由下一个等待者消耗
+    event.Set();
+    EXPECT_TRUE(event.IsSet());
+    exec.RunTask([&]() -> coro::Task<void> {
+        co_await event.Wait();
+        woken++;
+    });
+    EXPECT_EQ(woken, 4);
+    EXPECT_FALSE(event.IsSet());
+}
+
+TEST(event, cancel_waiter)
+{
+    coro::Event event(coro::EventMode::AutoReset);
+    coro::ManualExecutor cancel_exec;
+    coro::ManualExecutor exec;
+    bool woken = false;
+    cancel_exec.RunTask([&]() -> coro::Task<void> { co_await event.Wait(); });
+    exec.RunTask([&]() -> coro::Task<void> {
+        co_await event.Wait();
+        woken = true;
+    });
+    // 最早的等待者被销毁, 设置交给下一个
+    EXPECT_EQ(cancel_exec.Cancel(), 1);
+    event.Set();
+    exec.RunUntilIdle();
+    EXPECT_TRUE(woken);
+}
+
+TEST(event, cancel_race)
+{
+    for (int i = 0; i < 200; i++)
+    {
+        coro::Event event(coro::EventMode::AutoReset);
+        coro::ManualExecutor cancel_exec;
+        coro::ManualExecutor exec;
+        bool woken = false;
+        cancel_exec.RunTask([&]() -> coro::Task<void> { co_await event.Wait(); });
+        exec.RunTask([&]() -> coro::Task<void> {
+            co_await event.Wait();
+            woken = true;
+        });
+        // 另一线程设置时销毁最早的等待者, 无论谁先, 放行权都交给下一个
+        std::thread setter([&] { event.Set(); });
+        cancel_exec.Cancel();
+        setter.join();
+        cancel_exec.RunUntilIdle();
+        exec.RunUntilIdle();
+        ASSERT_TRUE(woken);
+        EXPECT_FALSE(event.IsSet());
+    }
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <set>
+#include <thread>
+#include "batching_writer.h"
+#include "manual_executor.h"
+#include "util.h"
+
+using namespace std::chrono_literals;
+
+std::string WriterPath(const char* name)
+{
+    return std::string("/tmp/coro_writer_") + name + "_" + std::to_string(getpid());
+}
+
+std::string ReadAll(coro::File& file)
+{
+    std::string content(file.GetSize(), '\0');
+    EXPECT_EQ(pread(file.GetFd(), content.data(), content.size(), 0), content.size());
+    return content;
+}
+
+TEST(batching_writer, group_commit)
+{
+    auto path = WriterPath("group");
+    coro::File file;
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    coro::ManualExecutor exec;
+    coro::BatchingWriter writer(file);
+    exec.RunTask([&] { return writer.Run(); });
+
+    constexpr int kRecords = 100;
+    std::vector<std::string> records;
+    std::vector<ssize_t> offsets(kRecords, -1);
+    for (int i = 0; i < kRecords; i++)
+    {
+        records.emplace_back("record " + std::to_string(i) + "\n");
+    }
+    for (int i = 0; i < kRecords; i++)
+    {
+        exec.RunTask([&, i]() -> coro::Task<void> { offsets[i] = co_await writer.Append(records[i]); });
+    }
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 1; });
+    // 写入循环启动前的追加作为一批提交
+    EXPECT_EQ(writer.GetBatchCount(), 1);
+    EXPECT_EQ(writer.GetRecordCount(), kRecords);
+
+    auto content = ReadAll(file);
+    for (int i = 0; i < kRecords; i++)
+    {
+        ASSERT_GE(offsets[i], 0);
+        EXPECT_EQ(content.substr(offsets[i], records[i].size()), records[i]);
+    }
+    writer.Close();
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    unlink(path.c_str());
+}
+
+TEST(batching_writer, close_in_batch)
+{
+    auto path = WriterPath("close");
+    coro::File file;
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    coro::ManualExecutor exec;
+    coro::BatchingWriter writer(file);
+    std::vector<ssize_t> offsets;
+    for (auto data : {"a", "b", "c"})
+    {
+        exec.RunTask([&, data]() -> coro::Task<void> { offsets.emplace_back(co_await writer.Append(data)); });
+    }
+    // 关闭标记与记录在同一批中读取, 写入循环提交后退出
+    writer.Close();
+    exec.RunTask([&] { return writer.Run(); });
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    EXPECT_EQ(offsets.size(), 3);
+    EXPECT_EQ(ReadAll(file), "abc");
+    unlink(path.c_str());
+}
+
+TEST(batching_writer, window)
+{
+    auto path = WriterPath("window");
+    coro::File file;
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    coro::ManualExecutor exec;
+    coro::BatchingWriter writer(file, {.m_window = 10ms});
+    exec.RunTask([&] { return writer.Run(); });
+    std::vector<ssize_t> offsets;
+    auto append = [&](std::string_view data) { exec.RunTask([&, data]() -> coro::Task<void> { offsets.emplace_back(co_await writer.Append(data)); }); };
+    append("first");
+    exec.RunUntilIdle();
+    exec.AdvanceTime(5ms);
+    append("second");
+    exec.AdvanceTime(5ms);
+    RunUntil(exec, [&] { return offsets.size() == 2; });
+    // 窗口内的两条记录合并为一批
+    EXPECT_EQ(writer.GetBatchCount(), 1);
+    EXPECT_EQ(ReadAll(file), "firstsecond");
+
+    writer.Close();
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    exec.RunTask([&]() -> coro::Task<void> { EXPECT_EQ(co_await writer.Append("closed"), -EPIPE); });
+    unlink(path.c_str());
+}
+
+TEST(batching_writer, thread)
+{
+    auto path = WriterPath("thread");
+    coro::File file;
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    coro::BatchingWriter writer(file, {.m_max_bytes = 256});
+    std::jthread writer_thread([&] {
+        coro::ManualExecutor exec;
+        exec.RunTask([&] { return writer.Run(); });
+        RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    });
+
+    constexpr int kThreads = 4;
+    constexpr int kRecords = 200;
+    std::vector<std::vector<ssize_t>> offsets(kThreads);
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < kThreads; t++)
+        {
+            threads.emplace_back([&, t] {
+                coro::ManualExecutor exec;
+                for (int c = 0; c < 8; c++)
+                {
+                    exec.RunTask([&, t, c]() -> coro::Task<void> {
+                        for (int i = c; i < kRecords; i += 8)
+                        {
+                            offsets[t].emplace_back(co_await writer.Append("0123456789abcdef"));
+                        }
+                    });
+                }
+                RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+            });
+        }
+    }
+    writer.Close();
+    writer_thread.join();
+    std::set<ssize_t> all;
+    for (auto& v : offsets)
+    {
+        ASSERT_EQ(v.size(), kRecords);
+        all.insert(v.begin(), v.end());
+    }
+    EXPECT_EQ(all.size(), kThreads * kRecords);
+    EXPECT_EQ(file.GetSize(), kThreads * kRecords * 16);
+    EXPECT_EQ(writer.GetRecordCount(), kThreads * kRecords);
+    std::cout << "batches " << writer.GetBatchCount() << std::endl;
+    EXPECT_LT(writer.GetBatchCount(), kThreads * kRecords);
+    unlink(path.c_str());
+}
+
+TEST(batching_writer, close_race)
+{
+    auto path = WriterPath("close_race");
+    coro::File file;
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    coro::BatchingWriter writer(file);
+    std::jthread writer_thread([&] {
+        coro::ManualExecutor exec;
+        exec.RunTask([&] { return writer.Run(); });
+        RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    });
+
+    // 与Close并发的Append要么被写入, 要么返回-EPIPE, 不会一直等待
+    constexpr int kThreads = 4;
+    std::atomic_int written = 0;
+    std::atomic_int started = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < kThreads; t++)
+        {
+            threads.emplace_back([&] {
+                coro::ManualExecutor exec;
+                for (int c = 0; c < 4; c++)
+                {
+                    exec.RunTask([&]() -> coro::Task<void> {
+                        while (true)
+                        {
+                            started++;
+                            auto ret = co_await writer.Append("0123456789abcdef");
+                            if (ret < 0)
+                            {
+                                EXPECT_EQ(ret, -EPIPE);
+                                break;
+                            }
+                            written++;
+                        }
+                    });
+                }
+                RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+            });
+        }
+        while (started < 1000)
+        {
+            std::this_thread::yield();
+        }
+        writer.Close();
+    }
+    writer_thread.join();
+    EXPECT_EQ(writer.GetRecordCount(), written);
+    EXPECT_EQ(file.GetSize(), written * 16);
+    unlink(path.c_str());
+}
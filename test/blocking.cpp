@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "blocking_pool.h"
+#include "manual_executor.h"
+#include "metrics.h"
+#include "util.h"
+
+using namespace std::chrono_literals;
+
+TEST(blocking, resume)
+{
+    auto before = coro::Metrics::Snapshot();
+    coro::ManualExecutor exec;
+    std::thread::id call_id;
+    std::thread::id resume_id;
+    int result = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        result = co_await coro::Blocking([&] {
+            call_id = std::this_thread::get_id();
+            usleep(20 * 1000);
+            return 42;
+        });
+        resume_id = std::this_thread::get_id();
+    });
+    // 阻塞调用期间执行器可以处理其他协程
+    int other = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        other++;
+        co_return;
+    });
+    EXPECT_EQ(other, 1);
+    RunUntilDone(exec);
+    EXPECT_EQ(result, 42);
+    EXPECT_NE(call_id, std::this_thread::get_id());
+    EXPECT_EQ(resume_id, std::this_thread::get_id());
+    if constexpr (coro::kMetricsEnabled)
+    {
+        auto after = coro::Metrics::Snapshot();
+        EXPECT_GE(after.m_blocking_task - before.m_blocking_task, 1);
+        EXPECT_GT(after.m_blocking_queue_time.m_count, before.m_blocking_queue_time.m_count);
+    }
+}
+
+TEST(blocking, bounded)
+{
+    coro::BlockingPool pool({.m_max_threads = 2, .m_idle_timeout = 20ms});
+    std::atomic_int running = 0;
+    std::atomic_int peak = 0;
+    std::vector<coro::Future<void>> futures;
+    for (int i = 0; i < 6; i++)
+    {
+        futures.emplace_back(pool.Run([&] {
+            auto cur = ++running;
+            int expect = peak;
+            while (cur > expect && !peak.compare_exchange_weak(expect, cur))
+            {
+            }
+            usleep(20 * 1000);
+            running--;
+        }));
+    }
+    auto stats = pool.GetStats();
+    EXPECT_EQ(stats.m_threads, 2);
+    EXPECT_GE(stats.m_queued, 3);
+    for (auto& f : futures)
+    {
+        f.Get();
+    }
+    EXPECT_EQ(peak, 2);
+    EXPECT_EQ(pool.GetStats().m_completed, 6);
+
+    // 空闲线程超时退出
+    usleep(100 * 1000);
+    EXPECT_EQ(pool.GetStats().m_threads, 0);
+    EXPECT_EQ(pool.Run([] { return 1; }).Get(), 1);
+}
+
+TEST(blocking, exception)
+{
+    coro::ManualExecutor exec;
+    bool caught = false;
+    exec.RunTask([&]() -> coro::Task<void> {
+        try
+        {
+            co_await coro::Blocking([]() -> int { throw std::runtime_error("error"); });
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+    });
+    RunUntilDone(exec);
+    EXPECT_TRUE(caught);
+}
+
+TEST(blocking, stop)
+{
+    coro::Future<int> future;
+    {
+        coro::BlockingPool pool({.m_max_threads = 1});
+        pool.Post([] { usleep(20 * 1000); });
+        future = pool.Run([] { return 1; });
+    }
+    // 析构时排队的任务执行完, 结果已设置
+    EXPECT_EQ(future.Get(), 1);
+}
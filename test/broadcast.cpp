@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "broadcast_channel.h"
+#include "manual_executor.h"
+#include "sleep.h"
+#include "util.h"
+
+using namespace std::chrono_literals;
+
+TEST(broadcast, fanout)
+{
+    coro::ManualExecutor exec;
+    coro::BroadcastChannel<std::string> chan(4);
+    std::vector<std::vector<const std::string*>> recv(3);
+    std::vector<std::unique_ptr<coro::BroadcastChannel<std::string>::Subscriber>> subs;
+    for (size_t i = 0; i < recv.size(); i++)
+    {
+        subs.emplace_back(chan.Subscribe());
+        exec.RunTask([&, i]() -> coro::Task<void> {
+            std::shared_ptr<const std::string> val;
+            while (co_await subs[i]->Pop(val))
+            {
+                recv[i].emplace_back(val.get());
+            }
+        });
+    }
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 10; i++)
+        {
+            EXPECT_TRUE(co_await chan.Send(std::to_string(i)));
+        }
+        chan.Close();
+    });
+    exec.RunUntilIdle();
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+    for (auto& r : recv)
+    {
+        ASSERT_EQ(r.size(), 10);
+        // 所有订阅者读到同一份数据
+        EXPECT_EQ(r, recv[0]);
+    }
+}
+
+TEST(broadcast, block)
+{
+    coro::ManualExecutor exec;
+    coro::BroadcastChannel<int> chan(2);
+    auto fast = chan.Subscribe();
+    auto slow = chan.Subscribe();
+    int sent = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 5; i++)
+        {
+            co_await chan.Send(i);
+            sent++;
+        }
+    });
+    exec.RunUntilIdle();
+    EXPECT_EQ(sent, 2);
+    EXPECT_FALSE(chan.Push(100));
+
+    exec.RunTask([&]() -> coro::Task<void> {
+        std::shared_ptr<const int> v;
+        for (int i = 0; i < 5; i++)
+        {
+            EXPECT_TRUE(co_await fast->Pop(v));
+        }
+    });
+    exec.RunUntilIdle();
+    // 最慢的订阅者未读取, 写入仍在等待
+    EXPECT_EQ(sent, 2);
+
+    exec.RunTask([&]() -> coro::Task<void> {
+        std::shared_ptr<const int> v;
+        for (int i = 0; i < 5; i++)
+        {
+            EXPECT_TRUE(co_await slow->Pop(v));
+            EXPECT_EQ(*v, i);
+            co_await coro::Sleep(0, 10);
+        }
+    });
+    exec.AdvanceTime(1s);
+    EXPECT_EQ(sent, 5);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+    EXPECT_EQ(slow->TakeLagged(), 0);
+}
+
+TEST(broadcast, drop)
+{
+    coro::BroadcastChannel<int> chan(2, coro::OverflowPolicy::DropNewest);
+    auto sub = chan.Subscribe();
+    for (int i = 0; i < 5; i++)
+    {
+        chan.Push(i);
+    }
+    EXPECT_EQ(chan.GetDropped(), 3);
+    std::shared_ptr<const int> val;
+    ASSERT_TRUE(sub->TryPop(val));
+    EXPECT_EQ(*val, 0);
+    EXPECT_TRUE(chan.Push(5));
+}
+
+TEST(broadcast, lag)
+{
+    coro::BroadcastChannel<int> chan(4, coro::OverflowPolicy::Lag);
+    auto sub = chan.Subscribe();
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(chan.Push(i));
+    }
+    std::vector<int> data;
+    std::shared_ptr<const int> val;
+    while (sub->TryPop(val))
+    {
+        data.emplace_back(*val);
+    }
+    std::vector<int> expect{6, 7, 8, 9};
+    EXPECT_EQ(data, expect);
+    EXPECT_EQ(sub->TakeLagged(), 6);
+    EXPECT_EQ(sub->TakeLagged(), 0);
+}
+
+TEST(broadcast, thread)
+{
+    coro::BroadcastChannel<int> chan(16);
+    std::vector<std::unique_ptr<coro::BroadcastChannel<int>::Subscriber>> subs;
+    std::vector<int64_t> sum(4);
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < sum.size(); i++)
+    {
+        subs.emplace_back(chan.Subscribe());
+    }
+    for (size_t i = 0; i < sum.size(); i++)
+    {
+        threads.emplace_back([&, i] {
+            coro::ManualExecutor exec;
+            exec.RunTask([&, i]() -> coro::Task<void> {
+                std::shared_ptr<const int> val;
+                while (co_await subs[i]->Pop(val))
+                {
+                    sum[i] += *val;
+                }
+            });
+            RunUntilDone(exec);
+        });
+    }
+    for (int i = 0; i < 1000;)
+    {
+        if (chan.Push(i))
+        {
+            i++;
+        }
+    }
+    chan.Close();
+    threads.clear();
+    for (auto s : sum)
+    {
+        EXPECT_EQ(s, 999 * 1000 / 2);
+    }
+}
+
+TEST(broadcast, multi_sender)
+{
+    coro::BroadcastChannel<int> chan(2);
+    auto sub = chan.Subscribe();
+    constexpr int kItems = 2000;
+    std::vector<std::jthread> producers;
+    for (int p = 0; p < 2; p++)
+    {
+        producers.emplace_back([&, p] {
+            coro::ManualExecutor exec;
+            exec.RunTask([&, p]() -> coro::Task<void> {
+                for (int i = 0; i < kItems; i++)
+                {
+                    EXPECT_TRUE(co_await chan.Send(p * kItems + i));
+                }
+            });
+            RunUntilDone(exec);
+        });
+    }
+    // 订阅者较慢, 两个写入者都会在写满时挂起, 每个空位唤醒一个写入者, 唤醒不丢失
+    coro::ManualExecutor exec;
+    std::vector<int> last{-1, kItems - 1};
+    int received = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        std::shared_ptr<const int> val;
+        while (received < 2 * kItems)
+        {
+            EXPECT_TRUE(co_await sub->Pop(val));
+            auto p = *val / kItems;
+            // 同一写入者的数据保持顺序
+            EXPECT_EQ(*val, last[p] + 1);
+            last[p] = *val;
+            received++;
+            if (received % 64 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    });
+    RunUntilDone(exec);
+    producers.clear();
+    EXPECT_EQ(received, 2 * kItems);
+}
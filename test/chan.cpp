@@ -1,5 +1,9 @@
 #include <channel.h>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <filesystem>
+#include "manual_executor.h"
+#include "mutex.h"
 #include "sleep.h"
 #include "util.h"
 #include "select.h"
@@ -120,4 +124,146 @@ coro::Task<void> Tsleep()
 TEST(coro, sleep)
 {
     auto t1 = RunTask(&Tsleep);
-}
\ No newline at end of file
+}
+TEST(coro, chan_without_fd)
+{
+    auto count_fd = [] { return std::distance(std::filesystem::directory_iterator("/proc/self/fd"), {}); };
+    auto before = count_fd();
+    constexpr int kChannels = 10000;
+    std::vector<std::unique_ptr<coro::Channel<int>>> chans;
+    std::vector<std::unique_ptr<coro::Mutex>> mutexes;
+    for (int i = 0; i < kChannels; i++)
+    {
+        chans.emplace_back(std::make_unique<coro::Channel<int>>());
+        mutexes.emplace_back(std::make_unique<coro::Mutex>());
+    }
+    // channel与互斥锁不占用fd
+    EXPECT_EQ(count_fd(), before);
+
+    std::atomic_int parked = 0;
+    int64_t sum = 0;
+    std::jthread consumer([&] {
+        auto base = event_base_new();
+        {
+            coro::Executor exec(base);
+            for (int i = 0; i < kChannels; i++)
+            {
+                exec.RunTask([&, i]() -> coro::Task<void> {
+                    parked++;
+                    for (int j = 0; j < 2; j++)
+                    {
+                        int val = 0;
+                        EXPECT_TRUE(co_await chans[i]->Pop(val));
+                        coro::LockGuard lk = co_await mutexes[val % 16]->Lock();
+                        sum += val;
+                    }
+                });
+            }
+            event_base_dispatch(base);
+        }
+        event_base_free(base);
+    });
+    while (parked < kChannels)
+    {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < kChannels; i++)
+    {
+        chans[i]->Push(i);
+        chans[i]->Push(i);
+    }
+    consumer.join();
+    EXPECT_EQ(sum, int64_t(kChannels) * (kChannels - 1));
+}
+
+TEST(coro, chan_spill)
+{
+    coro::Channel<uint64_t> spill_chan;
+    ASSERT_FALSE(spill_chan.EnableSpill({.m_dir = "/nonexistent"}));
+    ASSERT_TRUE(spill_chan.EnableSpill({.m_memory_limit = 100, .m_segment_size = 4096}));
+    constexpr uint64_t kCount = 20000;
+    for (uint64_t i = 0; i < kCount; i++)
+    {
+        ASSERT_TRUE(spill_chan.Push(i));
+    }
+    // 超出内存上限的数据在磁盘上
+    EXPECT_EQ(spill_chan.GetSpillCount(), kCount - 100);
+
+    // 生产者继续写入的同时按顺序读回
+    std::jthread producer([&] {
+        for (uint64_t i = kCount; i < kCount * 2; i++)
+        {
+            spill_chan.Push(i);
+        }
+    });
+    uint64_t expect = 0;
+    auto base = event_base_new();
+    {
+        coro::Executor exec(base);
+        exec.RunTask([&]() -> coro::Task<void> {
+            uint64_t val = 0;
+            while (expect < kCount * 2)
+            {
+                EXPECT_TRUE(co_await spill_chan.Pop(val));
+                EXPECT_EQ(val, expect);
+                expect++;
+            }
+        });
+        event_base_dispatch(base);
+    }
+    event_base_free(base);
+    EXPECT_EQ(expect, kCount * 2);
+    EXPECT_TRUE(spill_chan.IsEmpty());
+    EXPECT_EQ(spill_chan.GetSpillCount(), 0);
+
+    // 读空后重新写入内存
+    spill_chan.Push(uint64_t(1));
+    EXPECT_EQ(spill_chan.GetSpillCount(), 0);
+
+    // 大于段文件的数据单独占用一段
+    coro::Channel<std::string> str_chan;
+    ASSERT_TRUE(str_chan.EnableSpill({.m_memory_limit = 1, .m_segment_size = 1024}));
+    std::vector<std::string> items{"a", "b", std::string(5000, 'c'), "d", std::string(100, 'e')};
+    for (auto& item : items)
+    {
+        ASSERT_TRUE(str_chan.Push(item));
+    }
+    EXPECT_EQ(str_chan.GetSpillCount(), items.size() - 1);
+    for (auto& item : items)
+    {
+        std::string val;
+        ASSERT_TRUE(str_chan.TryPop(val));
+        EXPECT_EQ(val, item);
+    }
+    EXPECT_TRUE(str_chan.IsEmpty());
+
+    // 写入磁盘失败时数据未添加, channel未关闭
+    auto dir = "/tmp/coro_spill_" + std::to_string(getpid());
+    ASSERT_EQ(mkdir(dir.c_str(), 0755), 0);
+    coro::Channel<uint64_t> fail_chan;
+    ASSERT_TRUE(fail_chan.EnableSpill({.m_dir = dir, .m_memory_limit = 1}));
+    rmdir(dir.c_str());
+    EXPECT_TRUE(fail_chan.Push(uint64_t(1)));
+    EXPECT_FALSE(fail_chan.Push(uint64_t(2)));
+    EXPECT_FALSE(fail_chan.IsClose());
+    uint64_t val = 0;
+    ASSERT_TRUE(fail_chan.TryPop(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_TRUE(fail_chan.IsEmpty());
+}
+
+TEST(coro, chan_cancel_handed)
+{
+    coro::Channel<int> ch;
+    coro::ManualExecutor exec;
+    exec.RunTask([&]() -> coro::Task<void> {
+        int val = 0;
+        co_await ch.Pop(val);
+    });
+    // 数据交给等待者后, 协程恢复前被销毁, 数据放回channel
+    std::thread([&] { EXPECT_TRUE(ch.Push(7)); }).join();
+    EXPECT_EQ(exec.Cancel(), 1);
+    int val = 0;
+    EXPECT_TRUE(ch.TryPop(val));
+    EXPECT_EQ(val, 7);
+}
@@ -0,0 +1,154 @@
+#include "condition_variable.h"
+#include <gtest/gtest.h>
+#include <deque>
+#include <thread>
+#include "manual_executor.h"
+#include "thread_pool.h"
+
+TEST(condition_variable, queue)
+{
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    std::deque<int> queue;
+    bool closed = false;
+    coro::ThreadPool pool(4);
+    constexpr int kConsumers = 6;
+    constexpr int kItems = 3000;
+    std::vector<std::vector<int>> consumed(kConsumers);
+    std::atomic_int done = 0;
+    for (int c = 0; c < kConsumers; c++)
+    {
+        pool.Add([&, c]() -> coro::Task<void> {
+            while (true)
+            {
+                auto lock = co_await mutex.Lock();
+                co_await cv.Wait(lock, [&] { return !queue.empty() || closed; });
+                if (queue.empty())
+                {
+                    break;
+                }
+                consumed[c].emplace_back(queue.front());
+                queue.pop_front();
+            }
+            done++;
+        });
+    }
+    pool.Add([&]() -> coro::Task<void> {
+        for (int i = 0; i < kItems; i++)
+        {
+            auto lock = co_await mutex.Lock();
+            queue.emplace_back(i);
+            cv.NotifyOne();
+        }
+        auto lock = co_await mutex.Lock();
+        closed = true;
+        cv.NotifyAll();
+    });
+    while (done < kConsumers)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<int> all;
+    for (auto& v : consumed)
+    {
+        // 每个消费者按顺序取得数据
+        EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+        all.insert(all.end(), v.begin(), v.end());
+    }
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), kItems);
+    for (int i = 0; i < kItems; i++)
+    {
+        ASSERT_EQ(all[i], i);
+    }
+}
+
+TEST(condition_variable, notify_all)
+{
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    coro::ManualExecutor exec;
+    bool ready = false;
+    int inside = 0;
+    int max_inside = 0;
+    int woken = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        exec.RunTask([&]() -> coro::Task<void> {
+            auto lock = co_await mutex.Lock();
+            co_await cv.Wait(lock, [&] { return ready; });
+            max_inside = std::max(max_inside, ++inside);
+            woken++;
+            inside--;
+        });
+    }
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 0);
+    // 持有锁时通知, 等待者移到互斥锁上, 解锁前都不恢复
+    ASSERT_TRUE(mutex.TryLock());
+    ready = true;
+    cv.NotifyAll();
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 0);
+    mutex.Unlock();
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 4);
+    EXPECT_EQ(max_inside, 1);
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+
+    // 没有等待者时通知无效果
+    cv.NotifyOne();
+    cv.NotifyAll();
+}
+
+TEST(condition_variable, notify_one)
+{
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    coro::ManualExecutor exec;
+    int woken = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        exec.RunTask([&]() -> coro::Task<void> {
+            auto lock = co_await mutex.Lock();
+            co_await cv.Wait(lock);
+            woken++;
+        });
+    }
+    exec.RunUntilIdle();
+    // 只唤醒一个
+    cv.NotifyOne();
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 1);
+    cv.NotifyOne();
+    cv.NotifyOne();
+    exec.RunUntilIdle();
+    EXPECT_EQ(woken, 3);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(condition_variable, invalid_lock)
+{
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    coro::ManualExecutor exec;
+    bool thrown = false;
+    exec.RunTask([&]() -> coro::Task<void> {
+        auto lock = co_await mutex.Lock();
+        lock.Unlock();
+        // 已解锁的锁不能用于等待
+        try
+        {
+            co_await cv.Wait(lock);
+        }
+        catch (const std::logic_error&)
+        {
+            thrown = true;
+        }
+    });
+    exec.RunUntilIdle();
+    EXPECT_TRUE(thrown);
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+}
@@ -58,5 +58,6 @@ TEST(example, main)
     event_base_once(base, -1, EV_TIMEOUT, AddCoTask, nullptr, &tv);
 
     event_base_dispatch(base);
+    exec.reset();
     event_base_free(base);
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include "file.h"
+#include "manual_executor.h"
+#include "util.h"
+
+/**
+ * @brief 生成临时文件路径
+ */
+std::string TempPath(const char* name)
+{
+    return std::string("/tmp/coro_") + name + "_" + std::to_string(getpid());
+}
+
+std::vector<std::shared_ptr<coro::FileEngine>> Engines()
+{
+    std::vector<std::shared_ptr<coro::FileEngine>> engines{std::make_shared<coro::ThreadFileEngine>(2)};
+    if (auto uring = coro::UringFileEngine::Create(64))
+    {
+        engines.emplace_back(uring);
+    }
+    return engines;
+}
+
+TEST(file, read_write)
+{
+    for (auto& engine : Engines())
+    {
+        std::cout << "engine " << engine->Name() << std::endl;
+        auto path = TempPath("rw");
+        coro::ManualExecutor exec;
+        coro::File file(engine);
+        ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+        exec.RunTask([&]() -> coro::Task<void> {
+            EXPECT_EQ(co_await file.WriteAt("hello world", 0), 11);
+            EXPECT_EQ(co_await file.WriteAt("coro!", 6), 5);
+            EXPECT_EQ(co_await file.Fsync(), 0);
+            char buf[32]{};
+            EXPECT_EQ(co_await file.ReadAt(buf, sizeof(buf), 0), 11);
+            EXPECT_STREQ(buf, "hello coro!");
+            EXPECT_EQ(co_await file.ReadAt(buf, sizeof(buf), 100), 0);
+        });
+        RunUntilDone(exec);
+        file.Close();
+        unlink(path.c_str());
+    }
+}
+
+TEST(file, append)
+{
+    for (auto& engine : Engines())
+    {
+        auto path = TempPath("append");
+        coro::ManualExecutor exec;
+        coro::File file(engine);
+        ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+        constexpr int kRecords = 1000;
+        std::vector<std::string> records;
+        for (int i = 0; i < kRecords; i++)
+        {
+            records.emplace_back("record " + std::to_string(i) + "\n");
+        }
+        std::vector<ssize_t> offsets(kRecords, -1);
+        for (int i = 0; i < kRecords; i++)
+        {
+            exec.RunTask([&, i]() -> coro::Task<void> { offsets[i] = co_await file.Append(records[i]); });
+        }
+        RunUntilDone(exec);
+        std::cout << engine->Name() << " append writes " << file.GetAppendWrites() << std::endl;
+
+        std::string content(file.GetSize(), '\0');
+        ASSERT_EQ(pread(file.GetFd(), content.data(), content.size(), 0), content.size());
+        for (int i = 0; i < kRecords; i++)
+        {
+            ASSERT_GE(offsets[i], 0);
+            EXPECT_EQ(content.substr(offsets[i], records[i].size()), records[i]);
+        }
+        file.Close();
+        unlink(path.c_str());
+    }
+}
+
+/**
+ * @brief 由测试控制完成时机的引擎
+ */
+class ManualFileEngine : public coro::FileEngine
+{
+public:
+    coro::Future<ssize_t> Read(int fd, void* buf, size_t len, off_t offset) override
+    {
+        auto [sender, future] = coro::MakeOneshot<ssize_t>();
+        sender.Set(pread(fd, buf, len, offset));
+        return std::move(future);
+    }
+
+    coro::Future<ssize_t> Write(int fd, std::vector<iovec> iov, off_t offset) override
+    {
+        auto [sender, future] = coro::MakeOneshot<ssize_t>();
+        m_write.emplace_back([=, sender = std::make_shared<coro::Oneshot<ssize_t>>(std::move(sender))] {
+            sender->Set(pwritev(fd, iov.data(), static_cast<int>(iov.size()), offset));
+        });
+        return std::move(future);
+    }
+
+    coro::Future<ssize_t> Fsync(int fd) override
+    {
+        auto [sender, future] = coro::MakeOneshot<ssize_t>();
+        sender.Set(fsync(fd));
+        return std::move(future);
+    }
+
+    const char* Name() const override { return "manual"; }
+
+    /**
+     * @brief 完成所有挂起的写入
+     * @return 完成的写入数
+     */
+    size_t Complete()
+    {
+        auto write = std::move(m_write);
+        for (auto& func : write)
+        {
+            func();
+        }
+        return write.size();
+    }
+
+    std::vector<std::function<void()>> m_write;
+};
+
+TEST(file, coalesce)
+{
+    auto path = TempPath("coalesce");
+    auto engine = std::make_shared<ManualFileEngine>();
+    coro::ManualExecutor exec;
+    coro::File file(engine);
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    std::vector<ssize_t> offsets(100, -1);
+    for (int i = 0; i < 100; i++)
+    {
+        exec.RunTask([&, i]() -> coro::Task<void> { offsets[i] = co_await file.Append(std::string_view("0123456789").substr(0, i % 10 + 1)); });
+    }
+    // 第一次写入期间的追加合并为一次写入
+    EXPECT_EQ(engine->Complete(), 1);
+    exec.RunUntilIdle();
+    EXPECT_EQ(engine->Complete(), 1);
+    exec.RunUntilIdle();
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+    EXPECT_EQ(file.GetAppendWrites(), 2);
+    ssize_t expect = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(offsets[i], expect);
+        expect += i % 10 + 1;
+    }
+    unlink(path.c_str());
+}
+
+TEST(file, append_cancel)
+{
+    auto path = TempPath("append_cancel");
+    auto engine = std::make_shared<ManualFileEngine>();
+    coro::ManualExecutor flush_exec;
+    coro::ManualExecutor exec;
+    coro::File file(engine);
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC));
+    ssize_t second = 0;
+    ssize_t third = -1;
+    flush_exec.RunTask([&]() -> coro::Task<void> { co_await file.Append("abc"); });
+    exec.RunTask([&]() -> coro::Task<void> { second = co_await file.Append("de"); });
+    // 写入任务随执行器取消, 等待中的追加得到-ECANCELED, 追加位置退回
+    EXPECT_EQ(flush_exec.Cancel(), 2);
+    exec.RunUntilIdle();
+    EXPECT_EQ(second, -ECANCELED);
+    EXPECT_EQ(file.GetSize(), 0);
+
+    // 之后的追加重新启动写入
+    exec.RunTask([&]() -> coro::Task<void> { third = co_await file.Append("xyz"); });
+    engine->Complete();
+    exec.RunUntilIdle();
+    EXPECT_EQ(third, 0);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+    EXPECT_EQ(file.GetSize(), 3);
+    unlink(path.c_str());
+}
+
+TEST(file, error)
+{
+    coro::ManualExecutor exec;
+    coro::File file;
+    EXPECT_FALSE(file.Open("/nonexistent/coro", O_RDONLY));
+    auto path = TempPath("ro");
+    close(open(path.c_str(), O_CREAT | O_WRONLY, 0644));
+    ASSERT_TRUE(file.Open(path.c_str(), O_RDONLY));
+    exec.RunTask([&]() -> coro::Task<void> { EXPECT_EQ(co_await file.Append("data"), -EBADF); });
+    RunUntilDone(exec);
+    unlink(path.c_str());
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "future.h"
+#include "manual_executor.h"
+#include "sleep.h"
+#include "thread_pool.h"
+
+using namespace std::chrono_literals;
+
+TEST(future, manual)
+{
+    coro::ManualExecutor exec;
+    auto [sender, future] = coro::MakeOneshot<std::string>();
+    std::string result;
+    exec.RunTask([&, future = future]() -> coro::Task<void> { result = co_await future; });
+    exec.RunTask([&]() -> coro::Task<void> {
+        co_await coro::Sleep(1);
+        sender.Set("done");
+    });
+    exec.AdvanceTime(500ms);
+    EXPECT_TRUE(result.empty());
+    exec.AdvanceTime(500ms);
+    EXPECT_EQ(result, "done");
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(future, ready)
+{
+    coro::ManualExecutor exec;
+    auto [sender, future] = coro::MakeOneshot<int>();
+    EXPECT_TRUE(sender.Set(1));
+    EXPECT_FALSE(sender.Set(2));
+    EXPECT_TRUE(future.IsReady());
+    int result = 0;
+    exec.RunTask([&, future = future]() -> coro::Task<void> { result = co_await future; });
+    EXPECT_EQ(result, 1);
+}
+
+TEST(future, thread)
+{
+    auto [sender, future] = coro::MakeOneshot<int>();
+    int result = 0;
+    std::jthread t1([&, future = future] {
+        auto base = event_base_new();
+        {
+            coro::Executor exec(base);
+            exec.RunTask([&]() -> coro::Task<void> { result = co_await future; });
+            // 等待期间投递事件保持事件循环运行
+            event_base_dispatch(base);
+            EXPECT_EQ(exec.GetTaskCount(), 0);
+        }
+        event_base_free(base);
+    });
+    usleep(50 * 1000);
+    sender.Set(42);
+    t1.join();
+    EXPECT_EQ(result, 42);
+}
+
+TEST(future, broken)
+{
+    auto future = [] {
+        auto [sender, future] = coro::MakeOneshot<void>();
+        return future;
+    }();
+    EXPECT_THROW(future.Get(), std::future_error);
+}
+
+TEST(future, cancel)
+{
+    auto [sender, future] = coro::MakeOneshot<int>();
+    {
+        coro::ManualExecutor exec;
+        exec.RunTask([future = future]() -> coro::Task<void> { co_await future; });
+        exec.RunUntilIdle();
+        EXPECT_EQ(exec.GetTaskCount(), 1);
+    }
+    // 等待的协程已销毁, 设置结果不再唤醒
+    EXPECT_TRUE(sender.Set(1));
+}
+
+TEST(future, submit)
+{
+    coro::ThreadPool pool(2);
+    auto f1 = pool.Submit([] { return 1 + 1; });
+    auto f2 = pool.Submit([]() -> coro::Task<std::string> {
+        co_await coro::Sleep(0, 10);
+        co_return "task";
+    });
+    auto f3 = pool.Submit([]() -> int { throw std::runtime_error("error"); });
+    std::atomic_int count = 0;
+    auto f4 = pool.Submit([&] { count++; });
+    EXPECT_EQ(f1.Get(), 2);
+    EXPECT_EQ(f2.Get(), "task");
+    EXPECT_THROW(f3.Get(), std::runtime_error);
+    f4.Get();
+    EXPECT_EQ(count, 1);
+
+    // 在协程中等待另一个线程池的结果
+    coro::ThreadPool other(1);
+    auto f5 = other.Submit([&pool]() -> coro::Task<int> {
+        int sum = 0;
+        for (int i = 0; i < 10; i++)
+        {
+            sum += co_await pool.Submit([i] { return i; });
+        }
+        co_return sum;
+    });
+    EXPECT_EQ(f5.Get(), 45);
+
+    // 只能移动的函数
+    auto f7 = pool.Submit([p = std::make_unique<int>(7)] { return *p; });
+    EXPECT_EQ(f7.Get(), 7);
+
+    pool.Shutdown(coro::ShutdownPolicy::Cancel);
+    auto f6 = pool.Submit([] { return 1; });
+    EXPECT_THROW(f6.Get(), std::future_error);
+}
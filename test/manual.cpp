@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "channel.h"
+#include "manual_executor.h"
+#include "mutex.h"
+#include "select.h"
+#include "sleep.h"
+
+using namespace std::chrono_literals;
+
+TEST(manual, sleep_order)
+{
+    coro::ManualExecutor exec;
+    std::vector<int> order;
+    for (int i = 0; i < 1000; i++)
+    {
+        exec.RunTask([i, &order]() -> coro::Task<void> {
+            co_await coro::Sleep(0, 999 - i);
+            order.emplace_back(999 - i);
+        });
+    }
+    EXPECT_EQ(exec.GetTimerCount(), 1000);
+    exec.RunUntilIdle();
+    EXPECT_EQ(order.size(), 1);
+
+    auto start = std::chrono::steady_clock::now();
+    exec.AdvanceTime(998ms);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 500ms);
+    EXPECT_EQ(exec.Now(), 998ms);
+    EXPECT_EQ(exec.GetTaskCount(), 1);
+    EXPECT_EQ(exec.GetTimerCount(), 1);
+    exec.AdvanceTime(1ms);
+    ASSERT_EQ(order.size(), 1000);
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(manual, advance)
+{
+    coro::ManualExecutor exec;
+    int count = 0;
+    exec.RunTask([&count]() -> coro::Task<void> {
+        for (int i = 0; i < 10; i++)
+        {
+            co_await coro::Sleep(1);
+            count++;
+        }
+    });
+    exec.AdvanceTime(500ms);
+    EXPECT_EQ(count, 0);
+    exec.AdvanceTime(500ms);
+    EXPECT_EQ(count, 1);
+    exec.AdvanceTime(3600s);
+    EXPECT_EQ(count, 10);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(manual, channel)
+{
+    coro::ManualExecutor exec;
+    coro::Channel<int> chan;
+    std::vector<int> data;
+    exec.RunTask([&]() -> coro::Task<void> {
+        int val = 0;
+        while (co_await chan.Pop(val))
+        {
+            data.emplace_back(val);
+        }
+    });
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 10; i++)
+        {
+            chan.Push(i);
+            co_await coro::Sleep(0, 200);
+        }
+        chan.Close();
+    });
+    exec.RunUntilIdle();
+    EXPECT_EQ(data.size(), 1);
+    exec.AdvanceTime(1s);
+    EXPECT_EQ(data.size(), 6);
+    exec.AdvanceTime(1s);
+    EXPECT_EQ(data.size(), 10);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(manual, mutex)
+{
+    coro::ManualExecutor exec;
+    coro::Mutex mut;
+    std::vector<std::pair<int, int64_t>> order;
+    for (int i = 0; i < 3; i++)
+    {
+        exec.RunTask([&, i]() -> coro::Task<void> {
+            coro::LockGuard lk = co_await mut.Lock();
+            order.emplace_back(i, std::chrono::duration_cast<std::chrono::milliseconds>(exec.Now()).count());
+            co_await coro::Sleep(0, 100);
+        });
+    }
+    exec.AdvanceTime(1s);
+    ASSERT_EQ(order.size(), 3);
+    EXPECT_EQ(order[0].second, 0);
+    EXPECT_EQ(order[1].second, 100);
+    EXPECT_EQ(order[2].second, 200);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(manual, destroy)
+{
+    coro::ManualExecutor exec;
+    for (int i = 0; i < 10; i++)
+    {
+        exec.RunTask([]() -> coro::Task<void> { co_await coro::Sleep(10); });
+    }
+    exec.AdvanceTime(1s);
+    EXPECT_EQ(exec.GetTaskCount(), 10);
+    EXPECT_EQ(exec.GetTimerCount(), 10);
+}
+
+TEST(manual, ready_without_suspend)
+{
+    coro::ManualExecutor exec;
+    coro::Channel<int> chan;
+    coro::Mutex mutex;
+    int sum = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 100; i++)
+        {
+            chan.Push(i);
+            int val = 0;
+            EXPECT_TRUE(co_await chan.Pop(val));
+            coro::LockGuard lk = co_await mutex.Lock();
+            sum += val;
+        }
+        chan.Close();
+        int val = 0;
+        EXPECT_FALSE(co_await chan.Pop(val));
+    });
+    // 数据就绪与未上锁时不挂起协程
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+    EXPECT_EQ(sum, 4950);
+    EXPECT_TRUE(mutex.TryLock());
+    EXPECT_FALSE(mutex.TryLock());
+    mutex.Unlock();
+}
+
+TEST(manual, cancel_waiters)
+{
+    coro::ManualExecutor exec;
+    coro::ManualExecutor other;
+    coro::Channel<int> chan;
+    coro::Mutex mutex;
+    ASSERT_TRUE(mutex.TryLock());
+    exec.RunTask([&]() -> coro::Task<void> {
+        int val = 0;
+        co_await chan.Pop(val);
+    });
+    exec.RunTask([&]() -> coro::Task<void> { coro::LockGuard lk = co_await mutex.Lock(); });
+    bool locked = false;
+    other.RunTask([&]() -> coro::Task<void> {
+        coro::LockGuard lk = co_await mutex.Lock();
+        locked = true;
+    });
+    EXPECT_EQ(exec.GetTaskCount(), 2);
+    // 不在执行器中解锁, 唤醒最早等待的协程
+    mutex.Unlock();
+    EXPECT_EQ(exec.Cancel(), 2);
+    // 已唤醒但未处理的协程被销毁时转而唤醒下一个等待者, 撤销channel上的等待
+    other.RunUntilIdle();
+    EXPECT_TRUE(locked);
+    EXPECT_EQ(other.GetTaskCount(), 0);
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+    EXPECT_TRUE(chan.Push(1));
+    int val = 0;
+    EXPECT_TRUE(chan.TryPop(val));
+    exec.RunUntilIdle();
+}
+
+TEST(manual, select_wakeup)
+{
+    coro::ManualExecutor exec;
+    coro::Channel<int> ch1;
+    coro::Channel<int> ch2;
+    std::vector<int> values;
+    exec.RunTask([&]() -> coro::Task<void> {
+        while (co_await coro::Select(ch1, ch2))
+        {
+            int val = 0;
+            while (ch1.TryPop(val) || ch2.TryPop(val))
+            {
+                values.emplace_back(val);
+            }
+        }
+    });
+    EXPECT_EQ(exec.GetTaskCount(), 1);
+    ch2.Push(2);
+    ch1.Push(1);
+    exec.RunUntilIdle();
+    EXPECT_EQ(values, (std::vector<int>{1, 2}));
+    ch1.Close();
+    exec.RunUntilIdle();
+    EXPECT_EQ(exec.GetTaskCount(), 1);
+    ch2.Close();
+    exec.RunUntilIdle();
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(manual, post)
+{
+    coro::ManualExecutor exec;
+    int count = 0;
+    // 没有引用时不接收投递
+    EXPECT_FALSE(exec.Post([&] { count++; }));
+
+    auto keep = exec.KeepAlive();
+    std::thread([&] {
+        EXPECT_TRUE(exec.Post([&] { count++; }));
+        // 在其他线程释放引用
+        keep.reset();
+    }).join();
+    exec.RunUntilIdle();
+    EXPECT_EQ(count, 1);
+    EXPECT_FALSE(exec.Post([&] { count++; }));
+    exec.RunUntilIdle();
+    EXPECT_EQ(count, 1);
+}
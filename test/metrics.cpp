@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "channel.h"
+#include "metrics.h"
+#include "mutex.h"
+#include "sleep.h"
+#include "util.h"
+
+coro::Channel<int> metrics_chan;
+coro::Mutex metrics_mut;
+
+coro::Task<void> Produce()
+{
+    for (int i = 0; i < 10; i++)
+    {
+        metrics_chan.Push(i);
+        coro::LockGuard lk = co_await metrics_mut.Lock();
+        co_await coro::Sleep(0, 10);
+    }
+    metrics_chan.Close();
+}
+
+coro::Task<void> Consume()
+{
+    int val = 0;
+    while (co_await metrics_chan.Pop(val))
+    {
+        coro::LockGuard lk = co_await metrics_mut.Lock();
+    }
+}
+
+TEST(metrics, snapshot)
+{
+    auto before = coro::Metrics::Snapshot();
+    {
+        auto t1 = RunTask(&Consume);
+        auto t2 = RunTask(&Produce);
+    }
+    auto after = coro::Metrics::Snapshot();
+    std::stringstream ss;
+    after.Dump(ss);
+    std::cout << ss.str();
+    if constexpr (coro::kMetricsEnabled)
+    {
+        EXPECT_EQ(after.m_task_spawned - before.m_task_spawned, 2);
+        EXPECT_EQ(after.m_task_completed - before.m_task_completed, 2);
+        EXPECT_EQ(after.m_channel_push - before.m_channel_push, 10);
+        EXPECT_GE(after.m_mutex_lock - before.m_mutex_lock, 10);
+        EXPECT_GT(after.m_callback_latency.m_count, before.m_callback_latency.m_count);
+    }
+}
+
+TEST(metrics, histogram)
+{
+    coro::Histogram h;
+    for (uint64_t i = 1; i <= 100; i++)
+    {
+        h.Record(i * 1000);
+    }
+    auto snapshot = h.Snapshot();
+    EXPECT_EQ(snapshot.m_count, 100);
+    EXPECT_EQ(snapshot.m_max, 100000);
+    EXPECT_GE(snapshot.Percentile(0.5), 50000);
+    EXPECT_LE(snapshot.Percentile(0.5), 65535);
+}
@@ -0,0 +1,122 @@
+#include "parallel.h"
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <set>
+#include "sleep.h"
+#include "util.h"
+
+TEST(parallel, for_each)
+{
+    coro::ThreadPool pool(4);
+    std::vector<int64_t> data(100000);
+    std::iota(data.begin(), data.end(), 0);
+    std::mutex mut;
+    std::set<std::thread::id> threads;
+    RunLoop({[&]() -> coro::Task<void> {
+        co_await coro::ParallelFor(pool, data, [&](int64_t& v) {
+            v = v * v;
+            if (v % 1000 == 0)
+            {
+                std::lock_guard lk(mut);
+                threads.insert(std::this_thread::get_id());
+            }
+        });
+        // 按下标访问
+        co_await coro::ParallelFor(pool, std::views::iota(size_t(0), data.size()), [&](size_t i) { data[i] += 1; }, 1000);
+    }});
+    for (int64_t i = 0; i < static_cast<int64_t>(data.size()); i++)
+    {
+        ASSERT_EQ(data[i], i * i + 1);
+    }
+    EXPECT_GT(threads.size(), 1);
+}
+
+TEST(parallel, reduce)
+{
+    coro::ThreadPool pool(4);
+    std::vector<int64_t> data(1000000);
+    std::iota(data.begin(), data.end(), 1);
+    std::vector<std::string> words{"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+    int64_t sum = 0;
+    std::string joined;
+    int64_t empty = -1;
+    RunLoop({[&]() -> coro::Task<void> {
+        sum = co_await coro::ParallelReduce(pool, data, int64_t(0));
+        // 非交换的运算按块的顺序合并
+        joined = co_await coro::ParallelReduce(pool, words, std::string(">"), std::plus<>{}, 3);
+        empty = co_await coro::ParallelReduce(pool, std::vector<int64_t>{}, int64_t(7));
+    }});
+    EXPECT_EQ(sum, int64_t(1000000) * 1000001 / 2);
+    EXPECT_EQ(joined, ">abcdefghij");
+    EXPECT_EQ(empty, 7);
+}
+
+TEST(parallel, sort)
+{
+    coro::ThreadPool pool(4);
+    std::mt19937 rng(42);
+    std::vector<uint32_t> data(100003);
+    for (auto& v : data)
+    {
+        v = rng();
+    }
+    auto expect = data;
+    std::sort(expect.begin(), expect.end());
+    auto desc = data;
+    RunLoop({[&]() -> coro::Task<void> {
+        co_await coro::ParallelSort(pool, data);
+        // 块数多于线程数时逐轮归并
+        co_await coro::ParallelSort(pool, desc, std::greater<>{}, 1000);
+    }});
+    EXPECT_EQ(data, expect);
+    std::reverse(expect.begin(), expect.end());
+    EXPECT_EQ(desc, expect);
+}
+
+TEST(parallel, exception)
+{
+    coro::ThreadPool pool(2);
+    std::vector<int> data(1000, 1);
+    bool caught = false;
+    RunLoop({[&]() -> coro::Task<void> {
+        try
+        {
+            co_await coro::ParallelFor(
+                pool, data,
+                [](int v) {
+                    if (v == 1)
+                    {
+                        throw std::runtime_error("bad");
+                    }
+                },
+                100);
+        }
+        catch (const std::runtime_error& e)
+        {
+            caught = true;
+        }
+    }});
+    EXPECT_TRUE(caught);
+}
+
+TEST(parallel, not_blocking)
+{
+    coro::ThreadPool pool(2);
+    std::vector<int> data(20, 0);
+    bool done = false;
+    int ticks = 0;
+    // 并行计算期间同一事件循环上的其他协程继续运行
+    RunLoop({[&]() -> coro::Task<void> {
+                 co_await coro::ParallelFor(pool, data, [](int&) { usleep(10 * 1000); }, 1);
+                 done = true;
+             },
+             [&]() -> coro::Task<void> {
+                 while (!done)
+                 {
+                     ticks++;
+                     co_await coro::Sleep(0, 5);
+                 }
+             }});
+    EXPECT_GT(ticks, 1);
+}
@@ -0,0 +1,327 @@
+#include "pipeline.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <thread>
+#include "manual_executor.h"
+#include "sleep.h"
+#include "util.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+/**
+ * @brief 写入[0, n)后关闭
+ */
+coro::Task<void> Produce(std::shared_ptr<coro::BoundedChannel<int>> chan, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (!co_await chan->Push(i))
+        {
+            break;
+        }
+    }
+    chan->Close();
+}
+
+/**
+ * @brief 读取全部数据
+ */
+template <typename T>
+coro::Task<void> Consume(std::shared_ptr<coro::BoundedChannel<T>> chan, std::vector<T>& result)
+{
+    T value;
+    while (co_await chan->Pop(value))
+    {
+        result.emplace_back(std::move(value));
+    }
+}
+}  // namespace
+
+TEST(pipeline, bounded_channel)
+{
+    auto chan = std::make_shared<coro::BoundedChannel<int>>(4);
+    size_t max_size = 0;
+    std::vector<int> result;
+    RunLoop({[&]() -> coro::Task<void> { co_await Produce(chan, 1000); },
+             [&]() -> coro::Task<void> {
+                 int value = 0;
+                 while (co_await chan->Pop(value))
+                 {
+                     max_size = std::max(max_size, chan->Size());
+                     result.emplace_back(value);
+                 }
+             }});
+    // 写满后写入者挂起, 排队的数据不超过容量
+    EXPECT_LE(max_size, 4);
+    ASSERT_EQ(result.size(), 1000);
+    for (int i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(result[i], i);
+    }
+
+    // 超时
+    coro::ManualExecutor exec;
+    coro::BoundedChannel<int> empty(1);
+    int ret = -1;
+    exec.RunTask([&]() -> coro::Task<void> {
+        int value = 0;
+        ret = co_await empty.PopFor(value, 10ms) ? 1 : 0;
+    });
+    exec.RunUntilIdle();
+    EXPECT_EQ(ret, -1);
+    exec.AdvanceTime(10ms);
+    exec.RunUntilIdle();
+    EXPECT_EQ(ret, 0);
+}
+
+TEST(pipeline, stages)
+{
+    coro::Pipeline pipeline;
+    auto source = pipeline.Source<int>(8);
+    auto output = source.Map([](int v) { return v * 2; })
+                      .Filter([](const int& v) -> coro::Task<bool> { co_return v % 4 == 0; })
+                      .Map([](int v) { return std::to_string(v); }, {.m_name = "format"})
+                      .Batch(8, 10ms);
+    std::vector<std::vector<std::string>> batches;
+    RunLoop({[&]() -> coro::Task<void> {
+        EXPECT_TRUE(pipeline.Start());
+        EXPECT_FALSE(pipeline.Start());
+        co_await Produce(source.GetChannel(), 100);
+        co_await pipeline.Wait();
+    },
+             [&]() -> coro::Task<void> { co_await Consume(output.GetChannel(), batches); }});
+    std::vector<std::string> all;
+    for (auto& batch : batches)
+    {
+        ASSERT_LE(batch.size(), 8);
+        all.insert(all.end(), batch.begin(), batch.end());
+    }
+    ASSERT_EQ(all.size(), 50);
+    for (int i = 0; i < 50; i++)
+    {
+        ASSERT_EQ(all[i], std::to_string(i * 4));
+    }
+    auto stats = pipeline.GetStats();
+    ASSERT_EQ(stats.size(), 4);
+    EXPECT_EQ(stats[0].m_name, "map0");
+    EXPECT_EQ(stats[0].m_in, 100);
+    EXPECT_EQ(stats[1].m_out, 50);
+    EXPECT_EQ(stats[2].m_name, "format");
+    EXPECT_EQ(stats[3].m_in, 50);
+    EXPECT_EQ(stats[3].m_out, batches.size());
+}
+
+TEST(pipeline, batch_timeout)
+{
+    coro::ManualExecutor exec;
+    coro::Pipeline pipeline;
+    auto source = pipeline.Source<int>();
+    auto output = source.Batch(4, 10ms);
+    std::vector<std::vector<int>> batches;
+    ASSERT_TRUE(pipeline.Start(&exec));
+    exec.RunTask([&] { return Consume(output.GetChannel(), batches); });
+    exec.RunTask([&]() -> coro::Task<void> {
+        co_await source.GetChannel()->Push(1);
+        co_await source.GetChannel()->Push(2);
+    });
+    exec.RunUntilIdle();
+    EXPECT_TRUE(batches.empty());
+    // 第一条数据到达10ms后输出不满的一批
+    exec.AdvanceTime(10ms);
+    exec.RunUntilIdle();
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0], std::vector<int>({1, 2}));
+
+    exec.RunTask([&]() -> coro::Task<void> { co_await Produce(source.GetChannel(), 5); });
+    exec.RunUntilIdle();
+    ASSERT_EQ(batches.size(), 3);
+    EXPECT_EQ(batches[1], std::vector<int>({0, 1, 2, 3}));
+    EXPECT_EQ(batches[2], std::vector<int>({4}));
+}
+
+TEST(pipeline, stage_executor)
+{
+    auto base = event_base_new();
+    {
+        coro::Executor remote(base);
+        // 持有引用, 其他线程的投递保证送达
+        auto keep = remote.KeepAlive();
+        std::thread thread([base] { event_base_dispatch(base); });
+        auto remote_id = thread.get_id();
+        std::atomic_bool on_remote = true;
+        coro::Pipeline pipeline;
+        auto source = pipeline.Source<int>();
+        auto output = source.Map(
+            [&](int v) {
+                on_remote = on_remote && std::this_thread::get_id() == remote_id;
+                return v * 2;
+            },
+            {.m_exec = &remote});
+        std::vector<int> result;
+        RunLoop({[&]() -> coro::Task<void> {
+            EXPECT_TRUE(pipeline.Start());
+            co_await Produce(source.GetChannel(), 100);
+            co_await pipeline.Wait();
+        },
+                 [&]() -> coro::Task<void> { co_await Consume(output.GetChannel(), result); }});
+        keep.reset();
+        thread.join();
+        EXPECT_TRUE(on_remote);
+        ASSERT_EQ(result.size(), 100);
+        for (int i = 0; i < 100; i++)
+        {
+            ASSERT_EQ(result[i], i * 2);
+        }
+    }
+    event_base_free(base);
+
+    // 阶段的执行器未监听投递时以异常结束, 不会一直等待
+    coro::ManualExecutor idle;
+    coro::Pipeline pipeline;
+    auto source = pipeline.Source<int>();
+    auto output = source.Map([](int v) { return v; }, {.m_exec = &idle});
+    bool failed = false;
+    RunLoop({[&]() -> coro::Task<void> {
+        EXPECT_TRUE(pipeline.Start());
+        co_await Produce(source.GetChannel(), 100);
+        try
+        {
+            co_await pipeline.Wait();
+        }
+        catch (const std::runtime_error&)
+        {
+            failed = true;
+        }
+    }});
+    EXPECT_TRUE(failed);
+}
+
+TEST(pipeline, parallel_map)
+{
+    coro::ThreadPool pool(4);
+    for (auto order : {coro::MapOrder::Ordered, coro::MapOrder::Unordered})
+    {
+        coro::Pipeline pipeline;
+        auto source = pipeline.Source<int>();
+        std::mutex mut;
+        std::set<std::thread::id> threads;
+        auto output = source.ParallelMap(
+            8,
+            [&](int v) -> coro::Task<int> {
+                {
+                    std::lock_guard lk(mut);
+                    threads.insert(std::this_thread::get_id());
+                }
+                // 先到的数据处理得慢, 完成顺序与输入顺序不同
+                co_await coro::Sleep(0, v % 8 == 0 ? 5 : 0);
+                co_return v + 1;
+            },
+            order, {.m_pool = &pool});
+        std::vector<int> result;
+        RunLoop({[&]() -> coro::Task<void> {
+            EXPECT_TRUE(pipeline.Start());
+            co_await Produce(source.GetChannel(), 200);
+            co_await pipeline.Wait();
+        },
+                 [&]() -> coro::Task<void> { co_await Consume(output.GetChannel(), result); }});
+        ASSERT_EQ(result.size(), 200);
+        if (order == coro::MapOrder::Ordered)
+        {
+            for (int i = 0; i < 200; i++)
+            {
+                ASSERT_EQ(result[i], i + 1);
+            }
+        }
+        else
+        {
+            EXPECT_FALSE(std::is_sorted(result.begin(), result.end()));
+            std::sort(result.begin(), result.end());
+            std::vector<int> expect(200);
+            std::iota(expect.begin(), expect.end(), 1);
+            EXPECT_EQ(result, expect);
+        }
+        EXPECT_GT(threads.size(), 1);
+        auto stats = pipeline.GetStats();
+        EXPECT_EQ(stats[0].m_workers, 8);
+        EXPECT_EQ(stats[0].m_in, 200);
+        EXPECT_EQ(stats[0].m_out, 200);
+    }
+}
+
+TEST(pipeline, exception)
+{
+    coro::ThreadPool pool(2);
+    for (auto order : {coro::MapOrder::Ordered, coro::MapOrder::Unordered})
+    {
+        coro::Pipeline pipeline;
+        auto source = pipeline.Source<int>(4);
+        auto output = source
+                          .ParallelMap(
+                              2,
+                              [](int v) {
+                                  if (v == 10)
+                                  {
+                                      throw std::runtime_error("stage failed");
+                                  }
+                                  return v;
+                              },
+                              order, {.m_pool = &pool})
+                          .Map([](int v) { return v; });
+        std::vector<int> result;
+        bool caught = false;
+        RunLoop({[&]() -> coro::Task<void> {
+            pipeline.Start();
+            // 流水线取消后写入失败, 不会一直挂起
+            co_await Produce(source.GetChannel(), 100000);
+            try
+            {
+                co_await pipeline.Wait();
+            }
+            catch (const std::runtime_error& e)
+            {
+                caught = std::string(e.what()) == "stage failed";
+            }
+        },
+                 [&]() -> coro::Task<void> { co_await Consume(output.GetChannel(), result); }});
+        EXPECT_TRUE(caught);
+        EXPECT_LT(result.size(), 100000);
+    }
+}
+
+TEST(pipeline, bottleneck)
+{
+    coro::Pipeline pipeline;
+    auto source = pipeline.Source<int>(16);
+    auto output = source.Map([](int v) { return v; }, {.m_name = "fast", .m_capacity = 16})
+                      .Map(
+                          [](int v) -> coro::Task<int> {
+                              co_await coro::Sleep(0, 1);
+                              co_return v;
+                          },
+                          {.m_name = "slow", .m_capacity = 16});
+    std::vector<int> result;
+    std::vector<coro::StageStats> stats;
+    RunLoop({[&]() -> coro::Task<void> {
+        pipeline.Start();
+        auto source_chan = source.GetChannel();
+        for (int i = 0; i < 100; i++)
+        {
+            co_await source_chan->Push(i);
+        }
+        stats = pipeline.GetStats();
+        source_chan->Close();
+        co_await pipeline.Wait();
+    },
+             [&]() -> coro::Task<void> { co_await Consume(output.GetChannel(), result); }});
+    EXPECT_EQ(result.size(), 100);
+    ASSERT_EQ(stats.size(), 2);
+    // 慢阶段的输入排满, 快阶段等待下游
+    EXPECT_EQ(stats[1].m_name, "slow");
+    EXPECT_GE(stats[1].m_queued, stats[1].m_capacity / 2);
+    EXPECT_GT(stats[0].m_blocked_ns, 0);
+    EXPECT_GT(stats[1].m_busy_ns, stats[0].m_busy_ns);
+}
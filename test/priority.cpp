@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <latch>
+#include "priority.h"
+#include "thread_pool.h"
+
+TEST(priority, queue)
+{
+    coro::PriorityQueue<int> queue(4);
+    queue.Push(100, coro::Priority::Background);
+    for (int i = 0; i < 10; i++)
+    {
+        queue.Push(i, coro::Priority::High);
+    }
+    std::vector<int> order;
+    while (auto val = queue.Pop())
+    {
+        order.emplace_back(*val);
+    }
+    // 低优先级被跳过4次后取出
+    std::vector<int> expect{0, 1, 2, 3, 100, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(order, expect);
+}
+
+TEST(priority, pool)
+{
+    coro::ThreadPool pool(1);
+    std::mutex mut;
+    std::vector<int> order;
+    std::latch done(7);
+    auto record = [&](int id) -> coro::Task<void> {
+        {
+            std::lock_guard lk(mut);
+            order.emplace_back(id);
+        }
+        done.count_down();
+        co_return;
+    };
+    // 工作线程阻塞期间添加的任务在队列中按优先级排序
+    std::promise<void> started;
+    std::promise<void> gate;
+    pool.Add([&]() -> coro::Task<void> {
+        started.set_value();
+        gate.get_future().wait();
+        co_return;
+    });
+    started.get_future().wait();
+    for (int i = 0; i < 3; i++)
+    {
+        pool.Add([&record, i] { return record(i); }, coro::Priority::Background);
+    }
+    for (int i = 10; i < 13; i++)
+    {
+        pool.Add([&record, i] { return record(i); }, coro::Priority::High);
+    }
+    // 未指定优先级时保留任务预设的优先级
+    auto preset = coro::detail::MakeCoTask([&record] { return record(20); });
+    preset->m_priority = coro::Priority::High;
+    pool.Add(preset);
+    gate.set_value();
+    done.wait();
+    std::lock_guard lk(mut);
+    std::vector<int> expect{10, 11, 12, 20, 0, 1, 2};
+    EXPECT_EQ(order, expect);
+}
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <event2/dns.h>
+#include <event2/dns_struct.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include "manual_executor.h"
+#include "resolver.h"
+#include "util.h"
+
+/**
+ * @brief 本地的域名服务器, 名称以nx.开头时返回不存在, ttl0.开头时TTL为0
+ */
+class DnsStub
+{
+public:
+    explicit DnsStub(event_base* base)
+    {
+        m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{.sin_family = AF_INET, .sin_port = 0};
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_addr = "127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+        m_port = evdns_add_server_port_with_base(base, m_fd, 0, OnRequest, this);
+    }
+
+    ~DnsStub()
+    {
+        evdns_close_server_port(m_port);
+        close(m_fd);
+    }
+
+    /**
+     * @brief 回复暂存的请求
+     */
+    void Release()
+    {
+        for (auto* req : std::exchange(m_held, {}))
+        {
+            Reply(req);
+        }
+    }
+
+    static void OnRequest(evdns_server_request* req, void* arg)
+    {
+        auto* pthis = static_cast<DnsStub*>(arg);
+        for (int i = 0; i < req->nquestions; i++)
+        {
+            pthis->m_queries[Lower(req->questions[i]->name)]++;
+        }
+        if (pthis->m_hold)
+        {
+            pthis->m_held.emplace_back(req);
+            return;
+        }
+        Reply(req);
+    }
+
+    static std::string Lower(std::string name)
+    {
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        return name;
+    }
+
+    static void Reply(evdns_server_request* req)
+    {
+        for (int i = 0; i < req->nquestions; i++)
+        {
+            // 查询的名称大小写随机, 回复时原样返回
+            std::string name = req->questions[i]->name;
+            auto lower = Lower(name);
+            if (lower.starts_with("nx."))
+            {
+                evdns_server_request_respond(req, DNS_ERR_NOTEXIST);
+                return;
+            }
+            int ttl = lower.starts_with("ttl0.") ? 0 : 60;
+            if (req->questions[i]->type == EVDNS_TYPE_A)
+            {
+                in_addr addr{};
+                inet_pton(AF_INET, "10.0.0.1", &addr);
+                evdns_server_request_add_a_reply(req, name.c_str(), 1, &addr, ttl);
+            }
+            else if (req->questions[i]->type == EVDNS_TYPE_AAAA)
+            {
+                in6_addr addr{};
+                inet_pton(AF_INET6, "fd00::1", &addr);
+                evdns_server_request_add_aaaa_reply(req, name.c_str(), 1, &addr, ttl);
+            }
+        }
+        evdns_server_request_respond(req, DNS_ERR_NONE);
+    }
+
+    //! 服务器地址
+    std::string m_addr;
+    //! 每个名称的查询次数, A与AAAA分别计数
+    std::map<std::string, int> m_queries;
+    //! 是否暂存请求
+    bool m_hold = false;
+    //! 暂存的请求
+    std::vector<evdns_server_request*> m_held;
+
+private:
+    int m_fd = -1;
+    evdns_server_port* m_port = nullptr;
+};
+
+std::string ToString(const sockaddr_storage& addr)
+{
+    char buf[INET6_ADDRSTRLEN] = {};
+    if (addr.ss_family == AF_INET)
+    {
+        auto* in = reinterpret_cast<const sockaddr_in*>(&addr);
+        inet_ntop(AF_INET, &in->sin_addr, buf, sizeof(buf));
+        return std::string(buf) + ":" + std::to_string(ntohs(in->sin_port));
+    }
+    auto* in6 = reinterpret_cast<const sockaddr_in6*>(&addr);
+    inet_ntop(AF_INET6, &in6->sin6_addr, buf, sizeof(buf));
+    return "[" + std::string(buf) + "]:" + std::to_string(ntohs(in6->sin6_port));
+}
+
+TEST(resolver, numeric_and_hosts)
+{
+    auto path = "/tmp/coro_hosts_" + std::to_string(getpid());
+    std::ofstream(path) << "# comment\n10.1.2.3 MyHost.test alias.test\n::1 myhost.test\n";
+    coro::ManualExecutor exec;
+    ASSERT_TRUE(exec.GetResolver().SetOption({.m_nameservers = {"127.0.0.1:1"}, .m_hosts_path = path}));
+    std::vector<std::string> addrs;
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (auto* host : {"127.0.0.1", "::1", "myhost.test", "ALIAS.test."})
+        {
+            auto result = co_await coro::Resolve(host, 80);
+            EXPECT_EQ(result.m_error, 0);
+            for (auto& addr : result.m_addrs)
+            {
+                addrs.emplace_back(ToString(addr));
+            }
+        }
+        auto result = co_await coro::Resolve("myhost.test", 80, AF_INET6);
+        EXPECT_EQ(result.m_addrs.size(), 1);
+    });
+    exec.RunUntilIdle();
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+    EXPECT_EQ(addrs, (std::vector<std::string>{"127.0.0.1:80", "[::1]:80", "10.1.2.3:80", "[::1]:80", "10.1.2.3:80"}));
+    EXPECT_EQ(exec.GetResolver().GetStats().m_lookup, 0);
+    unlink(path.c_str());
+}
+
+TEST(resolver, cache)
+{
+    coro::ManualExecutor exec;
+    DnsStub stub(exec.EventBase());
+    ASSERT_TRUE(exec.GetResolver().SetOption({.m_nameservers = {stub.m_addr}, .m_hosts_path = ""}));
+    std::vector<std::string> addrs;
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (auto* host : {"a.test", "a.test", "ttl0.test", "ttl0.test"})
+        {
+            auto result = co_await coro::Resolve(host, 443, AF_INET);
+            EXPECT_EQ(result.m_error, 0);
+            for (auto& addr : result.m_addrs)
+            {
+                addrs.emplace_back(ToString(addr));
+            }
+        }
+    });
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    EXPECT_EQ(addrs, std::vector<std::string>(4, "10.0.0.1:443"));
+    // TTL为0的记录不缓存
+    EXPECT_EQ(stub.m_queries["a.test"], 1);
+    EXPECT_EQ(stub.m_queries["ttl0.test"], 2);
+    auto stats = exec.GetResolver().GetStats();
+    EXPECT_EQ(stats.m_cache_hit, 1);
+    EXPECT_EQ(stats.m_lookup, 3);
+}
+
+TEST(resolver, coalesce)
+{
+    coro::ManualExecutor exec;
+    DnsStub stub(exec.EventBase());
+    ASSERT_TRUE(exec.GetResolver().SetOption({.m_nameservers = {stub.m_addr}, .m_hosts_path = ""}));
+    stub.m_hold = true;
+    std::vector<std::string> addrs;
+    for (int i = 0; i < 10; i++)
+    {
+        exec.RunTask([&]() -> coro::Task<void> {
+            auto result = co_await coro::Resolve("b.test", 8080);
+            EXPECT_EQ(result.m_error, 0);
+            for (auto& addr : result.m_addrs)
+            {
+                addrs.emplace_back(ToString(addr));
+            }
+        });
+    }
+    RunUntil(exec, [&] { return stub.m_held.size() == 2; });
+    EXPECT_EQ(exec.GetTaskCount(), 10);
+    stub.Release();
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    // A与AAAA各查询一次
+    EXPECT_EQ(stub.m_queries["b.test"], 2);
+    EXPECT_EQ(exec.GetResolver().GetStats().m_coalesced, 9);
+    ASSERT_EQ(addrs.size(), 20);
+    std::sort(addrs.begin(), addrs.end());
+    EXPECT_EQ(addrs.front(), "10.0.0.1:8080");
+    EXPECT_EQ(addrs.back(), "[fd00::1]:8080");
+}
+
+TEST(resolver, error_and_cancel)
+{
+    coro::ManualExecutor exec;
+    DnsStub stub(exec.EventBase());
+    ASSERT_TRUE(exec.GetResolver().SetOption({.m_nameservers = {stub.m_addr}, .m_hosts_path = ""}));
+    exec.RunTask([&]() -> coro::Task<void> {
+        auto result = co_await coro::Resolve("nx.test", 80, AF_INET);
+        EXPECT_EQ(result.m_error, DNS_ERR_NOTEXIST);
+        EXPECT_TRUE(result.m_addrs.empty());
+    });
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+
+    // 等待期间销毁协程, 查询继续进行, 之后的解析合并到该查询并写入缓存
+    stub.m_hold = true;
+    for (int i = 0; i < 2; i++)
+    {
+        exec.RunTask([&]() -> coro::Task<void> { co_await coro::Resolve("c.test", 80, AF_INET); });
+    }
+    RunUntil(exec, [&] { return stub.m_held.size() == 1; });
+    EXPECT_EQ(exec.Cancel(), 2);
+    std::vector<size_t> counts;
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 2; i++)
+        {
+            auto result = co_await coro::Resolve("c.test", 80, AF_INET);
+            counts.emplace_back(result.m_addrs.size());
+        }
+    });
+    stub.Release();
+    RunUntil(exec, [&] { return exec.GetTaskCount() == 0; });
+    EXPECT_EQ(counts, (std::vector<size_t>{1, 1}));
+    EXPECT_EQ(stub.m_queries["c.test"], 1);
+    auto stats = exec.GetResolver().GetStats();
+    EXPECT_EQ(stats.m_coalesced, 2);
+    EXPECT_EQ(stats.m_cache_hit, 1);
+}
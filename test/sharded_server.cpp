@@ -0,0 +1,176 @@
+#include "sharded_server.h"
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "io.h"
+
+namespace
+{
+/**
+ * @brief 服务端的观测结果
+ */
+struct EchoState
+{
+    std::mutex m_mut;
+    //! 处理连接的线程
+    std::set<std::thread::id> m_threads;
+    //! 恢复后不在原线程的次数
+    std::atomic_int m_migrated = 0;
+};
+
+coro::Task<void> Echo(int fd, EchoState* state)
+{
+    auto tid = std::this_thread::get_id();
+    {
+        std::lock_guard lk(state->m_mut);
+        state->m_threads.insert(tid);
+    }
+    coro::IoAwaiter readable(fd);
+    char buf[64];
+    while (true)
+    {
+        auto n = read(fd, buf, sizeof(buf));
+        if (n > 0)
+        {
+            EXPECT_EQ(write(fd, buf, n), n);
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN)
+        {
+            co_await readable;
+            if (std::this_thread::get_id() != tid)
+            {
+                state->m_migrated++;
+            }
+            continue;
+        }
+        break;
+    }
+    close(fd);
+}
+
+int Connect(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -errno;
+    }
+    return fd;
+}
+
+bool Ping(int fd, const std::string& msg)
+{
+    if (write(fd, msg.data(), msg.size()) != static_cast<ssize_t>(msg.size()))
+    {
+        return false;
+    }
+    std::string reply(msg.size(), 0);
+    size_t got = 0;
+    while (got < reply.size())
+    {
+        auto n = read(fd, reply.data() + got, reply.size() - got);
+        if (n <= 0)
+        {
+            return false;
+        }
+        got += n;
+    }
+    return reply == msg;
+}
+}  // namespace
+
+TEST(sharded, echo)
+{
+    coro::ThreadPool pool(4);
+    EchoState state;
+    coro::ShardedServer server(pool, [&state](int fd) { return Echo(fd, &state); }, {.m_addr = "127.0.0.1"});
+    ASSERT_EQ(server.Start(), 0);
+    ASSERT_NE(server.GetPort(), 0);
+    ASSERT_EQ(server.Start(), -EALREADY);
+
+    std::vector<int> clients;
+    for (int i = 0; i < 64; i++)
+    {
+        int fd = Connect(server.GetPort());
+        ASSERT_GE(fd, 0);
+        ASSERT_TRUE(Ping(fd, "ping " + std::to_string(i)));
+        clients.emplace_back(fd);
+    }
+    // 每个连接再往返一次, 处理协程挂起后应在原线程恢复
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        ASSERT_TRUE(Ping(clients[i], "again " + std::to_string(i)));
+        close(clients[i]);
+    }
+
+    auto counts = server.GetAcceptCounts();
+    ASSERT_EQ(counts.size(), 4);
+    uint64_t total = 0;
+    size_t used = 0;
+    for (auto count : counts)
+    {
+        total += count;
+        used += count > 0;
+    }
+    EXPECT_EQ(total, 64);
+    // 按四元组哈希分配, 64个连接落在同一分片的概率可忽略
+    EXPECT_GT(used, 1);
+    EXPECT_EQ(state.m_migrated, 0);
+    std::lock_guard lk(state.m_mut);
+    EXPECT_GT(state.m_threads.size(), 1);
+}
+
+TEST(sharded, stop)
+{
+    coro::ThreadPool pool(2);
+    EchoState state;
+    coro::ShardedServer server(pool, [&state](int fd) { return Echo(fd, &state); }, {.m_addr = "127.0.0.1"});
+    ASSERT_EQ(server.Start(), 0);
+    int fd = Connect(server.GetPort());
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(Ping(fd, "before"));
+
+    server.Stop();
+    // 停止接收新连接, 已建立的连接继续处理
+    EXPECT_EQ(Connect(server.GetPort()), -ECONNREFUSED);
+    EXPECT_TRUE(Ping(fd, "after"));
+    close(fd);
+
+    // 停止后可再次启动
+    ASSERT_EQ(server.Start(), 0);
+    fd = Connect(server.GetPort());
+    ASSERT_GE(fd, 0);
+    EXPECT_TRUE(Ping(fd, "restart"));
+    close(fd);
+    server.Stop();
+}
+
+TEST(sharded, cpu_steering)
+{
+    coro::ThreadPool pool(2);
+    EchoState state;
+    coro::ShardedServer server(pool, [&state](int fd) { return Echo(fd, &state); }, {.m_addr = "127.0.0.1", .m_cpu_steering = true});
+    ASSERT_EQ(server.Start(), 0);
+    for (int i = 0; i < 8; i++)
+    {
+        int fd = Connect(server.GetPort());
+        ASSERT_GE(fd, 0);
+        EXPECT_TRUE(Ping(fd, "steer"));
+        close(fd);
+    }
+    uint64_t total = 0;
+    for (auto count : server.GetAcceptCounts())
+    {
+        total += count;
+    }
+    EXPECT_EQ(total, 8);
+}
@@ -0,0 +1,124 @@
+#include "shm_channel.h"
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <thread>
+#include "manual_executor.h"
+#include "util.h"
+
+namespace
+{
+struct Message
+{
+    uint64_t m_seq = 0;
+    char m_text[32]{};
+};
+
+/**
+ * @brief 子进程作为生产者写入count个消息后关闭, 写满时让出
+ */
+void Produce(coro::ShmChannel<Message>& chan, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        Message msg{.m_seq = i};
+        snprintf(msg.m_text, sizeof(msg.m_text), "msg %lu", i);
+        while (!chan.Push(msg))
+        {
+            std::this_thread::yield();
+        }
+    }
+    chan.Close();
+}
+
+/**
+ * @brief 消费到关闭, 校验顺序与内容
+ * @return 收到的消息数
+ */
+uint64_t Consume(coro::ShmChannel<Message>& chan)
+{
+    coro::ManualExecutor exec;
+    uint64_t received = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        Message msg;
+        while (co_await chan.Pop(msg))
+        {
+            EXPECT_EQ(msg.m_seq, received);
+            EXPECT_EQ(std::string(msg.m_text), "msg " + std::to_string(received));
+            received++;
+        }
+    });
+    RunUntilDone(exec);
+    return received;
+}
+}  // namespace
+
+TEST(shm, fork)
+{
+    auto chan = coro::ShmChannel<Message>::Create(64);
+    ASSERT_TRUE(chan);
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        // 子进程继承映射与fd
+        Produce(*chan, 100000);
+        _exit(0);
+    }
+    EXPECT_EQ(Consume(*chan), 100000);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+TEST(shm, pass_fd)
+{
+    int socks[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, socks), 0);
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        // 子进程创建channel, 经unix socket把fd交给父进程
+        close(socks[0]);
+        auto chan = coro::ShmChannel<Message>::Create(16);
+        if (!chan || !chan->SendTo(socks[1]))
+        {
+            _exit(1);
+        }
+        Produce(*chan, 1000);
+        _exit(0);
+    }
+    close(socks[1]);
+    auto chan = coro::ShmChannel<Message>::ReceiveFrom(socks[0]);
+    ASSERT_TRUE(chan);
+    EXPECT_EQ(Consume(*chan), 1000);
+    EXPECT_TRUE(chan->IsClose());
+    EXPECT_TRUE(chan->IsEmpty());
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    close(socks[0]);
+}
+
+TEST(shm, attach)
+{
+    auto chan = coro::ShmChannel<uint32_t>::Create(3);
+    ASSERT_TRUE(chan);
+    // 容量取整为4
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(chan->Push(i));
+    }
+    EXPECT_FALSE(chan->Push(4));
+
+    // 同一进程内再次映射, 两个映射共享数据
+    auto peer = coro::ShmChannel<uint32_t>::Attach(dup(chan->GetMemfd()), dup(chan->GetEventfd()));
+    ASSERT_TRUE(peer);
+    uint32_t value = 0;
+    EXPECT_TRUE(peer->TryPop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(chan->Push(4));
+
+    // 数据类型的大小不一致时拒绝映射
+    EXPECT_FALSE(coro::ShmChannel<uint64_t>::Attach(dup(chan->GetMemfd()), dup(chan->GetEventfd())));
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "manual_executor.h"
+#include "select.h"
+#include "sleep.h"
+#include "spsc_channel.h"
+#include "util.h"
+
+using namespace std::chrono_literals;
+
+TEST(spsc, full)
+{
+    coro::SpscChannel<std::string> chan(3);
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(chan.Push(std::to_string(i)));
+    }
+    EXPECT_FALSE(chan.Push("4"));
+    std::string val;
+    ASSERT_TRUE(chan.TryPop(val));
+    EXPECT_EQ(val, "0");
+    EXPECT_TRUE(chan.Push("4"));
+    chan.Close();
+    EXPECT_FALSE(chan.Push("5"));
+}
+
+TEST(spsc, manual)
+{
+    coro::ManualExecutor exec;
+    coro::SpscChannel<int> chan(4);
+    std::vector<int> data;
+    exec.RunTask([&]() -> coro::Task<void> {
+        int val = 0;
+        while (co_await chan.Pop(val))
+        {
+            data.emplace_back(val);
+        }
+    });
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 10; i++)
+        {
+            chan.Push(i);
+            co_await coro::Sleep(0, 100);
+        }
+        chan.Close();
+    });
+    exec.RunUntilIdle();
+    EXPECT_EQ(data.size(), 1);
+    exec.AdvanceTime(2s);
+    EXPECT_EQ(data.size(), 10);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
+
+TEST(spsc, thread)
+{
+    constexpr int kItems = 1000000;
+    coro::SpscChannel<int> chan(256);
+    std::jthread consumer([&] {
+        coro::ManualExecutor exec;
+        exec.RunTask([&]() -> coro::Task<void> {
+            int val = 0;
+            int expect = 0;
+            while (co_await chan.Pop(val))
+            {
+                EXPECT_EQ(val, expect++);
+            }
+            EXPECT_EQ(expect, kItems);
+        });
+        RunUntilDone(exec);
+    });
+    for (int i = 0; i < kItems;)
+    {
+        if (chan.Push(i))
+        {
+            i++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    while (!chan.IsEmpty())
+    {
+        std::this_thread::yield();
+    }
+    chan.Close();
+}
+
+TEST(spsc, select)
+{
+    coro::ManualExecutor exec;
+    coro::SpscChannel<int> spsc;
+    coro::Channel<std::string> chan;
+    int count = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        int val = 0;
+        std::string str;
+        while (co_await coro::Select(spsc, chan))
+        {
+            while (spsc.TryPop(val) || chan.TryPop(str))
+            {
+                count++;
+            }
+        }
+    });
+    exec.RunTask([&]() -> coro::Task<void> {
+        for (int i = 0; i < 5; i++)
+        {
+            co_await coro::Sleep(0, 100);
+            spsc.Push(i);
+            co_await coro::Sleep(0, 100);
+            chan.Push(std::to_string(i));
+        }
+        co_await coro::Sleep(0, 100);
+        spsc.Close();
+        chan.Close();
+    });
+    exec.AdvanceTime(550ms);
+    EXPECT_EQ(count, 5);
+    exec.AdvanceTime(1s);
+    EXPECT_EQ(count, 10);
+    EXPECT_EQ(exec.GetTaskCount(), 0);
+}
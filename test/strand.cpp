@@ -0,0 +1,270 @@
+#include "strand.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <thread>
+#include "manual_executor.h"
+#include "sleep.h"
+#include "util.h"
+
+TEST(strand, enter)
+{
+    coro::Strand strand;
+    coro::ThreadPool pool(4);
+    constexpr int kTasks = 16;
+    constexpr int kLoops = 500;
+    // 不加锁的计数, 由strand保证互斥
+    int64_t counter = 0;
+    std::atomic_int inside = 0;
+    std::atomic_bool overlap = false;
+    std::atomic_int done = 0;
+    for (int t = 0; t < kTasks; t++)
+    {
+        pool.Add([&, t]() -> coro::Task<void> {
+            for (int i = 0; i < kLoops; i++)
+            {
+                auto guard = co_await strand.Enter();
+                if (inside.fetch_add(1) != 0)
+                {
+                    overlap = true;
+                }
+                counter++;
+                if ((i + t) % 100 == 0)
+                {
+                    // 持有期间挂起, 其他协程仍不能进入
+                    co_await coro::Sleep(0, 1);
+                }
+                inside.fetch_sub(1);
+            }
+            done++;
+        });
+    }
+    while (done < kTasks)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(overlap);
+    EXPECT_EQ(counter, kTasks * kLoops);
+    EXPECT_TRUE(strand.IsIdle());
+}
+
+TEST(strand, post)
+{
+    coro::ThreadPool pool(4);
+    coro::Strand strand(pool);
+    constexpr int kThreads = 4;
+    constexpr int kTasks = 2000;
+    std::vector<std::vector<int>> seq(kThreads);
+    std::atomic_int inside = 0;
+    std::atomic_bool overlap = false;
+    std::atomic_int done = 0;
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < kThreads; t++)
+        {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < kTasks; i++)
+                {
+                    strand.Post([&, t, i]() -> coro::Task<void> {
+                        if (inside.fetch_add(1) != 0)
+                        {
+                            overlap = true;
+                        }
+                        seq[t].emplace_back(i);
+                        if (i % 500 == 0)
+                        {
+                            co_await coro::Sleep(0, 1);
+                        }
+                        inside.fetch_sub(1);
+                        done++;
+                    });
+                }
+            });
+        }
+    }
+    while (done < kThreads * kTasks)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(overlap);
+    // 同一线程投递的任务按投递顺序执行
+    for (auto& s : seq)
+    {
+        ASSERT_EQ(s.size(), kTasks);
+        for (int i = 0; i < kTasks; i++)
+        {
+            ASSERT_EQ(s[i], i);
+        }
+    }
+}
+
+TEST(strand, actor)
+{
+    coro::ThreadPool pool(4);
+    coro::Actor<std::map<std::string, int>> actor(pool);
+    constexpr int kTasks = 8;
+    std::atomic_int done = 0;
+    for (int t = 0; t < kTasks; t++)
+    {
+        pool.Add([&, t]() -> coro::Task<void> {
+            for (int i = 0; i < 100; i++)
+            {
+                actor.Tell([](auto& state) { state["tell"]++; });
+                int value = co_await actor.Ask([t](auto& state) { return ++state["ask" + std::to_string(t % 2)]; });
+                EXPECT_GT(value, 0);
+                co_await actor.Ask([](auto& state) -> coro::Task<void> {
+                    state["async"]++;
+                    co_await coro::Sleep(0, 0);
+                    state["async"]++;
+                });
+            }
+            done++;
+        });
+    }
+    while (done < kTasks || !actor.GetStrand().IsIdle())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::map<std::string, int> result;
+    RunLoop({[&]() -> coro::Task<void> { result = co_await actor.Ask([](auto& s) { return s; }); }});
+    EXPECT_EQ(result["tell"], kTasks * 100);
+    EXPECT_EQ(result["ask0"] + result["ask1"], kTasks * 100);
+    EXPECT_EQ(result["async"], kTasks * 200);
+}
+
+TEST(strand, cancel_waiter)
+{
+    coro::Strand strand;
+    coro::ManualExecutor holder_exec;
+    coro::ManualExecutor waiter_exec;
+    bool release = false;
+    holder_exec.RunTask([&]() -> coro::Task<void> {
+        auto guard = co_await strand.Enter();
+        while (!release)
+        {
+            co_await coro::Sleep(0, 1);
+        }
+    });
+    bool entered = false;
+    waiter_exec.RunTask([&]() -> coro::Task<void> {
+        auto guard = co_await strand.Enter();
+        entered = true;
+    });
+    waiter_exec.RunUntilIdle();
+    EXPECT_FALSE(entered);
+    // 排队的协程被销毁, 轮到时跳过
+    EXPECT_EQ(waiter_exec.Cancel(), 1);
+
+    release = true;
+    holder_exec.AdvanceTime(std::chrono::milliseconds(1));
+    holder_exec.RunUntilIdle();
+    EXPECT_TRUE(strand.IsIdle());
+    holder_exec.RunTask([&]() -> coro::Task<void> {
+        auto guard = co_await strand.Enter();
+        entered = true;
+    });
+    EXPECT_TRUE(entered);
+}
+
+TEST(strand, executor_thread)
+{
+    auto base = event_base_new();
+    {
+        coro::Executor remote(base);
+        // 持有引用, 其他线程的投递保证送达
+        auto keep = remote.KeepAlive();
+        std::thread thread([base] { event_base_dispatch(base); });
+        auto remote_id = thread.get_id();
+        coro::Strand strand(&remote);
+        coro::ThreadPool pool(2);
+        constexpr int kTasks = 1000;
+        std::atomic_bool on_remote = true;
+        std::atomic_int done = 0;
+        int64_t counter = 0;
+        for (int i = 0; i < kTasks; i++)
+        {
+            // 在非执行器线程投递
+            EXPECT_TRUE(strand.Post([&, i]() -> coro::Task<void> {
+                on_remote = on_remote && std::this_thread::get_id() == remote_id;
+                counter++;
+                if (i % 100 == 0)
+                {
+                    co_await coro::Sleep(0, 1);
+                }
+                done++;
+            }));
+            if (i % 10 == 0)
+            {
+                // 在线程池中离开时, 执行权经投递交给执行器上的任务
+                pool.Add([&]() -> coro::Task<void> {
+                    auto guard = co_await strand.Enter();
+                    counter++;
+                    done++;
+                });
+            }
+        }
+        while (done < kTasks + kTasks / 10)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        keep.reset();
+        thread.join();
+        EXPECT_TRUE(on_remote);
+        EXPECT_EQ(counter, kTasks + kTasks / 10);
+        EXPECT_TRUE(strand.IsIdle());
+    }
+    event_base_free(base);
+}
+
+TEST(strand, post_fail)
+{
+    // 未指定执行器且不在执行器中
+    coro::Strand strand;
+    EXPECT_FALSE(strand.Post([]() -> coro::Task<void> { co_return; }));
+    EXPECT_TRUE(strand.IsIdle());
+
+    // 执行器未监听投递
+    coro::ManualExecutor idle;
+    coro::Strand idle_strand(&idle);
+    EXPECT_FALSE(idle_strand.Post([]() -> coro::Task<void> { co_return; }));
+    EXPECT_TRUE(idle_strand.IsIdle());
+
+    // 线程池已停止
+    coro::ThreadPool pool(1);
+    coro::Strand pool_strand(pool);
+    pool.Shutdown(coro::ShutdownPolicy::Drain);
+    EXPECT_FALSE(pool_strand.Post([]() -> coro::Task<void> { co_return; }));
+    EXPECT_TRUE(pool_strand.IsIdle());
+}
+
+TEST(strand, exception)
+{
+    coro::ThreadPool pool(1);
+    coro::Actor<int> actor(pool);
+    std::mutex mut;
+    std::vector<std::string> errors;
+    actor.GetStrand().SetExceptionHandler([&](std::exception_ptr e) {
+        try
+        {
+            std::rethrow_exception(e);
+        }
+        catch (const std::exception& ex)
+        {
+            std::lock_guard lk(mut);
+            errors.emplace_back(ex.what());
+        }
+    });
+    EXPECT_TRUE(actor.Tell([](int& state) {
+        state++;
+        throw std::runtime_error("tell");
+    }));
+    // 异常不影响后续消息
+    std::atomic_int value = 0;
+    EXPECT_TRUE(actor.Tell([&](int& state) { value = ++state; }));
+    while (value == 0 || !actor.GetStrand().IsIdle())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(value, 2);
+    std::lock_guard lk(mut);
+    EXPECT_EQ(errors, std::vector<std::string>{"tell"});
+}
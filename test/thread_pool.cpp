@@ -1,5 +1,6 @@
 #include "thread_pool.h"
 #include <gtest/gtest.h>
+#include <set>
 #include "util.h"
 #include "sleep.h"
 
@@ -19,4 +20,157 @@ TEST(t, pool)
         pool.Add([]{return Sleep();});
     }
     sleep(3);
-}
\ No newline at end of file
+}
+std::unique_ptr<coro::ThreadPool> drain_pool;
+
+coro::Task<void> LongSleep()
+{
+    co_await coro::Sleep(10);
+    co_return;
+}
+
+coro::Task<void> DrainPool()
+{
+    auto stats = co_await drain_pool->Drain(std::chrono::milliseconds(1500));
+    std::cout << "drained " << stats.m_drained << " cancelled " << stats.m_cancelled << std::endl;
+    EXPECT_EQ(stats.m_drained, 4);
+    EXPECT_EQ(stats.m_cancelled, 2);
+    EXPECT_FALSE(drain_pool->Add([] { return Sleep(); }));
+    co_return;
+}
+
+TEST(t, drain)
+{
+    drain_pool = std::make_unique<coro::ThreadPool>(2);
+    for (auto i = 0; i < 4; i++)
+    {
+        drain_pool->Add([] { return Sleep(); });
+    }
+    drain_pool->Add([] { return LongSleep(); });
+    drain_pool->Add([] { return LongSleep(); });
+    usleep(100 * 1000);
+    {
+        auto t = RunTask(&DrainPool);
+    }
+    drain_pool.reset();
+}
+
+TEST(t, shutdown)
+{
+    coro::ThreadPool pool(2);
+    for (auto i = 0; i < 4; i++)
+    {
+        pool.Add([] { return LongSleep(); });
+    }
+    usleep(100 * 1000);
+    auto stats = pool.Shutdown(coro::ShutdownPolicy::Cancel);
+    EXPECT_EQ(stats.m_cancelled, 4);
+    EXPECT_EQ(stats.m_drained, 0);
+}
+
+coro::Task<void> Busy()
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+    co_return;
+}
+
+TEST(t, resize)
+{
+    coro::ThreadPoolOption option{.m_min = 1, .m_max = 4, .m_interval = std::chrono::milliseconds(20), .m_grow_depth = 1, .m_hysteresis = 2};
+    coro::ThreadPool pool(option);
+    for (auto i = 0; i < 100; i++)
+    {
+        pool.Add([] { return Busy(); });
+    }
+    size_t max_count = 0;
+    for (auto i = 0; i < 50; i++)
+    {
+        max_count = std::max(max_count, pool.GetWorkerCount());
+        usleep(20 * 1000);
+    }
+    std::cout << "max worker " << max_count << " now " << pool.GetWorkerCount() << std::endl;
+    EXPECT_GT(max_count, 1);
+    EXPECT_EQ(pool.GetWorkerCount(), 1);
+}
+
+TEST(t, resize_pinned)
+{
+    coro::ThreadPoolOption option{.m_min = 1, .m_max = 4, .m_interval = std::chrono::milliseconds(20), .m_grow_depth = 1, .m_hysteresis = 2};
+    coro::ThreadPool pool(option);
+    for (auto i = 0; i < 100; i++)
+    {
+        pool.Add([] { return Busy(); });
+    }
+    while (pool.GetWorkerCount() < 2)
+    {
+        usleep(5 * 1000);
+    }
+    // 固定到最后一个线程的任务在缩容期间不迁移
+    std::mutex mut;
+    std::set<std::thread::id> ids;
+    std::atomic_bool done = false;
+    ASSERT_TRUE(pool.AddTo(pool.GetWorkerCount() - 1, [&]() -> coro::Task<void> {
+        for (int i = 0; i < 40; i++)
+        {
+            {
+                std::lock_guard lk(mut);
+                ids.emplace(std::this_thread::get_id());
+            }
+            co_await coro::Sleep(0, 20);
+        }
+        done = true;
+    }));
+    while (!done || pool.GetWorkerCount() > 1)
+    {
+        usleep(5 * 1000);
+    }
+    std::lock_guard lk(mut);
+    EXPECT_EQ(ids.size(), 1);
+}
+
+TEST(t, batch)
+{
+    coro::ThreadPool pool(3);
+    std::atomic_int count = 0;
+    std::mutex mut;
+    std::set<std::thread::id> threads;
+    auto make = [&] {
+        return [&]() -> coro::Task<void> {
+            {
+                std::lock_guard lk(mut);
+                threads.insert(std::this_thread::get_id());
+            }
+            count++;
+            co_return;
+        };
+    };
+    std::vector<decltype(make())> batch;
+    for (int i = 0; i < 99; i++)
+    {
+        batch.emplace_back(make());
+    }
+    EXPECT_TRUE(pool.AddBatch(std::move(batch)));
+    // 任务数少于线程数
+    std::vector<decltype(make())> small{make(), make()};
+    EXPECT_TRUE(pool.AddBatch(small));
+    // 只能移动的函数不经过std::function
+    auto owned = std::make_unique<int>(1);
+    EXPECT_TRUE(pool.Add([&count, owned = std::move(owned)]() -> coro::Task<void> {
+        count += *owned;
+        co_return;
+    }));
+    while (count < 102)
+    {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard lk(mut);
+        // 一批任务均分到每个线程
+        EXPECT_EQ(threads.size(), 3);
+    }
+    pool.Shutdown(coro::ShutdownPolicy::Drain);
+    EXPECT_FALSE(pool.AddBatch(small));
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include "sleep.h"
+#include "trace.h"
+
+event_base* trace_base = nullptr;
+std::unique_ptr<coro::Executor> trace_exec;
+
+coro::Task<void> Inner()
+{
+    co_await coro::Sleep(0, 100);
+}
+
+coro::Task<void> Outer()
+{
+    co_await Inner();
+}
+
+void Start(evutil_socket_t, short, void*)
+{
+    trace_exec->RunTask([] { return Outer(); });
+    std::stringstream ss;
+    trace_exec->DumpStack(ss);
+    std::cout << ss.str();
+    if constexpr (coro::kTraceEnabled)
+    {
+        EXPECT_NE(ss.str().find("Inner"), std::string::npos);
+        EXPECT_NE(ss.str().find("Outer"), std::string::npos);
+    }
+}
+
+TEST(trace, stack)
+{
+    coro::Trace::Clear();
+    trace_base = event_base_new();
+    trace_exec = std::make_unique<coro::Executor>(trace_base);
+    timeval tv{.tv_sec = 0, .tv_usec = 0};
+    event_base_once(trace_base, -1, EV_TIMEOUT, Start, nullptr, &tv);
+    event_base_dispatch(trace_base);
+    trace_exec.reset();
+    event_base_free(trace_base);
+
+    std::stringstream ss;
+    coro::Trace::DumpChromeTrace(ss);
+    std::cout << ss.str();
+    if constexpr (coro::kTraceEnabled)
+    {
+        auto events = coro::Trace::Collect();
+        ASSERT_EQ(events.size(), 2);
+        EXPECT_EQ(events[0].m_type, coro::TraceType::Suspend);
+        EXPECT_EQ(events[1].m_type, coro::TraceType::Resume);
+    }
+}
+
+TEST(trace, concurrent_collect)
+{
+    coro::Trace::Clear();
+    constexpr uintptr_t kEvents = coro::kTraceCapacity * 8;
+    std::atomic_bool done = false;
+    std::thread writer([&] {
+        auto location = std::source_location::current();
+        for (uintptr_t i = 1; i <= kEvents; i++)
+        {
+            auto type = i % 2 ? coro::TraceType::Suspend : coro::TraceType::Resume;
+            coro::Trace::Record(type, reinterpret_cast<const void*>(i), location);
+        }
+        done = true;
+    });
+    // 写入者绕回覆盖时读取, 不完整的事件被跳过
+    size_t collected = 0;
+    while (!done)
+    {
+        for (auto& e : coro::Trace::Collect())
+        {
+            auto i = reinterpret_cast<uintptr_t>(e.m_frame);
+            ASSERT_TRUE(i >= 1 && i <= kEvents);
+            ASSERT_EQ(e.m_type, i % 2 ? coro::TraceType::Suspend : coro::TraceType::Resume);
+            collected++;
+        }
+    }
+    writer.join();
+    EXPECT_EQ(coro::Trace::Collect().size(), coro::kTraceCapacity);
+    std::cout << "collected " << collected << " events while writing" << std::endl;
+    coro::Trace::Clear();
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include "manual_executor.h"
+#include "udp_socket.h"
+#include "util.h"
+
+TEST(udp, batch)
+{
+    coro::ManualExecutor exec;
+    coro::UdpSocket rx;
+    coro::UdpSocket tx;
+    ASSERT_EQ(rx.Bind("127.0.0.1", 0), 0);
+    ASSERT_EQ(tx.Connect("127.0.0.1", rx.GetPort()), 0);
+
+    coro::PacketPool out(100, 64);
+    auto batch = out.Datagrams();
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        batch[i].m_len = snprintf(batch[i].m_data, batch[i].m_capacity, "packet %zu", i);
+    }
+    coro::PacketPool in(32, 2048);
+    std::vector<std::string> received;
+    int calls = 0;
+    exec.RunTask([&]() -> coro::Task<void> {
+        while (received.size() < 100)
+        {
+            auto n = co_await rx.RecvBatch(in.Datagrams());
+            EXPECT_GT(n, 0);
+            if (n <= 0)
+            {
+                co_return;
+            }
+            calls++;
+            for (auto& dgram : in.Datagrams(n))
+            {
+                EXPECT_FALSE(dgram.m_truncated);
+                EXPECT_EQ(dgram.m_addr.ss_family, AF_INET);
+                received.emplace_back(dgram.m_data, dgram.m_len);
+            }
+        }
+    });
+    exec.RunTask([&]() -> coro::Task<void> {
+        EXPECT_EQ(co_await tx.SendBatch(out.Datagrams()), 100);
+    });
+    RunUntilDone(exec);
+
+    ASSERT_EQ(received.size(), 100);
+    for (size_t i = 0; i < received.size(); i++)
+    {
+        EXPECT_EQ(received[i], "packet " + std::to_string(i));
+    }
+    // 一次唤醒收取一批
+    EXPECT_LE(calls, 8);
+}
+
+TEST(udp, gso_gro)
+{
+    coro::ManualExecutor exec;
+    coro::UdpSocket rx({.m_gro = true});
+    coro::UdpSocket tx({.m_gso = true});
+    ASSERT_EQ(rx.Bind("127.0.0.1", 0), 0);
+    ASSERT_EQ(tx.Open(AF_INET), 0);
+    std::cout << "gso " << tx.IsGsoEnabled() << " gro " << rx.IsGroEnabled() << std::endl;
+
+    // 发往同一地址的等长数据报, 最后一个较短
+    coro::PacketPool out(40, 1000);
+    auto batch = out.Datagrams();
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(rx.GetPort());
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        batch[i].m_len = i + 1 == batch.size() ? 500 : 1000;
+        memset(batch[i].m_data, static_cast<int>(i), batch[i].m_len);
+        memcpy(&batch[i].m_addr, &addr, sizeof(addr));
+        batch[i].m_addr_len = sizeof(addr);
+    }
+
+    coro::PacketPool in(8, 65535);
+    std::vector<std::string> received;
+    exec.RunTask([&]() -> coro::Task<void> {
+        while (received.size() < 40)
+        {
+            auto n = co_await rx.RecvBatch(in.Datagrams());
+            EXPECT_GT(n, 0);
+            if (n <= 0)
+            {
+                co_return;
+            }
+            for (auto& dgram : in.Datagrams(n))
+            {
+                // 按GRO分段大小拆分
+                size_t segment = dgram.m_segment ? dgram.m_segment : dgram.m_len;
+                for (size_t off = 0; off < dgram.m_len; off += segment)
+                {
+                    received.emplace_back(dgram.m_data + off, std::min(segment, dgram.m_len - off));
+                }
+            }
+        }
+    });
+    exec.RunTask([&]() -> coro::Task<void> {
+        EXPECT_EQ(co_await tx.SendBatch(out.Datagrams()), 40);
+    });
+    RunUntilDone(exec);
+
+    ASSERT_EQ(received.size(), 40);
+    for (size_t i = 0; i < received.size(); i++)
+    {
+        EXPECT_EQ(received[i], std::string(i + 1 == received.size() ? 500 : 1000, static_cast<char>(i)));
+    }
+}
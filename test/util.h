@@ -1,8 +1,12 @@
 #ifndef CORO_UTIL_H
 #define CORO_UTIL_H
 
+#include <functional>
+#include <iostream>
 #include <thread>
+#include <vector>
 #include "executor.h"
+#include "manual_executor.h"
 #include "task.h"
 
 struct TaskCtx
@@ -25,21 +29,59 @@ std::jthread RunTask(coro::Task<void>(* func)())
 {
     std::jthread t1([func]{
         auto base = event_base_new();
-        coro::Executor exec(base);
-        TaskCtx ctx;
-        ctx.m_exec = &exec;
-        ctx.m_func = func;
-        timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = 0;
-        event_base_once(base, -1, EV_TIMEOUT, AddTask, &ctx, &tv);
-        event_base_dispatch(base);
+        {
+            coro::Executor exec(base);
+            TaskCtx ctx;
+            ctx.m_exec = &exec;
+            ctx.m_func = func;
+            timeval tv;
+            tv.tv_sec = 0;
+            tv.tv_usec = 0;
+            event_base_once(base, -1, EV_TIMEOUT, AddTask, &ctx, &tv);
+            event_base_dispatch(base);
+            std::cout << "task_count : " << exec.GetTaskCount() << std::endl;
+        }
         event_base_free(base);
-        std::cout << "task_count : " << exec.GetTaskCount() << std::endl;
     });
     return t1;
 }
 
+/**
+ * @brief 运行事件循环直到条件满足
+ */
+inline void RunUntil(coro::ManualExecutor& exec, const std::function<bool()>& cond)
+{
+    while (!cond())
+    {
+        event_base_loop(exec.EventBase(), EVLOOP_ONCE);
+    }
+}
+
+/**
+ * @brief 运行事件循环直到协程全部结束
+ */
+inline void RunUntilDone(coro::ManualExecutor& exec)
+{
+    RunUntil(exec, [&exec] { return exec.GetTaskCount() == 0; });
+}
+
+/**
+ * @brief 在当前线程运行事件循环, 直到协程全部结束
+ */
+inline void RunLoop(const std::vector<std::function<coro::Task<void>()>>& funcs)
+{
+    auto base = event_base_new();
+    {
+        coro::Executor exec(base);
+        for (auto& func : funcs)
+        {
+            exec.RunTask(func);
+        }
+        event_base_dispatch(base);
+    }
+    event_base_free(base);
+}
+
 struct Data
 {
     Data() = default;
@@ -2,6 +2,9 @@
 
 namespace coro
 {
+//! 每次通知最多启动的任务数, 超出部分让出给已挂起的协程后继续
+static constexpr size_t kTaskBudget = 64;
+
 ThreadContext::ThreadContext()
     : m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
 {}
@@ -21,46 +24,159 @@ bool ThreadContext::IsStop()
     return m_stop;
 }
 
-void ThreadContext::Stop()
+void ThreadContext::Stop(ShutdownPolicy policy, std::chrono::milliseconds timeout, int notify_fd)
 {
-    m_stop = true;
+    {
+        std::lock_guard lk(m_mut);
+        m_policy = policy;
+        m_timeout = timeout;
+        m_notify_fd = notify_fd;
+        m_stop = true;
+    }
     eventfd_write(m_fd, 1);
 }
 
+ShutdownPolicy ThreadContext::GetPolicy() const
+{
+    return m_policy;
+}
+
+std::chrono::milliseconds ThreadContext::GetTimeout() const
+{
+    return m_timeout;
+}
+
+void ThreadContext::Finish(const ShutdownStats& stats)
+{
+    int notify_fd = -1;
+    {
+        std::lock_guard lk(m_mut);
+        m_stats = stats;
+        m_done = true;
+        notify_fd = m_notify_fd;
+    }
+    if (notify_fd >= 0)
+    {
+        eventfd_write(notify_fd, 1);
+    }
+}
+
+bool ThreadContext::IsDone()
+{
+    return m_done;
+}
+
+ShutdownStats ThreadContext::GetStats()
+{
+    std::lock_guard lk(m_mut);
+    return m_stats;
+}
+
 std::shared_ptr<CoTask> ThreadContext::Pop()
 {
     std::lock_guard lk(m_mut);
-    if (m_task_queue.empty())
+    return m_task_queue.Pop().value_or(nullptr);
+}
+
+bool ThreadContext::Push(const std::shared_ptr<CoTask>& task)
+{
+    std::lock_guard lk(m_mut);
+    if (m_stop)
+    {
+        return false;
+    }
+    m_task_queue.Push(task, task->m_priority);
+    if constexpr (kMetricsEnabled)
     {
-        return nullptr;
+        Metrics::Local().m_queue_depth_max.Update(m_task_queue.Size());
     }
-    auto task = m_task_queue.front();
-    m_task_queue.pop();
-    return task;
+    eventfd_write(m_fd, 1);
+    return true;
 }
 
-void ThreadContext::Push(const std::shared_ptr<CoTask>& task)
+bool ThreadContext::Push(std::span<const std::shared_ptr<CoTask>> tasks)
 {
     std::lock_guard lk(m_mut);
-    m_task_queue.emplace(task);
+    if (m_stop)
+    {
+        return false;
+    }
+    for (auto& task : tasks)
+    {
+        m_task_queue.Push(task, task->m_priority);
+    }
+    if constexpr (kMetricsEnabled)
+    {
+        Metrics::Local().m_queue_depth_max.Update(m_task_queue.Size());
+    }
     eventfd_write(m_fd, 1);
+    return true;
+}
+
+PriorityQueue<std::shared_ptr<CoTask>> ThreadContext::TakeAll()
+{
+    std::lock_guard lk(m_mut);
+    return std::exchange(m_task_queue, PriorityQueue<std::shared_ptr<CoTask>>());
+}
+
+size_t ThreadContext::Size()
+{
+    std::lock_guard lk(m_mut);
+    return m_task_queue.Size();
+}
+
+size_t ThreadContext::Clear()
+{
+    std::lock_guard lk(m_mut);
+    auto count = m_task_queue.Size();
+    m_task_queue = PriorityQueue<std::shared_ptr<CoTask>>();
+    return count;
 }
 
 Worker::Worker(std::shared_ptr<ThreadContext> ctx, int32_t id)
     : m_id(id)
     , m_ctx(std::move(ctx))
+    , m_base(event_base_new())
+    , m_exec(std::make_unique<Executor>(m_base))
     , m_thread(&Worker::Run, this)
 {}
 
+Worker::~Worker()
+{
+    Join();
+    m_exec.reset();
+    event_base_free(m_base);
+}
+
+void Worker::Join()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+uint64_t Worker::GetBusyTime() const
+{
+    return m_exec->GetBusyTime();
+}
+
 void Worker::Run()
 {
-    m_base = event_base_new();
-    m_exec = std::make_unique<Executor>(m_base);
     auto ev = event_new(m_base, m_ctx->GetEventfd(), EV_READ | EV_PERSIST, OnNotify, this);
     event_add(ev, nullptr);
+    // 事件循环由停止通知退出, 常驻监听投递, 其他线程随时可投递到本线程的执行器
+    m_exec->Ref();
     event_base_dispatch(m_base);
+    // 事件循环退出后仍挂起的协程在event_base释放前销毁, 保证awaiter持有的事件被释放
+    Finish();
+    if (m_timer)
+    {
+        event_free(m_timer);
+        m_timer = nullptr;
+    }
     event_free(ev);
-    event_base_free(m_base);
+    m_ctx->Finish(m_stats);
 }
 
 void Worker::OnNotify(evutil_socket_t, short, void* ptr)
@@ -69,68 +185,341 @@ void Worker::OnNotify(evutil_socket_t, short, void* ptr)
     pthis->Handle();
 }
 
+void Worker::OnTimeout(evutil_socket_t, short, void* ptr)
+{
+    auto* pthis = static_cast<Worker*>(ptr);
+    pthis->Finish();
+}
+
 void Worker::Handle()
 {
     eventfd_t val = 0;
     eventfd_read(m_ctx->GetEventfd(), &val);
-    if (!m_ctx->IsStop())
+    if (m_ctx->IsStop())
+    {
+        Shutdown();
+        return;
+    }
+
+    for (size_t i = 0; i < kTaskBudget; i++)
+    {
+        auto task = m_ctx->Pop();
+        if (!task)
+        {
+            return;
+        }
+        m_exec->RunTask(task);
+    }
+    // 队列中还有任务, 下一轮事件循环继续
+    eventfd_write(m_ctx->GetEventfd(), 1);
+}
+
+void Worker::Shutdown()
+{
+    if (m_finished)
+    {
+        return;
+    }
+
+    if (m_ctx->GetPolicy() == ShutdownPolicy::Cancel)
     {
+        m_stats.m_dropped += m_ctx->Clear();
+        Finish();
+        return;
+    }
+
+    if (!m_shutdown)
+    {
+        m_shutdown = true;
+        // 已入队的任务视为已接收, 先执行再一起等待
+        m_drain_count = m_exec->GetTaskCount();
         while (auto task = m_ctx->Pop())
         {
             m_exec->RunTask(task);
+            m_drain_count++;
+        }
+
+        if (m_exec->GetTaskCount() == 0)
+        {
+            Finish();
+            return;
         }
+        m_exec->SetIdleCallback([this] { Finish(); });
     }
 
-    if (m_ctx->IsStop())
+    // 退役的线程可能被再次停止, 此时以新的超时为准
+    auto timeout = m_ctx->GetTimeout();
+    if (!m_timer && timeout != std::chrono::milliseconds::max())
+    {
+        auto sec = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        auto usec = std::chrono::duration_cast<std::chrono::microseconds>(timeout - sec);
+        timeval tv{.tv_sec = static_cast<time_t>(sec.count()), .tv_usec = static_cast<suseconds_t>(usec.count())};
+        m_timer = evtimer_new(m_base, OnTimeout, this);
+        evtimer_add(m_timer, &tv);
+    }
+}
+
+void Worker::Finish()
+{
+    if (m_finished)
     {
-        event_base_loopbreak(m_base);
         return;
     }
+    m_finished = true;
+    m_stats.m_cancelled = m_exec->Cancel();
+    m_stats.m_drained = m_drain_count - std::min(m_drain_count, m_stats.m_cancelled);
+    event_base_loopbreak(m_base);
 }
 
 ThreadPool::ThreadPool(size_t num)
-    : m_num(num)
+    : ThreadPool(ThreadPoolOption{.m_min = num, .m_max = num})
+{}
+
+ThreadPool::ThreadPool(const ThreadPoolOption& option)
+    : m_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+    , m_option(option)
 {
-    for (size_t i = 0; i < m_num; i++)
+    m_option.m_max = std::max(m_option.m_min, m_option.m_max);
+    for (size_t i = 0; i < m_option.m_min; i++)
+    {
+        Grow();
+    }
+    if (m_option.m_max > m_option.m_min)
     {
-        auto ctx = std::make_shared<ThreadContext>();
-        m_thread_pool.emplace_back(std::make_unique<Worker>(ctx, i));
-        m_ctx_vect.emplace_back(ctx);
+        m_monitor = std::jthread([this](const std::stop_token& token) { Monitor(token); });
     }
 }
 
 ThreadPool::~ThreadPool()
 {
-    for (auto& ctx : m_ctx_vect)
+    Shutdown(ShutdownPolicy::Cancel);
+    close(m_fd);
+}
+
+bool ThreadPool::Add(const std::function<Task<void>()>& task, Priority priority)
+{
+    return Add(std::make_shared<FunctionTask<std::function<Task<void>()>>>(task), priority);
+}
+
+bool ThreadPool::Add(const std::shared_ptr<CoTask>& task, std::optional<Priority> priority)
+{
+    std::lock_guard lk(m_mut);
+    if (m_stop)
+    {
+        return false;
+    }
+    if (priority)
+    {
+        task->m_priority = *priority;
+    }
+    m_idx = (m_idx + 1) % m_ctx_vect.size();
+    return m_ctx_vect[m_idx]->Push(task);
+}
+
+bool ThreadPool::AddTo(size_t idx, const std::function<Task<void>()>& task, Priority priority)
+{
+    auto cotask = std::make_shared<FunctionTask<std::function<Task<void>()>>>(task);
+    std::lock_guard lk(m_mut);
+    if (m_stop)
     {
-        ctx->Stop();
+        return false;
     }
+    cotask->m_priority = priority;
+    cotask->m_pinned = true;
+    return m_ctx_vect[idx % m_ctx_vect.size()]->Push(cotask);
 }
 
-void ThreadPool::Add(const std::function<Task<void>()>& task)
+bool ThreadPool::PushBatch(std::vector<std::shared_ptr<CoTask>>& batch)
 {
-    struct T : CoTask
+    std::lock_guard lk(m_mut);
+    if (m_stop)
     {
-        explicit T(const std::function<Task<void>()>& t)
-            : m_user_task(t)
-        {}
-        Task<void> CoHandle() override
+        return false;
+    }
+    auto num = m_ctx_vect.size();
+    auto size = batch.size();
+    std::span<const std::shared_ptr<CoTask>> tasks(batch);
+    // 从轮转位置开始, 每个线程分得一段连续的任务
+    for (size_t i = 0; i < num; i++)
+    {
+        auto begin = size * i / num;
+        auto end = size * (i + 1) / num;
+        if (begin == end)
         {
-            co_await m_user_task();
-            co_return;
+            continue;
         }
-        std::function<Task<void>()> m_user_task;
-    };
+        m_idx = (m_idx + 1) % num;
+        m_ctx_vect[m_idx]->Push(tasks.subspan(begin, end - begin));
+    }
+    return true;
+}
+
+ShutdownStats ThreadPool::Shutdown(ShutdownPolicy policy, std::chrono::milliseconds timeout)
+{
+    Stop(policy, timeout, -1);
+    for (auto& worker : m_thread_pool)
+    {
+        worker->Join();
+    }
+    for (auto& worker : m_retired)
+    {
+        worker->Join();
+    }
+    return GetStats();
+}
+
+Task<ShutdownStats> ThreadPool::Drain(std::chrono::milliseconds timeout)
+{
+    Stop(ShutdownPolicy::Drain, timeout, m_fd);
+    EventFdAwaiter awaiter(m_fd);
+    while (!IsDone())
+    {
+        co_await awaiter;
+    }
+    co_return GetStats();
+}
+
+size_t ThreadPool::GetWorkerCount()
+{
     std::lock_guard lk(m_mut);
-    m_ctx_vect[m_idx]->Push(std::make_shared<T>(task));
-    m_idx = (m_idx + 1) % m_num;
+    return m_ctx_vect.size();
+}
+
+void ThreadPool::Monitor(const std::stop_token& token)
+{
+    size_t grow_hits = 0;
+    size_t shrink_hits = 0;
+    auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(m_option.m_interval).count();
+    std::unique_lock lk(m_mut);
+    while (!m_cv.wait_for(lk, token, m_option.m_interval, [] { return false; }) && !token.stop_requested())
+    {
+        Reap();
+        size_t depth = 0;
+        double load = 0;
+        for (size_t i = 0; i < m_ctx_vect.size(); i++)
+        {
+            depth += m_ctx_vect[i]->Size();
+            auto* worker = m_thread_pool[i].get();
+            auto busy = worker->GetBusyTime();
+            auto [it, inserted] = m_busy_map.try_emplace(worker, busy);
+            load += static_cast<double>(busy - it->second) / static_cast<double>(interval);
+            it->second = busy;
+        }
+        auto num = m_ctx_vect.size();
+        load /= static_cast<double>(num);
+
+        bool grow = num < m_option.m_max && (depth > m_option.m_grow_depth * num || load > m_option.m_grow_load);
+        bool shrink = num > m_option.m_min && depth == 0 && load < m_option.m_shrink_load;
+        grow_hits = grow ? grow_hits + 1 : 0;
+        shrink_hits = shrink ? shrink_hits + 1 : 0;
+        if (grow_hits >= m_option.m_hysteresis)
+        {
+            Grow();
+            grow_hits = 0;
+        }
+        else if (shrink_hits >= m_option.m_hysteresis)
+        {
+            Shrink();
+            shrink_hits = 0;
+        }
+    }
+}
+
+void ThreadPool::Grow()
+{
+    auto ctx = std::make_shared<ThreadContext>();
+    m_thread_pool.emplace_back(std::make_unique<Worker>(ctx, m_next_id++));
+    m_ctx_vect.emplace_back(ctx);
+}
+
+void ThreadPool::Shrink()
+{
+    auto ctx = std::move(m_ctx_vect.back());
+    auto worker = std::move(m_thread_pool.back());
+    m_ctx_vect.pop_back();
+    m_thread_pool.pop_back();
+    m_busy_map.erase(worker.get());
+    m_idx = 0;
+
+    // 已移出m_ctx_vect, 不会有新任务投递到该线程; 未固定的任务迁移到其他线程,
+    // 固定的任务留在原线程, 与其挂起的协程一起执行完后线程才退出
+    auto task_queue = ctx->TakeAll();
+    while (auto task = task_queue.Pop())
+    {
+        if ((*task)->m_pinned)
+        {
+            ctx->Push(*task);
+            continue;
+        }
+        m_ctx_vect[m_idx]->Push(*task);
+        m_idx = (m_idx + 1) % m_ctx_vect.size();
+    }
+    ctx->Stop(ShutdownPolicy::Drain, std::chrono::milliseconds::max());
+    m_retired_ctx.emplace_back(std::move(ctx));
+    m_retired.emplace_back(std::move(worker));
+}
+
+void ThreadPool::Reap()
+{
+    for (size_t i = 0; i < m_retired_ctx.size();)
+    {
+        if (m_retired_ctx[i]->IsDone())
+        {
+            m_retired_ctx.erase(m_retired_ctx.begin() + i);
+            m_retired.erase(m_retired.begin() + i);
+            continue;
+        }
+        i++;
+    }
 }
 
-void ThreadPool::Add(const std::shared_ptr<CoTask>& task)
+void ThreadPool::StopMonitor()
 {
+    m_monitor.request_stop();
+    if (m_monitor.joinable())
+    {
+        m_monitor.join();
+    }
+}
+
+bool ThreadPool::Stop(ShutdownPolicy policy, std::chrono::milliseconds timeout, int notify_fd)
+{
+    StopMonitor();
     std::lock_guard lk(m_mut);
-    m_ctx_vect[m_idx]->Push(task);
-    m_idx = (m_idx + 1) % m_num;
+    if (m_stop)
+    {
+        return false;
+    }
+    m_stop = true;
+    for (auto& ctx : m_ctx_vect)
+    {
+        ctx->Stop(policy, timeout, notify_fd);
+    }
+    for (auto& ctx : m_retired_ctx)
+    {
+        ctx->Stop(policy, timeout, notify_fd);
+    }
+    return true;
+}
+
+bool ThreadPool::IsDone()
+{
+    auto done = [](auto& ctx) { return ctx->IsDone(); };
+    return std::all_of(m_ctx_vect.begin(), m_ctx_vect.end(), done) && std::all_of(m_retired_ctx.begin(), m_retired_ctx.end(), done);
+}
+
+ShutdownStats ThreadPool::GetStats()
+{
+    ShutdownStats stats;
+    for (auto& ctx : m_ctx_vect)
+    {
+        stats += ctx->GetStats();
+    }
+    for (auto& ctx : m_retired_ctx)
+    {
+        stats += ctx->GetStats();
+    }
+    return stats;
 }
 
-}  // namespace coro
\ No newline at end of file
+}  // namespace coro
@@ -3,13 +3,95 @@
 
 #include <event.h>
 #include <sys/eventfd.h>
+#include <chrono>
+#include <condition_variable>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <thread>
 #include <utility>
 #include "eventfd.h"
 #include "executor.h"
+#include "future.h"
 
 namespace coro
 {
+/**
+ * @brief 关闭策略
+ */
+enum class ShutdownPolicy
+{
+    //! 等待挂起的协程结束, 超时后销毁剩余的协程
+    Drain,
+    //! 立即销毁挂起的协程, 丢弃队列中的任务
+    Cancel,
+};
+
+/**
+ * @brief 关闭结果
+ */
+struct ShutdownStats
+{
+    ShutdownStats& operator+=(const ShutdownStats& other)
+    {
+        m_drained += other.m_drained;
+        m_cancelled += other.m_cancelled;
+        m_dropped += other.m_dropped;
+        return *this;
+    }
+
+    //! 关闭期间正常结束的协程数
+    size_t m_drained = 0;
+    //! 被销毁的挂起协程数
+    size_t m_cancelled = 0;
+    //! 未执行就被丢弃的任务数
+    size_t m_dropped = 0;
+};
+
+/**
+ * @brief 线程池参数
+ */
+struct ThreadPoolOption
+{
+    //! 最少线程数
+    size_t m_min = 1;
+    //! 最多线程数, 大于m_min时按负载动态调整线程数
+    size_t m_max = 1;
+    //! 采样间隔
+    std::chrono::milliseconds m_interval{100};
+    //! 平均队列深度超过该值时扩容
+    size_t m_grow_depth = 8;
+    //! 平均负载(执行协程的时间占比)超过该值时扩容
+    double m_grow_load = 0.8;
+    //! 队列为空且平均负载低于该值时缩容
+    double m_shrink_load = 0.2;
+    //! 连续满足条件的采样次数, 防止线程数抖动
+    size_t m_hysteresis = 3;
+};
+
+namespace detail
+{
+/**
+ * @brief 可直接构造为cotask的函数, 返回Task<void>
+ */
+template <typename F>
+concept TaskFunction = std::is_invocable_r_v<Task<void>, std::decay_t<F>&> && !std::is_convertible_v<F, std::shared_ptr<CoTask>>;
+
+/**
+ * @brief 将函数包装为cotask, 已是cotask时直接返回
+ */
+inline std::shared_ptr<CoTask> MakeCoTask(std::shared_ptr<CoTask> task)
+{
+    return task;
+}
+
+template <TaskFunction F>
+std::shared_ptr<CoTask> MakeCoTask(F&& func)
+{
+    return std::make_shared<FunctionTask<std::decay_t<F>>>(std::forward<F>(func));
+}
+}  // namespace detail
+
 struct ThreadContext
 {
 public:
@@ -29,12 +111,45 @@ public:
     bool IsStop();
 
     /**
-     * @brief 停止
+     * @brief 停止, 不再接收新任务
+     * @param policy 关闭策略
+     * @param timeout Drain策略下等待挂起协程的时长
+     * @param notify_fd 工作线程退出后写入的fd, -1表示不通知
+     */
+    void Stop(ShutdownPolicy policy, std::chrono::milliseconds timeout, int notify_fd = -1);
+
+    /**
+     * @brief 获取关闭策略
+     * @return
+     */
+    ShutdownPolicy GetPolicy() const;
+
+    /**
+     * @brief 获取关闭超时
+     * @return
+     */
+    std::chrono::milliseconds GetTimeout() const;
+
+    /**
+     * @brief 工作线程退出, 记录关闭结果
+     * @param stats 关闭结果
+     */
+    void Finish(const ShutdownStats& stats);
+
+    /**
+     * @brief 工作线程是否已退出
+     * @return
+     */
+    bool IsDone();
+
+    /**
+     * @brief 获取关闭结果, 工作线程退出后有效
+     * @return
      */
-    void Stop();
+    ShutdownStats GetStats();
 
     /**
-     * @bbrief 获取任务
+     * @bbrief 按优先级获取任务
      * @return
      */
     std::shared_ptr<CoTask> Pop();
@@ -42,24 +157,72 @@ public:
     /**
      * @brief 添加任务
      * @param task
+     * @return 已停止返回false
+     */
+    bool Push(const std::shared_ptr<CoTask>& task);
+
+    /**
+     * @brief 批量添加任务, 只加锁与通知一次
+     * @param tasks
+     * @return 已停止返回false
+     */
+    bool Push(std::span<const std::shared_ptr<CoTask>> tasks);
+
+    /**
+     * @brief 丢弃队列中的任务
+     * @return 丢弃的任务数
+     */
+    size_t Clear();
+
+    /**
+     * @brief 取出队列中的所有任务
+     * @return 任务队列
      */
-    void Push(const std::shared_ptr<CoTask>& task);
+    PriorityQueue<std::shared_ptr<CoTask>> TakeAll();
+
+    /**
+     * @brief 获取队列深度
+     * @return
+     */
+    size_t Size();
 
 private:
     //! 用于通知的文件描述符
     int m_fd = -1;
     //! 是否停止
     std::atomic_bool m_stop = false;
+    //! 工作线程是否已退出
+    std::atomic_bool m_done = false;
+    //! 关闭策略
+    ShutdownPolicy m_policy = ShutdownPolicy::Cancel;
+    //! 关闭超时
+    std::chrono::milliseconds m_timeout{0};
+    //! 工作线程退出后通知的fd
+    int m_notify_fd = -1;
+    //! 关闭结果
+    ShutdownStats m_stats;
     //! 互斥锁
     std::mutex m_mut;
     //! 任务队列
-    std::queue<std::shared_ptr<CoTask>> m_task_queue;
+    PriorityQueue<std::shared_ptr<CoTask>> m_task_queue;
 };
 
 class Worker
 {
 public:
     explicit Worker(std::shared_ptr<ThreadContext> ctx, int32_t id);
+    ~Worker();
+
+    /**
+     * @brief 等待工作线程退出
+     */
+    void Join();
+
+    /**
+     * @brief 获取执行协程的累计耗时
+     * @return 纳秒
+     */
+    uint64_t GetBusyTime() const;
 
 private:
     /**
@@ -73,53 +236,279 @@ private:
      */
     static void OnNotify(evutil_socket_t, short, void* ptr);
 
+    /**
+     * @brief 关闭超时
+     * @param ptr
+     */
+    static void OnTimeout(evutil_socket_t, short, void* ptr);
+
     /**
      * @brief 处理数据
      */
     void Handle();
 
+    /**
+     * @brief 开始关闭, 按策略处理队列中的任务与挂起的协程
+     */
+    void Shutdown();
+
+    /**
+     * @brief 销毁剩余的协程, 退出事件循环
+     */
+    void Finish();
+
     //! 线程id
     int32_t m_id = 0;
     //! 线程上下文
     std::shared_ptr<ThreadContext> m_ctx;
-    //! 线程本体
-    std::jthread m_thread;
     //! 事件循环
     event_base* m_base = nullptr;
     //! 协程执行器
     std::unique_ptr<Executor> m_exec;
+    //! 关闭超时事件
+    event* m_timer = nullptr;
+    //! 是否正在关闭
+    bool m_shutdown = false;
+    //! 是否已结束
+    bool m_finished = false;
+    //! 关闭时待完成的协程数
+    size_t m_drain_count = 0;
+    //! 关闭结果
+    ShutdownStats m_stats;
+    //! 线程本体, 最后初始化, 最先析构
+    std::jthread m_thread;
 };
 
 class ThreadPool
 {
 public:
     explicit ThreadPool(size_t num);
+    explicit ThreadPool(const ThreadPoolOption& option);
     ~ThreadPool();
 
     /**
      * @brief 添加任务
      * @param task
+     * @param priority 优先级, 工作线程繁忙时高优先级的任务先执行
+     * @return 线程池已关闭返回false
      */
-    void Add(const std::function<Task<void>()>& task);
+    bool Add(const std::function<Task<void>()>& task, Priority priority = Priority::Normal);
 
     /**
      * @brief 添加任务
      * @param task
+     * @param priority 优先级, 工作线程繁忙时高优先级的任务先执行; 未指定时使用任务预设的优先级
+     * @return 线程池已关闭返回false
+     */
+    bool Add(const std::shared_ptr<CoTask>& task, std::optional<Priority> priority = std::nullopt);
+
+    /**
+     * @brief 添加任务, 函数直接构造在任务中, 不经过std::function
+     * @param func 返回Task<void>的函数
+     * @param priority 优先级
+     * @return 线程池已关闭返回false
+     */
+    template <detail::TaskFunction F>
+    bool Add(F&& func, Priority priority = Priority::Normal)
+    {
+        return Add(detail::MakeCoTask(std::forward<F>(func)), priority);
+    }
+
+    /**
+     * @brief 批量添加任务, 均分到各工作线程, 每个线程只加锁与通知一次
+     * @param tasks 返回Task<void>的函数或cotask的范围, 右值时移动其中的元素
+     * @param priority 优先级, 未指定时使用任务预设的优先级, 函数为Normal
+     * @return 线程池已关闭返回false, 此时任务都未添加
+     */
+    template <std::ranges::input_range R>
+    bool AddBatch(R&& tasks, std::optional<Priority> priority = std::nullopt);
+
+    /**
+     * @brief 添加任务到指定的工作线程, 任务及其启动的协程都在该线程执行;
+     *        线程池缩容时任务不迁移, 所在线程执行完固定的任务后才退出;
+     *        索引按添加时的线程数取模, 线程数变化后同一索引可能对应不同的线程, 需要索引与线程一一对应时使用固定大小的线程池
+     * @param idx 工作线程索引, 超出当前线程数时取模
+     * @param task
+     * @param priority 优先级
+     * @return 线程池已关闭返回false
      */
-    void Add(const std::shared_ptr<CoTask>& task);
+    bool AddTo(size_t idx, const std::function<Task<void>()>& task, Priority priority = Priority::Normal);
+
+    /**
+     * @brief 提交任务并获取结果, 函数可返回普通值或Task<T>, 可以只能移动
+     * @param func 函数
+     * @param priority 优先级
+     * @return 结果, 可co_await或Get阻塞等待; 函数抛出的异常由结果重新抛出, 任务未执行时为broken_promise
+     */
+    template <typename F>
+    auto Submit(F func, Priority priority = Priority::Normal) -> Future<detail::InvokeResult<F>>;
+
+    /**
+     * @brief 关闭线程池并阻塞等待工作线程退出
+     * @param policy 关闭策略
+     * @param timeout Drain策略下等待挂起协程的时长, 默认一直等待
+     * @return 关闭结果
+     */
+    ShutdownStats Shutdown(ShutdownPolicy policy, std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+    /**
+     * @brief 关闭线程池, 挂起当前协程直到工作线程全部退出, 不能在线程池内的协程中调用
+     * @param timeout 等待挂起协程的时长, 超时后销毁剩余的协程
+     * @return 关闭结果
+     */
+    Task<ShutdownStats> Drain(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 获取当前的工作线程数
+     * @return
+     */
+    size_t GetWorkerCount();
 
 private:
+    /**
+     * @brief 将一批任务按连续的区段分配到各工作线程
+     * @param batch 任务
+     * @return 线程池已关闭返回false
+     */
+    bool PushBatch(std::vector<std::shared_ptr<CoTask>>& batch);
+
+    /**
+     * @brief 按负载调整线程数
+     * @param token 停止标记
+     */
+    void Monitor(const std::stop_token& token);
+
+    /**
+     * @brief 增加一个工作线程
+     */
+    void Grow();
+
+    /**
+     * @brief 退役一个工作线程, 未开始的任务迁移到其他线程, 挂起的协程在原线程执行完毕
+     */
+    void Shrink();
+
+    /**
+     * @brief 回收已退出的退役线程
+     */
+    void Reap();
+
+    /**
+     * @brief 停止调整线程数
+     */
+    void StopMonitor();
+
+    /**
+     * @brief 停止所有工作线程
+     * @return 首次调用返回true
+     */
+    bool Stop(ShutdownPolicy policy, std::chrono::milliseconds timeout, int notify_fd);
+
+    /**
+     * @brief 工作线程是否全部退出
+     * @return
+     */
+    bool IsDone();
+
+    /**
+     * @brief 汇总关闭结果
+     * @return
+     */
+    ShutdownStats GetStats();
+
     //! 互斥锁
     std::mutex m_mut;
-    //! 线程数量
-    size_t m_num = 0;
+    //! 是否已关闭
+    bool m_stop = false;
+    //! 工作线程退出的通知fd
+    int m_fd = -1;
+    //! 线程池参数
+    ThreadPoolOption m_option;
+    //! 下一个线程id
+    int32_t m_next_id = 0;
     //! 当前的线程索引
     size_t m_idx = 0;
     //! 上下文
     std::vector<std::shared_ptr<ThreadContext>> m_ctx_vect;
     //! 工作线程
     std::vector<std::unique_ptr<Worker>> m_thread_pool;
+    //! 退役中的上下文
+    std::vector<std::shared_ptr<ThreadContext>> m_retired_ctx;
+    //! 退役中的工作线程
+    std::vector<std::unique_ptr<Worker>> m_retired;
+    //! 上次采样的忙碌时间
+    std::unordered_map<Worker*, uint64_t> m_busy_map;
+    //! 监控线程的等待条件
+    std::condition_variable_any m_cv;
+    //! 监控线程
+    std::jthread m_monitor;
 };
+
+template <std::ranges::input_range R>
+bool ThreadPool::AddBatch(R&& tasks, std::optional<Priority> priority)
+{
+    std::vector<std::shared_ptr<CoTask>> batch;
+    if constexpr (std::ranges::sized_range<R>)
+    {
+        batch.reserve(std::ranges::size(tasks));
+    }
+    for (auto&& task : tasks)
+    {
+        if constexpr (std::is_lvalue_reference_v<R>)
+        {
+            batch.emplace_back(detail::MakeCoTask(task));
+        }
+        else
+        {
+            batch.emplace_back(detail::MakeCoTask(std::move(task)));
+        }
+        if (priority)
+        {
+            batch.back()->m_priority = *priority;
+        }
+    }
+    return PushBatch(batch);
+}
+
+template <typename F>
+auto ThreadPool::Submit(F func, Priority priority) -> Future<detail::InvokeResult<F>>
+{
+    using Traits = detail::AwaitResultOf<std::invoke_result_t<F&>>;
+    using R = typename Traits::type;
+    auto [sender, future] = MakeOneshot<R>();
+    // 任务未执行就被丢弃时发送端随之析构, 接收端得到broken_promise
+    Add(
+        [func = std::move(func), sender = std::move(sender)]() mutable -> Task<void> {
+            try
+            {
+                if constexpr (Traits::kIsTask && std::is_void_v<R>)
+                {
+                    co_await func();
+                    sender.Set();
+                }
+                else if constexpr (Traits::kIsTask)
+                {
+                    sender.Set(co_await func());
+                }
+                else if constexpr (std::is_void_v<R>)
+                {
+                    func();
+                    sender.Set();
+                }
+                else
+                {
+                    sender.Set(func());
+                }
+            }
+            catch (...)
+            {
+                sender.SetException(std::current_exception());
+            }
+            co_return;
+        },
+        priority);
+    return std::move(future);
+}
 }  // namespace coro
 
 #endif  // CORO_THREAD_POOL_H
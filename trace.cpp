@@ -0,0 +1,240 @@
+#include "trace.h"
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace coro
+{
+namespace
+{
+/**
+ * @brief 缓冲区的一格, 以序号作为seqlock: 写入第i个事件期间为2i+1, 写完为2i+2;
+ *        事件按字存放在原子变量中, 读写并发时不是数据竞争, 读取前后序号不一致即被覆盖
+ */
+struct TraceSlot
+{
+    //! 事件占用的字数
+    static constexpr size_t kWords = (sizeof(TraceEvent) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    // 事件按字节复制进出字数组
+    static_assert(std::is_trivially_copyable_v<TraceEvent>);
+    static_assert(sizeof(TraceEvent) <= kWords * sizeof(uint64_t));
+
+    //! 序号
+    std::atomic_uint64_t m_seq = 0;
+    //! 事件
+    std::array<std::atomic_uint64_t, kWords> m_word{};
+
+    void Store(uint64_t pos, const TraceEvent& event)
+    {
+        std::array<uint64_t, kWords> word{};
+        memcpy(word.data(), &event, sizeof(event));
+        m_seq.store(pos * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++)
+        {
+            m_word[i].store(word[i], std::memory_order_relaxed);
+        }
+        m_seq.store(pos * 2 + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief 读取第pos个事件
+     * @return 已被覆盖或正在写入时返回false
+     */
+    bool Load(uint64_t pos, TraceEvent& event) const
+    {
+        if (m_seq.load(std::memory_order_acquire) != pos * 2 + 2)
+        {
+            return false;
+        }
+        std::array<uint64_t, kWords> word{};
+        for (size_t i = 0; i < kWords; i++)
+        {
+            word[i] = m_word[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_seq.load(std::memory_order_relaxed) != pos * 2 + 2)
+        {
+            return false;
+        }
+        memcpy(static_cast<void*>(&event), word.data(), sizeof(event));
+        return true;
+    }
+};
+
+struct TraceBuffer
+{
+    //! 事件
+    std::array<TraceSlot, kTraceCapacity> m_slot;
+    //! 写入位置
+    std::atomic_uint64_t m_pos = 0;
+    //! 读取的起始位置
+    std::atomic_uint64_t m_begin = 0;
+};
+
+struct Registry
+{
+    //! 互斥锁
+    std::mutex m_mut;
+    //! 所有线程的缓冲区, 线程退出后保留
+    std::vector<std::shared_ptr<TraceBuffer>> m_buffer;
+    //! trace_marker的fd
+    std::atomic_int m_marker_fd = -1;
+};
+
+Registry& GetRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+TraceBuffer& LocalBuffer()
+{
+    thread_local std::shared_ptr<TraceBuffer> buffer = [] {
+        auto buffer = std::make_shared<TraceBuffer>();
+        auto& registry = GetRegistry();
+        std::lock_guard lk(registry.m_mut);
+        registry.m_buffer.emplace_back(buffer);
+        return buffer;
+    }();
+    return *buffer;
+}
+
+uint32_t LocalTid()
+{
+    thread_local auto tid = static_cast<uint32_t>(syscall(SYS_gettid));
+    return tid;
+}
+
+const char* TypeName(TraceType type)
+{
+    return type == TraceType::Suspend ? "suspend" : "resume";
+}
+
+void WriteJsonString(std::ostream& os, const char* str)
+{
+    os << '"';
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            os << '\\';
+        }
+        os << *str;
+    }
+    os << '"';
+}
+}  // namespace
+
+void Trace::Record(TraceType type, const void* frame, const std::source_location& location)
+{
+    auto ts = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    auto& buffer = LocalBuffer();
+    auto pos = buffer.m_pos.load(std::memory_order_relaxed);
+    buffer.m_slot[pos % kTraceCapacity].Store(pos, TraceEvent{.m_ts_ns = static_cast<uint64_t>(ts), .m_tid = LocalTid(), .m_type = type, .m_frame = frame, .m_location = location});
+    buffer.m_pos.store(pos + 1, std::memory_order_release);
+
+    auto fd = GetRegistry().m_marker_fd.load(std::memory_order_relaxed);
+    if (fd >= 0)
+    {
+        char buf[512];
+        auto len = snprintf(buf, sizeof(buf), "coro_%s frame=%p %s %s:%u\n", TypeName(type), frame, location.function_name(), location.file_name(), location.line());
+        if (len > 0)
+        {
+            write(fd, buf, std::min<size_t>(len, sizeof(buf) - 1));
+        }
+    }
+}
+
+std::vector<TraceEvent> Trace::Collect()
+{
+    std::vector<TraceEvent> events;
+    auto& registry = GetRegistry();
+    std::lock_guard lk(registry.m_mut);
+    for (auto& buffer : registry.m_buffer)
+    {
+        auto pos = buffer->m_pos.load(std::memory_order_acquire);
+        auto begin = std::max(buffer->m_begin.load(std::memory_order_relaxed), pos > kTraceCapacity ? pos - kTraceCapacity : 0);
+        TraceEvent event;
+        for (auto i = begin; i < pos; i++)
+        {
+            // 读取期间被覆盖的事件跳过
+            if (buffer->m_slot[i % kTraceCapacity].Load(i, event))
+            {
+                events.emplace_back(event);
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](auto& l, auto& r) { return l.m_ts_ns < r.m_ts_ns; });
+    return events;
+}
+
+void Trace::Clear()
+{
+    auto& registry = GetRegistry();
+    std::lock_guard lk(registry.m_mut);
+    for (auto& buffer : registry.m_buffer)
+    {
+        buffer->m_begin.store(buffer->m_pos.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+void Trace::DumpChromeTrace(std::ostream& os)
+{
+    auto events = Collect();
+    os << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        auto& e = events[i];
+        char name[512];
+        snprintf(name, sizeof(name), "%s %s:%u", e.m_location.function_name(), e.m_location.file_name(), e.m_location.line());
+        char ts[32];
+        snprintf(ts, sizeof(ts), "%.3f", static_cast<double>(e.m_ts_ns) / 1000.0);
+        os << (i == 0 ? "" : ",") << "\n{\"name\":";
+        WriteJsonString(os, name);
+        os << ",\"cat\":\"coro\",\"ph\":\"" << (e.m_type == TraceType::Suspend ? 'b' : 'e') << "\",\"id\":\"" << e.m_frame << "\",\"ts\":" << ts << ",\"pid\":" << getpid()
+           << ",\"tid\":" << e.m_tid << "}";
+    }
+    os << "\n]}\n";
+}
+
+bool Trace::EnableTraceMarker(const char* path)
+{
+    int fd = -1;
+    if (path)
+    {
+        fd = open(path, O_WRONLY | O_CLOEXEC);
+    }
+    else
+    {
+        for (auto* p : {"/sys/kernel/tracing/trace_marker", "/sys/kernel/debug/tracing/trace_marker"})
+        {
+            fd = open(p, O_WRONLY | O_CLOEXEC);
+            if (fd >= 0)
+            {
+                break;
+            }
+        }
+    }
+    if (fd < 0)
+    {
+        return false;
+    }
+    auto old = GetRegistry().m_marker_fd.exchange(fd);
+    if (old >= 0)
+    {
+        close(old);
+    }
+    return true;
+}
+
+}  // namespace coro
@@ -0,0 +1,90 @@
+#ifndef CORO_TRACE_H
+#define CORO_TRACE_H
+
+#include <cstdint>
+#include <ostream>
+#include <source_location>
+#include <vector>
+
+namespace coro
+{
+#ifdef CORO_TRACE
+constexpr bool kTraceEnabled = true;
+#else
+constexpr bool kTraceEnabled = false;
+#endif
+
+//! 每个线程环形缓冲区的事件数
+constexpr size_t kTraceCapacity = 8192;
+
+/**
+ * @brief 事件类型
+ */
+enum class TraceType : uint8_t
+{
+    //! 协程在awaiter上挂起
+    Suspend,
+    //! awaiter完成, 协程进入就绪队列
+    Resume,
+};
+
+/**
+ * @brief 追踪事件
+ */
+struct TraceEvent
+{
+    //! 时间, 纳秒
+    uint64_t m_ts_ns = 0;
+    //! 线程id
+    uint32_t m_tid = 0;
+    //! 事件类型
+    TraceType m_type = TraceType::Suspend;
+    //! 协程帧地址
+    const void* m_frame = nullptr;
+    //! 挂起位置
+    std::source_location m_location;
+};
+
+/**
+ * @brief 协程挂起/恢复追踪, 每个线程写入自己的无锁环形缓冲区, 编译时定义CORO_TRACE后生效
+ */
+class Trace
+{
+public:
+    /**
+     * @brief 记录事件
+     * @param type 事件类型
+     * @param frame 协程帧地址
+     * @param location 挂起位置
+     */
+    static void Record(TraceType type, const void* frame, const std::source_location& location);
+
+    /**
+     * @brief 收集所有线程的事件, 按时间排序; 缓冲区写满后旧事件被覆盖,
+     *        与写入并发时读取期间被覆盖的事件被跳过
+     * @return
+     */
+    static std::vector<TraceEvent> Collect();
+
+    /**
+     * @brief 清空所有线程的事件
+     */
+    static void Clear();
+
+    /**
+     * @brief 以chrome://tracing的json格式输出, 每次挂起输出为一个异步区间
+     * @param os 输出流
+     */
+    static void DumpChromeTrace(std::ostream& os);
+
+    /**
+     * @brief 同时将事件写入ftrace的trace_marker, 可由perf record -e ftrace:print采集
+     * @param path trace_marker路径, 为空时依次尝试tracefs与debugfs
+     * @return 打开成功返回true
+     */
+    static bool EnableTraceMarker(const char* path = nullptr);
+};
+
+}  // namespace coro
+
+#endif  // CORO_TRACE_H
@@ -0,0 +1,351 @@
+#include "udp_socket.h"
+#include <event2/util.h>
+#include <netinet/udp.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "io.h"
+
+namespace coro
+{
+//! 一次recvmmsg/sendmmsg的消息数上限
+static constexpr size_t kMaxBatch = 1024;
+//! 一次GSO发送的分段数上限
+static constexpr size_t kMaxGsoSegments = 64;
+//! 一次GSO发送的数据上限, 受IP包长限制
+static constexpr size_t kMaxGsoBytes = 65535 - 8 - 40;
+
+namespace
+{
+/**
+ * @brief 解析数字地址
+ * @param host 地址
+ * @param port 端口
+ * @param addr 结果
+ * @param len 地址长度
+ * @return 是数字地址返回true
+ */
+bool ParseAddr(const std::string& host, uint16_t port, sockaddr_storage& addr, socklen_t& len)
+{
+    memset(&addr, 0, sizeof(addr));
+    auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+    auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);
+    if (evutil_inet_pton(AF_INET, host.c_str(), &in->sin_addr) == 1)
+    {
+        in->sin_family = AF_INET;
+        in->sin_port = htons(port);
+        len = sizeof(sockaddr_in);
+        return true;
+    }
+    if (evutil_inet_pton(AF_INET6, host.c_str(), &in6->sin6_addr) == 1)
+    {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(port);
+        len = sizeof(sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+bool SameAddr(const Datagram& a, const Datagram& b)
+{
+    return a.m_addr_len == b.m_addr_len && memcmp(&a.m_addr, &b.m_addr, a.m_addr_len) == 0;
+}
+}  // namespace
+
+PacketPool::PacketPool(size_t count, size_t size)
+    : m_buf(std::make_unique<char[]>(count * size))
+    , m_datagrams(count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        m_datagrams[i].m_data = m_buf.get() + i * size;
+        m_datagrams[i].m_capacity = size;
+    }
+}
+
+std::span<Datagram> PacketPool::Datagrams()
+{
+    return m_datagrams;
+}
+
+std::span<Datagram> PacketPool::Datagrams(size_t count)
+{
+    return std::span<Datagram>(m_datagrams).first(std::min(count, m_datagrams.size()));
+}
+
+UdpSocket::UdpSocket(const UdpSocketOption& option)
+    : m_option(option)
+{}
+
+UdpSocket::~UdpSocket()
+{
+    Close();
+}
+
+int UdpSocket::Open(int family)
+{
+    if (m_fd >= 0)
+    {
+        return -EALREADY;
+    }
+    m_fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_fd < 0)
+    {
+        return -errno;
+    }
+    if (m_option.m_rcvbuf > 0)
+    {
+        setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &m_option.m_rcvbuf, sizeof(m_option.m_rcvbuf));
+    }
+    if (m_option.m_sndbuf > 0)
+    {
+        setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &m_option.m_sndbuf, sizeof(m_option.m_sndbuf));
+    }
+    // 分段大小按消息在控制消息中指定, 这里只探测内核是否支持
+    int zero = 0;
+    m_gso = m_option.m_gso && setsockopt(m_fd, SOL_UDP, UDP_SEGMENT, &zero, sizeof(zero)) == 0;
+    int on = 1;
+    m_gro = m_option.m_gro && setsockopt(m_fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+    return 0;
+}
+
+int UdpSocket::Bind(const std::string& addr, uint16_t port)
+{
+    sockaddr_storage storage{};
+    socklen_t len = 0;
+    if (!ParseAddr(addr, port, storage, len))
+    {
+        return -EINVAL;
+    }
+    if (m_fd < 0)
+    {
+        if (auto ret = Open(storage.ss_family); ret < 0)
+        {
+            return ret;
+        }
+    }
+    if (bind(m_fd, reinterpret_cast<sockaddr*>(&storage), len) != 0)
+    {
+        return -errno;
+    }
+    return 0;
+}
+
+int UdpSocket::Connect(const std::string& addr, uint16_t port)
+{
+    sockaddr_storage storage{};
+    socklen_t len = 0;
+    if (!ParseAddr(addr, port, storage, len))
+    {
+        return -EINVAL;
+    }
+    if (m_fd < 0)
+    {
+        if (auto ret = Open(storage.ss_family); ret < 0)
+        {
+            return ret;
+        }
+    }
+    if (connect(m_fd, reinterpret_cast<sockaddr*>(&storage), len) != 0)
+    {
+        return -errno;
+    }
+    return 0;
+}
+
+void UdpSocket::Close()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+}
+
+int UdpSocket::GetFd() const
+{
+    return m_fd;
+}
+
+uint16_t UdpSocket::GetPort() const
+{
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+    {
+        return 0;
+    }
+    if (addr.ss_family == AF_INET)
+    {
+        return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+}
+
+bool UdpSocket::IsGsoEnabled() const
+{
+    return m_gso;
+}
+
+bool UdpSocket::IsGroEnabled() const
+{
+    return m_gro;
+}
+
+Task<int> UdpSocket::RecvBatch(std::span<Datagram> batch)
+{
+    if (batch.empty())
+    {
+        co_return 0;
+    }
+    auto count = std::min(batch.size(), kMaxBatch);
+    m_recv_msgs.resize(count);
+    m_recv_iov.resize(count);
+    m_recv_ctrl.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_recv_iov[i] = iovec{.iov_base = batch[i].m_data, .iov_len = batch[i].m_capacity};
+        auto& hdr = m_recv_msgs[i].msg_hdr;
+        hdr.msg_name = &batch[i].m_addr;
+        hdr.msg_namelen = sizeof(sockaddr_storage);
+        hdr.msg_iov = &m_recv_iov[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = m_gro ? m_recv_ctrl[i].m_buf : nullptr;
+        hdr.msg_controllen = m_gro ? sizeof(Control::m_buf) : 0;
+        hdr.msg_flags = 0;
+    }
+
+    IoAwaiter readable(m_fd, EV_READ);
+    while (true)
+    {
+        int ret = recvmmsg(m_fd, m_recv_msgs.data(), count, MSG_DONTWAIT, nullptr);
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret < 0 && errno == EAGAIN)
+        {
+            co_await readable;
+            continue;
+        }
+        if (ret < 0)
+        {
+            co_return -errno;
+        }
+        for (int i = 0; i < ret; i++)
+        {
+            auto& msg = m_recv_msgs[i];
+            auto& dgram = batch[i];
+            dgram.m_len = msg.msg_len;
+            dgram.m_addr_len = msg.msg_hdr.msg_namelen;
+            dgram.m_truncated = msg.msg_hdr.msg_flags & MSG_TRUNC;
+            dgram.m_segment = 0;
+            for (auto* cmsg = CMSG_FIRSTHDR(&msg.msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msg.msg_hdr, cmsg))
+            {
+                if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+                {
+                    int segment = 0;
+                    memcpy(&segment, CMSG_DATA(cmsg), sizeof(segment));
+                    dgram.m_segment = static_cast<uint16_t>(segment);
+                }
+            }
+        }
+        co_return ret;
+    }
+}
+
+Task<int> UdpSocket::SendBatch(std::span<const Datagram> batch)
+{
+    IoAwaiter writable(m_fd, EV_WRITE);
+    size_t pos = 0;
+    while (pos < batch.size())
+    {
+        auto count = BuildSend(batch, pos);
+        int ret = sendmmsg(m_fd, m_send_msgs.data(), count, MSG_DONTWAIT);
+        if (ret > 0)
+        {
+            for (int i = 0; i < ret; i++)
+            {
+                pos += m_send_counts[i];
+            }
+            continue;
+        }
+        int err = errno;
+        if (err == EINTR)
+        {
+            continue;
+        }
+        if (err == EAGAIN)
+        {
+            co_await writable;
+            continue;
+        }
+        if ((err == EIO || err == EINVAL) && m_send_counts[0] > 1)
+        {
+            // 网卡不支持校验和卸载等原因导致GSO失败, 之后逐个发送
+            m_gso = false;
+            continue;
+        }
+        co_return pos > 0 ? static_cast<int>(pos) : -err;
+    }
+    co_return static_cast<int>(pos);
+}
+
+size_t UdpSocket::BuildSend(std::span<const Datagram> batch, size_t pos)
+{
+    auto remain = batch.size() - pos;
+    auto max_msgs = std::min(remain, kMaxBatch);
+    m_send_msgs.resize(max_msgs);
+    m_send_ctrl.resize(max_msgs);
+    m_send_counts.resize(max_msgs);
+    m_send_iov.resize(remain);
+
+    size_t msgs = 0;
+    size_t iov = 0;
+    while (pos < batch.size() && msgs < max_msgs)
+    {
+        auto& first = batch[pos];
+        size_t end = pos + 1;
+        size_t bytes = first.m_len;
+        if (m_gso && first.m_len > 0)
+        {
+            // 除最后一个外分段等长, 最后一个不超过分段大小
+            while (end < batch.size() && end - pos < kMaxGsoSegments && batch[end - 1].m_len == first.m_len &&
+                   batch[end].m_len <= first.m_len && bytes + batch[end].m_len <= kMaxGsoBytes && SameAddr(first, batch[end]))
+            {
+                bytes += batch[end].m_len;
+                end++;
+            }
+        }
+
+        auto& hdr = m_send_msgs[msgs].msg_hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = first.m_addr_len ? const_cast<sockaddr_storage*>(&first.m_addr) : nullptr;
+        hdr.msg_namelen = first.m_addr_len;
+        hdr.msg_iov = &m_send_iov[iov];
+        hdr.msg_iovlen = end - pos;
+        for (auto i = pos; i < end; i++)
+        {
+            m_send_iov[iov++] = iovec{.iov_base = batch[i].m_data, .iov_len = batch[i].m_len};
+        }
+        if (end - pos > 1)
+        {
+            hdr.msg_control = m_send_ctrl[msgs].m_buf;
+            hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+            auto* cmsg = CMSG_FIRSTHDR(&hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            auto segment = static_cast<uint16_t>(first.m_len);
+            memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+        }
+        m_send_counts[msgs] = end - pos;
+        msgs++;
+        pos = end;
+    }
+    return msgs;
+}
+
+}  // namespace coro
@@ -0,0 +1,208 @@
+#ifndef CORO_UDP_SOCKET_H
+#define CORO_UDP_SOCKET_H
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "task.h"
+
+namespace coro
+{
+/**
+ * @brief udp socket参数
+ */
+struct UdpSocketOption
+{
+    //! 是否启用UDP GSO, 发往同一地址的等长数据报合并为一次发送, 内核不支持时自动关闭
+    bool m_gso = false;
+    //! 是否启用UDP GRO, 内核可将多个数据报合并后交付, 需配合64K的缓冲区使用
+    bool m_gro = false;
+    //! 接收缓冲区大小, 为0时使用系统默认值
+    int m_rcvbuf = 0;
+    //! 发送缓冲区大小, 为0时使用系统默认值
+    int m_sndbuf = 0;
+};
+
+/**
+ * @brief 数据报, 缓冲区由调用方提供, 通常来自PacketPool
+ */
+struct Datagram
+{
+    //! 缓冲区
+    char* m_data = nullptr;
+    //! 缓冲区容量
+    size_t m_capacity = 0;
+    //! 数据长度
+    size_t m_len = 0;
+    //! 对端地址
+    sockaddr_storage m_addr{};
+    //! 对端地址长度, 发送时为0表示发往已连接的地址
+    socklen_t m_addr_len = 0;
+    //! 接收时GRO合并的分段大小, 缓冲区中依次为多个该长度的数据报(最后一个可能较短), 0表示单个数据报
+    uint16_t m_segment = 0;
+    //! 接收时缓冲区不足, 数据被截断
+    bool m_truncated = false;
+};
+
+/**
+ * @brief 预分配的数据报缓冲池, 所有缓冲区在一次分配中连续存放, 收发时反复使用, 不按包分配内存
+ */
+class PacketPool
+{
+public:
+    PacketPool(const PacketPool&) = delete;
+    /**
+     * @brief 构造缓冲池
+     * @param count 数据报个数, 即一批的上限
+     * @param size 每个缓冲区的大小
+     */
+    PacketPool(size_t count, size_t size);
+
+    /**
+     * @brief 获取所有数据报
+     * @return
+     */
+    std::span<Datagram> Datagrams();
+
+    /**
+     * @brief 获取前count个数据报
+     * @param count 个数
+     * @return
+     */
+    std::span<Datagram> Datagrams(size_t count);
+
+private:
+    //! 缓冲区
+    std::unique_ptr<char[]> m_buf;
+    //! 数据报
+    std::vector<Datagram> m_datagrams;
+};
+
+/**
+ * @brief 批量收发的udp socket, 基于recvmmsg/sendmmsg, 一次唤醒收发多个数据报;
+ *        同一时刻最多各有一个RecvBatch与SendBatch在等待
+ */
+class UdpSocket
+{
+public:
+    UdpSocket(const UdpSocket&) = delete;
+    /**
+     * @brief 构造socket
+     * @param option 参数, 在创建socket时生效
+     */
+    explicit UdpSocket(const UdpSocketOption& option = {});
+    ~UdpSocket();
+
+    /**
+     * @brief 创建未绑定的socket, 只发送时使用
+     * @param family 地址族
+     * @return 成功返回0, 失败返回-errno
+     */
+    int Open(int family);
+
+    /**
+     * @brief 绑定地址, 未创建socket时按地址族创建
+     * @param addr 数字地址
+     * @param port 端口, 为0时由系统分配
+     * @return 成功返回0, 失败返回-errno
+     */
+    int Bind(const std::string& addr, uint16_t port);
+
+    /**
+     * @brief 连接对端, 之后发送可不指定地址, 只接收该地址的数据报
+     * @param addr 数字地址
+     * @param port 端口
+     * @return 成功返回0, 失败返回-errno
+     */
+    int Connect(const std::string& addr, uint16_t port);
+
+    /**
+     * @brief 关闭socket, 需在所有操作结束后调用
+     */
+    void Close();
+
+    /**
+     * @brief 获取fd
+     * @return
+     */
+    int GetFd() const;
+
+    /**
+     * @brief 获取绑定的端口
+     * @return
+     */
+    uint16_t GetPort() const;
+
+    /**
+     * @brief GSO是否可用
+     * @return
+     */
+    bool IsGsoEnabled() const;
+
+    /**
+     * @brief GRO是否可用
+     * @return
+     */
+    bool IsGroEnabled() const;
+
+    /**
+     * @brief 接收一批数据报, 没有数据时挂起直到可读
+     * @param batch 数据报, 缓冲区需已设置
+     * @return 收到的个数, 至少为1, 失败时为-errno
+     */
+    Task<int> RecvBatch(std::span<Datagram> batch);
+
+    /**
+     * @brief 发送一批数据报, 发送缓冲区满时挂起直到可写
+     * @param batch 数据报, 需保持有效直到返回
+     * @return 发送的个数, 出错时返回已发送的个数, 一个都未发送时为-errno
+     */
+    Task<int> SendBatch(std::span<const Datagram> batch);
+
+private:
+    /**
+     * @brief 控制消息的缓冲区, 用于GRO分段大小
+     */
+    struct alignas(cmsghdr) Control
+    {
+        char m_buf[CMSG_SPACE(sizeof(int))];
+    };
+
+    /**
+     * @brief 从pos开始组织待发送的消息, GSO可用时合并发往同一地址的等长数据报
+     * @param batch 数据报
+     * @param pos 第一个未发送的数据报
+     * @return 消息数
+     */
+    size_t BuildSend(std::span<const Datagram> batch, size_t pos);
+
+    //! 参数
+    UdpSocketOption m_option;
+    //! fd
+    int m_fd = -1;
+    //! GSO是否可用
+    bool m_gso = false;
+    //! GRO是否可用
+    bool m_gro = false;
+    //! 接收的消息头
+    std::vector<mmsghdr> m_recv_msgs;
+    //! 接收的缓冲区描述
+    std::vector<iovec> m_recv_iov;
+    //! 接收的控制消息
+    std::vector<Control> m_recv_ctrl;
+    //! 发送的消息头
+    std::vector<mmsghdr> m_send_msgs;
+    //! 发送的缓冲区描述, 一个消息可包含多个数据报
+    std::vector<iovec> m_send_iov;
+    //! 发送的控制消息
+    std::vector<Control> m_send_ctrl;
+    //! 每个消息包含的数据报数
+    std::vector<size_t> m_send_counts;
+};
+
+}  // namespace coro
+
+#endif  // CORO_UDP_SOCKET_H
@@ -0,0 +1,175 @@
+#ifndef CORO_WAIT_QUEUE_H
+#define CORO_WAIT_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include "awaiter.h"
+
+namespace coro
+{
+/**
+ * @brief 挂在等待队列上的等待器, 唤醒时在所在执行器上调用OnWake
+ */
+class WaitAwaiter : public BaseAwaiter
+{
+public:
+    /**
+     * @brief 被唤醒, 默认恢复协程; 需要重试的等待器可重新登记
+     */
+    virtual void OnWake()
+    {
+        Resume();
+    }
+};
+
+namespace detail
+{
+/**
+ * @brief 挂起在channel或互斥体上的等待者, 不占用内核对象;
+ *        唤醒时在其执行器上恢复, 跨线程唤醒经执行器的投递通知
+ */
+struct WaitNode
+{
+    //! 等待器, 等待器析构后为空, 只在执行器所在线程读写
+    WaitAwaiter* m_awaiter = nullptr;
+    //! 等待者所在的执行器
+    Executor* m_exec = nullptr;
+    //! 是否已唤醒, 保证同时登记在多处的等待者只唤醒一次
+    std::atomic_bool m_notified = false;
+};
+
+/**
+ * @brief 创建等待者并增加执行器的引用, 在等待器的Handle中调用
+ * @param awaiter 等待器
+ * @param exec 执行器
+ * @return
+ */
+inline std::shared_ptr<WaitNode> MakeWaitNode(WaitAwaiter* awaiter, Executor* exec)
+{
+    auto node = std::make_shared<WaitNode>();
+    node->m_awaiter = awaiter;
+    node->m_exec = exec;
+    exec->Ref();
+    return node;
+}
+
+/**
+ * @brief 唤醒等待者, 可在任意线程调用; 在等待者的执行器中调用时直接调用OnWake
+ * @param node 等待者
+ * @return 首次唤醒返回true
+ */
+inline bool Wake(const std::shared_ptr<WaitNode>& node)
+{
+    if (node->m_notified.exchange(true, std::memory_order_acq_rel))
+    {
+        return false;
+    }
+    auto resume = [node] {
+        // 等待期间协程被销毁时不再唤醒
+        if (node->m_awaiter)
+        {
+            node->m_awaiter->OnWake();
+        }
+        node->m_exec->Unref();
+    };
+    if (Executor::Current() == node->m_exec)
+    {
+        resume();
+    }
+    else
+    {
+        node->m_exec->Post(std::move(resume));
+    }
+    return true;
+}
+
+/**
+ * @brief 等待器析构时撤销等待, 需在等待者的执行器所在线程, 且已从所有队列移除后调用;
+ *        与唤醒方竞争同一个标记, 撤销在先时唤醒方的Wake返回false, 由唤醒方转给下一个等待者
+ * @param node 等待者
+ * @return 已被唤醒时返回true, 唤醒未处理时需由调用方转交
+ */
+inline bool Abandon(const std::shared_ptr<WaitNode>& node)
+{
+    node->m_awaiter = nullptr;
+    if (node->m_notified.exchange(true, std::memory_order_acq_rel))
+    {
+        return true;
+    }
+    node->m_exec->Unref();
+    return false;
+}
+
+/**
+ * @brief 等待者队列, 先进先出, 不加锁, 由所属对象的锁保护
+ */
+class WaitQueue
+{
+public:
+    /**
+     * @brief 加入等待者
+     * @param node 等待者
+     */
+    void Push(std::shared_ptr<WaitNode> node)
+    {
+        m_nodes.emplace_back(std::move(node));
+    }
+
+    /**
+     * @brief 取出最早的等待者
+     * @return 队列为空时为空
+     */
+    std::shared_ptr<WaitNode> Pop()
+    {
+        if (m_nodes.empty())
+        {
+            return nullptr;
+        }
+        auto node = std::move(m_nodes.front());
+        m_nodes.pop_front();
+        return node;
+    }
+
+    /**
+     * @brief 移除等待者
+     * @param node 等待者
+     * @return 在队列中返回true
+     */
+    bool Remove(const std::shared_ptr<WaitNode>& node)
+    {
+        auto it = std::find(m_nodes.begin(), m_nodes.end(), node);
+        if (it == m_nodes.end())
+        {
+            return false;
+        }
+        m_nodes.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief 唤醒并移除所有等待者
+     */
+    void WakeAll()
+    {
+        for (auto& node : m_nodes)
+        {
+            Wake(node);
+        }
+        m_nodes.clear();
+    }
+
+    bool Empty() const
+    {
+        return m_nodes.empty();
+    }
+
+private:
+    //! 等待者
+    std::list<std::shared_ptr<WaitNode>> m_nodes;
+};
+}  // namespace detail
+}  // namespace coro
+
+#endif  // CORO_WAIT_QUEUE_H